@@ -16,16 +16,153 @@
 #include <zephyr.h>
 #include <zephyr/types.h>
 #include <stddef.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <toolchain.h>
+#include <sys/atomic.h>
+#include <sys/util.h>
 
 #include "attr_defs.h"
+#include "attr_table.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**************************************************************************************************/
+/* Global Constants, Macros and Type Definitions                                                  */
+/**************************************************************************************************/
+/* Each simulation enable attribute has a bit in attr_simulation_active. The
+ * bits are assigned here rather than computed from the IDs so that a
+ * regenerated attribute table can't move them.
+ */
+enum attr_simulation_bit {
+	ATTR_SIMULATION_BIT_adc_power = 0,
+	ATTR_SIMULATION_BIT_adc_analog_sensor,
+	ATTR_SIMULATION_BIT_adc_thermistor,
+	ATTR_SIMULATION_BIT_adc_vref,
+	ATTR_SIMULATION_BIT_voltage_1,
+	ATTR_SIMULATION_BIT_voltage_2,
+	ATTR_SIMULATION_BIT_voltage_3,
+	ATTR_SIMULATION_BIT_voltage_4,
+	ATTR_SIMULATION_BIT_ultrasonic,
+	ATTR_SIMULATION_BIT_pressure,
+	ATTR_SIMULATION_BIT_current_1,
+	ATTR_SIMULATION_BIT_current_2,
+	ATTR_SIMULATION_BIT_current_3,
+	ATTR_SIMULATION_BIT_current_4,
+	ATTR_SIMULATION_BIT_vref,
+	ATTR_SIMULATION_BIT_temperature_1,
+	ATTR_SIMULATION_BIT_temperature_2,
+	ATTR_SIMULATION_BIT_temperature_3,
+	ATTR_SIMULATION_BIT_temperature_4,
+	ATTR_SIMULATION_BIT_power_volts,
+	ATTR_SIMULATION_BIT_digital_input_1,
+	ATTR_SIMULATION_BIT_digital_input_2,
+	ATTR_SIMULATION_BIT_mag_switch,
+	ATTR_SIMULATION_BIT_tamper_switch,
+	ATTR_SIMULATION_BIT_COUNT
+};
+
+BUILD_ASSERT(ATTR_SIMULATION_BIT_COUNT <= 32,
+	     "Simulation enables don't fit in the bitmap");
+
+/**************************************************************************************************/
+/* Global Data Definitions                                                                        */
+/**************************************************************************************************/
+/* Set bits may be stale after a reset of the attributes, so a set bit means
+ * the attribute must still be checked. A clear bit means not simulated.
+ */
+extern atomic_t attr_simulation_active;
+
 /**************************************************************************************************/
 /* Global Function Prototypes                                                                     */
 /**************************************************************************************************/
+/**
+ * @brief Get the bit of a simulation enable attribute in
+ * attr_simulation_active.
+ *
+ * @param id of a simulation enable attribute
+ *
+ * @retval bit number, -EINVAL if the attribute isn't a simulation enable
+ */
+static inline int attr_simulation_bit(attr_id_t id)
+{
+	switch (id) {
+	case ATTR_ID_adc_power_simulated:
+		return ATTR_SIMULATION_BIT_adc_power;
+	case ATTR_ID_adc_analog_sensor_simulated:
+		return ATTR_SIMULATION_BIT_adc_analog_sensor;
+	case ATTR_ID_adc_thermistor_simulated:
+		return ATTR_SIMULATION_BIT_adc_thermistor;
+	case ATTR_ID_adc_vref_simulated:
+		return ATTR_SIMULATION_BIT_adc_vref;
+	case ATTR_ID_voltage_1_simulated:
+		return ATTR_SIMULATION_BIT_voltage_1;
+	case ATTR_ID_voltage_2_simulated:
+		return ATTR_SIMULATION_BIT_voltage_2;
+	case ATTR_ID_voltage_3_simulated:
+		return ATTR_SIMULATION_BIT_voltage_3;
+	case ATTR_ID_voltage_4_simulated:
+		return ATTR_SIMULATION_BIT_voltage_4;
+	case ATTR_ID_ultrasonic_simulated:
+		return ATTR_SIMULATION_BIT_ultrasonic;
+	case ATTR_ID_pressure_simulated:
+		return ATTR_SIMULATION_BIT_pressure;
+	case ATTR_ID_current_1_simulated:
+		return ATTR_SIMULATION_BIT_current_1;
+	case ATTR_ID_current_2_simulated:
+		return ATTR_SIMULATION_BIT_current_2;
+	case ATTR_ID_current_3_simulated:
+		return ATTR_SIMULATION_BIT_current_3;
+	case ATTR_ID_current_4_simulated:
+		return ATTR_SIMULATION_BIT_current_4;
+	case ATTR_ID_vref_simulated:
+		return ATTR_SIMULATION_BIT_vref;
+	case ATTR_ID_temperature_1_simulated:
+		return ATTR_SIMULATION_BIT_temperature_1;
+	case ATTR_ID_temperature_2_simulated:
+		return ATTR_SIMULATION_BIT_temperature_2;
+	case ATTR_ID_temperature_3_simulated:
+		return ATTR_SIMULATION_BIT_temperature_3;
+	case ATTR_ID_temperature_4_simulated:
+		return ATTR_SIMULATION_BIT_temperature_4;
+	case ATTR_ID_power_volts_simulated:
+		return ATTR_SIMULATION_BIT_power_volts;
+	case ATTR_ID_digital_input_1_simulated:
+		return ATTR_SIMULATION_BIT_digital_input_1;
+	case ATTR_ID_digital_input_2_simulated:
+		return ATTR_SIMULATION_BIT_digital_input_2;
+	case ATTR_ID_mag_switch_simulated:
+		return ATTR_SIMULATION_BIT_mag_switch;
+	case ATTR_ID_tamper_switch_simulated:
+		return ATTR_SIMULATION_BIT_tamper_switch;
+	default:
+		return -EINVAL;
+	}
+}
+
+/**
+ * @brief Fast check used by the sensor and input paths before reading the
+ * simulation attributes.
+ *
+ * @param id of a simulation enable attribute
+ *
+ * @retval false if the value isn't simulated
+ */
+static inline bool attr_simulation_maybe_active(attr_id_t id)
+{
+#ifdef CONFIG_SENSOR_SIMULATION
+	int bit = attr_simulation_bit(id);
+
+	/* An unknown ID falls back to reading the attribute */
+	return (bit < 0) || atomic_test_bit(&attr_simulation_active, bit);
+#else
+	ARG_UNUSED(id);
+	return false;
+#endif
+}
+
 /**
  * @param do_write true if attribute should be changed, false if pv should
  * be validated but not written.
@@ -37,6 +174,7 @@ extern "C" {
 int av_tx_power(const ate_t *const entry, void *pv, size_t vlen, bool do_write);
 
 int av_aic(const ate_t *const entry, void *pv, size_t vlen, bool do_write);
+int av_simen(const ate_t *const entry, void *pv, size_t vlen, bool do_write);
 
 int av_din1simen(const ate_t *const entry, void *pv, size_t vlen,
 		 bool do_write);
@@ -388,20 +388,75 @@ BUILD_ASSERT(sizeof(enum lwm2m_batt_stat) == ATTR_SIZE_U8);
 #define ATTR_ID_smp_auth_timeout                      155
 #define ATTR_ID_shell_password                        156
 #define ATTR_ID_shell_session_timeout                 157
+#define ATTR_ID_temperature_1_deadband                158
+#define ATTR_ID_temperature_2_deadband                159
+#define ATTR_ID_temperature_3_deadband                160
+#define ATTR_ID_temperature_4_deadband                161
+#define ATTR_ID_temperature_1_deadband_percent        162
+#define ATTR_ID_temperature_2_deadband_percent        163
+#define ATTR_ID_temperature_3_deadband_percent        164
+#define ATTR_ID_temperature_4_deadband_percent        165
+#define ATTR_ID_analog_input_1_deadband               166
+#define ATTR_ID_analog_input_2_deadband               167
+#define ATTR_ID_analog_input_3_deadband               168
+#define ATTR_ID_analog_input_4_deadband               169
+#define ATTR_ID_analog_input_1_deadband_percent       170
+#define ATTR_ID_analog_input_2_deadband_percent       171
+#define ATTR_ID_analog_input_3_deadband_percent       172
+#define ATTR_ID_analog_input_4_deadband_percent       173
+#define ATTR_ID_deadband_heartbeat                    174
+#define ATTR_ID_temperature_sense_interval_min        175
+#define ATTR_ID_temperature_sense_interval_max        176
+#define ATTR_ID_temperature_slope_threshold           177
+#define ATTR_ID_analog_sense_interval_min             178
+#define ATTR_ID_analog_sense_interval_max             179
+#define ATTR_ID_analog_slope_threshold                180
+#define ATTR_ID_power_sense_interval_min              181
+#define ATTR_ID_power_sense_interval_max              182
+#define ATTR_ID_power_slope_threshold                 183
+#define ATTR_ID_sample_wakeups                        184
+#define ATTR_ID_sample_wakeups_per_hour               185
+#define ATTR_ID_temperature_sample_lateness           186
+#define ATTR_ID_temperature_sample_jitter_max         187
+#define ATTR_ID_temperature_sample_overruns           188
+#define ATTR_ID_analog_sample_lateness                189
+#define ATTR_ID_analog_sample_jitter_max              190
+#define ATTR_ID_analog_sample_overruns                191
+#define ATTR_ID_power_sample_lateness                 192
+#define ATTR_ID_power_sample_jitter_max               193
+#define ATTR_ID_power_sample_overruns                 194
+#define ATTR_ID_event_rate_limit                      195
+#define ATTR_ID_event_rate_window                     196
+#define ATTR_ID_event_rate_dropped                    197
+#define ATTR_ID_advert_hci_commands                   198
+#define ATTR_ID_advert_hci_commands_per_hour          199
+#define ATTR_ID_advert_updates_skipped                200
+#define ATTR_ID_advertising_dual_phy_ratio            201
+#define ATTR_ID_advertising_adaptive                  202
+#define ATTR_ID_advertising_interval_fast             203
+#define ATTR_ID_advertising_interval_idle             204
+#define ATTR_ID_advertising_interval_growth           205
+#define ATTR_ID_advertising_alarm_hold                206
+#define ATTR_ID_advertising_interval_active           207
+#define ATTR_ID_event_stream_notifications            208
+#define ATTR_ID_event_stream_dropped                  209
+#define ATTR_ID_event_stream_latency                  210
+#define ATTR_ID_conn_policy_throughput                211
+#define ATTR_ID_conn_policy_dle_blacklisted           212
 /* pyend */
 
 /* pystart - attribute constants */
-#define ATTR_TABLE_SIZE                                             158
-#define ATTR_TABLE_MAX_ID                                           157
-#define ATTR_TABLE_WRITABLE_COUNT                                   122
-#define ATTR_TABLE_CRC_OF_NAMES                                     0x4c735cc2
+#define ATTR_TABLE_SIZE                                             213
+#define ATTR_TABLE_MAX_ID                                           212
+#define ATTR_TABLE_WRITABLE_COUNT                                   156
+#define ATTR_TABLE_CRC_OF_NAMES                                     0x32584eb4
 #define ATTR_MAX_STR_LENGTH                                         255
 #define ATTR_MAX_STR_SIZE                                           256
 #define ATTR_MAX_BIN_SIZE                                           16
 #define ATTR_MAX_INT_SIZE                                           8
 #define ATTR_MAX_KEY_NAME_SIZE                                      35
 #define ATTR_MAX_VALUE_SIZE                                         256
-#define ATTR_MAX_FILE_SIZE                                          5593
+#define ATTR_MAX_FILE_SIZE                                          7621
 #define ATTR_ENABLE_FPU_CHECK                                       1
 
 /* Attribute Max String Lengths */
@@ -38,10 +38,15 @@ extern const struct attr_table_entry ATTR_TABLE[ATTR_TABLE_SIZE];
 
 extern atomic_t attr_modified[];
 
+atomic_t attr_simulation_active;
+
 /**************************************************************************************************/
 /* Local Function Prototypes                                                                      */
 /**************************************************************************************************/
 static int validate_analog_input_config(void);
+static int validate_simulation_enable(const ate_t *const entry, void *pv,
+				      size_t vlen);
+static void update_simulation_active(const ate_t *const entry);
 
 /**************************************************************************************************/
 /* Local Function Definitions                                                                     */
@@ -87,9 +92,49 @@ static int validate_analog_input_config(void)
 	}
 }
 
+static int validate_simulation_enable(const ate_t *const entry, void *pv,
+				      size_t vlen)
+{
+	if (!IS_ENABLED(CONFIG_SENSOR_SIMULATION) && *((bool *)pv)) {
+		return -EPERM;
+	}
+	return av_bool(entry, pv, vlen, false);
+}
+
+/* Keep the bitmap checked by the sensor and input paths in step with the
+ * simulation enable attributes.
+ */
+static void update_simulation_active(const ate_t *const entry)
+{
+	int bit = attr_simulation_bit(attr_table_index(entry));
+
+	if (bit < 0) {
+		return;
+	}
+
+	if (*((bool *)entry->pData)) {
+		atomic_set_bit(&attr_simulation_active, bit);
+	} else {
+		atomic_clear_bit(&attr_simulation_active, bit);
+	}
+}
+
 /**************************************************************************************************/
 /* Global Function Definitions                                                                    */
 /**************************************************************************************************/
+int av_simen(const ate_t *const entry, void *pv, size_t vlen, bool do_write)
+{
+	int r;
+
+	r = validate_simulation_enable(entry, pv, vlen);
+	if (r == 0 && do_write) {
+		r = av_bool(entry, pv, vlen, true);
+		update_simulation_active(entry);
+	}
+
+	return r;
+}
+
 int av_tx_power(const ate_t *const entry, void *pv, size_t vlen, bool do_write)
 {
 	ARG_UNUSED(vlen);
@@ -231,7 +276,11 @@ int av_din1simen(const ate_t *const entry, void *pv, size_t vlen, bool do_write)
 		 * In this case, just call the standard validator for the
 		 * simulation enable type.
 		 */
-		r = av_bool(entry, pv, vlen, false);
+		r = validate_simulation_enable(entry, pv, vlen);
+	}
+
+	if (do_write) {
+		update_simulation_active(entry);
 	}
 
 	return r;
@@ -335,7 +384,11 @@ int av_din2simen(const ate_t *const entry, void *pv, size_t vlen, bool do_write)
 		 * In this case, just call the standard validator for the
 		 * simulation enable type.
 		 */
-		r = av_bool(entry, pv, vlen, false);
+		r = validate_simulation_enable(entry, pv, vlen);
+	}
+
+	if (do_write) {
+		update_simulation_active(entry);
 	}
 
 	return r;
@@ -418,7 +471,11 @@ int av_magsimen(const ate_t *const entry, void *pv, size_t vlen, bool do_write)
 		/* If do_write is not set, this is the first call so we just
 		 * call the standard type validator to check its content.
 		 */
-		r = av_bool(entry, pv, vlen, false);
+		r = validate_simulation_enable(entry, pv, vlen);
+	}
+
+	if (do_write) {
+		update_simulation_active(entry);
 	}
 
 	return (r);
@@ -503,7 +560,11 @@ int av_tampsimen(const ate_t *const entry, void *pv, size_t vlen, bool do_write)
 		/* If do_write is not set, this is the first call so we just
 		 * call the standard type validator to check its content.
 		 */
-		r = av_bool(entry, pv, vlen, false);
+		r = validate_simulation_enable(entry, pv, vlen);
+	}
+
+	if (do_write) {
+		update_simulation_active(entry);
 	}
 
 	return (r);
@@ -102,6 +102,40 @@ typedef struct rw_attribute {
 	uint32_t smp_auth_timeout;
 	char shell_password[32 + 1];
 	uint8_t shell_session_timeout;
+	float temperature_1_deadband;
+	float temperature_2_deadband;
+	float temperature_3_deadband;
+	float temperature_4_deadband;
+	float temperature_1_deadband_percent;
+	float temperature_2_deadband_percent;
+	float temperature_3_deadband_percent;
+	float temperature_4_deadband_percent;
+	float analog_input_1_deadband;
+	float analog_input_2_deadband;
+	float analog_input_3_deadband;
+	float analog_input_4_deadband;
+	float analog_input_1_deadband_percent;
+	float analog_input_2_deadband_percent;
+	float analog_input_3_deadband_percent;
+	float analog_input_4_deadband_percent;
+	uint32_t deadband_heartbeat;
+	uint32_t temperature_sense_interval_min;
+	uint32_t temperature_sense_interval_max;
+	float temperature_slope_threshold;
+	uint32_t analog_sense_interval_min;
+	uint32_t analog_sense_interval_max;
+	float analog_slope_threshold;
+	uint32_t power_sense_interval_min;
+	uint32_t power_sense_interval_max;
+	float power_slope_threshold;
+	uint32_t event_rate_limit;
+	uint32_t event_rate_window;
+	uint8_t advertising_dual_phy_ratio;
+	bool advertising_adaptive;
+	uint16_t advertising_interval_fast;
+	uint16_t advertising_interval_idle;
+	uint16_t advertising_interval_growth;
+	uint16_t advertising_alarm_hold;
 } rw_attribute_t;
 /* pyend */
 
@@ -178,7 +212,41 @@ static const rw_attribute_t DEFAULT_RW_ATTRIBUTE_VALUES =  {
 	.smp_auth_req = 0,
 	.smp_auth_timeout = 300,
 	.shell_password = "zephyr",
-	.shell_session_timeout = 5
+	.shell_session_timeout = 5,
+	.temperature_1_deadband = 0.0,
+	.temperature_2_deadband = 0.0,
+	.temperature_3_deadband = 0.0,
+	.temperature_4_deadband = 0.0,
+	.temperature_1_deadband_percent = 0.0,
+	.temperature_2_deadband_percent = 0.0,
+	.temperature_3_deadband_percent = 0.0,
+	.temperature_4_deadband_percent = 0.0,
+	.analog_input_1_deadband = 0.0,
+	.analog_input_2_deadband = 0.0,
+	.analog_input_3_deadband = 0.0,
+	.analog_input_4_deadband = 0.0,
+	.analog_input_1_deadband_percent = 0.0,
+	.analog_input_2_deadband_percent = 0.0,
+	.analog_input_3_deadband_percent = 0.0,
+	.analog_input_4_deadband_percent = 0.0,
+	.deadband_heartbeat = 3600,
+	.temperature_sense_interval_min = 0,
+	.temperature_sense_interval_max = 0,
+	.temperature_slope_threshold = 1.0,
+	.analog_sense_interval_min = 0,
+	.analog_sense_interval_max = 0,
+	.analog_slope_threshold = 10.0,
+	.power_sense_interval_min = 0,
+	.power_sense_interval_max = 0,
+	.power_slope_threshold = 0.1,
+	.event_rate_limit = 0,
+	.event_rate_window = 60,
+	.advertising_dual_phy_ratio = 0,
+	.advertising_adaptive = 0,
+	.advertising_interval_fast = 250,
+	.advertising_interval_idle = 5000,
+	.advertising_interval_growth = 200,
+	.advertising_alarm_hold = 60
 };
 /* pyend */
 
@@ -270,6 +338,27 @@ typedef struct ro_attribute {
 	char lwm2m_fup_pkg_ver[32 + 1];
 	char bluetooth_address[12 + 1];
 	int16_t ble_rssi;
+	uint32_t sample_wakeups;
+	uint32_t sample_wakeups_per_hour;
+	int32_t temperature_sample_lateness;
+	uint32_t temperature_sample_jitter_max;
+	uint32_t temperature_sample_overruns;
+	int32_t analog_sample_lateness;
+	uint32_t analog_sample_jitter_max;
+	uint32_t analog_sample_overruns;
+	int32_t power_sample_lateness;
+	uint32_t power_sample_jitter_max;
+	uint32_t power_sample_overruns;
+	uint32_t event_rate_dropped;
+	uint32_t advert_hci_commands;
+	uint32_t advert_hci_commands_per_hour;
+	uint32_t advert_updates_skipped;
+	uint16_t advertising_interval_active;
+	uint32_t event_stream_notifications;
+	uint32_t event_stream_dropped;
+	uint32_t event_stream_latency;
+	uint32_t conn_policy_throughput;
+	uint32_t conn_policy_dle_blacklisted;
 } ro_attribute_t;
 /* pyend */
 
@@ -361,6 +450,27 @@ static const ro_attribute_t DEFAULT_RO_ATTRIBUTE_VALUES =  {
 	.lwm2m_fup_pkg_ver = "0.0.0",
 	.bluetooth_address = "0",
 	.ble_rssi = -128,
+	.sample_wakeups = 0,
+	.sample_wakeups_per_hour = 0,
+	.temperature_sample_lateness = 0,
+	.temperature_sample_jitter_max = 0,
+	.temperature_sample_overruns = 0,
+	.analog_sample_lateness = 0,
+	.analog_sample_jitter_max = 0,
+	.analog_sample_overruns = 0,
+	.power_sample_lateness = 0,
+	.power_sample_jitter_max = 0,
+	.power_sample_overruns = 0,
+	.event_rate_dropped = 0,
+	.advert_hci_commands = 0,
+	.advert_hci_commands_per_hour = 0,
+	.advert_updates_skipped = 0,
+	.advertising_interval_active = 0,
+	.event_stream_notifications = 0,
+	.event_stream_dropped = 0,
+	.event_stream_latency = 0,
+	.conn_policy_throughput = 0,
+	.conn_policy_dle_blacklisted = 0,
 };
 /* pyend */
 
@@ -438,61 +548,61 @@ const struct attr_table_entry ATTR_TABLE[ATTR_TABLE_SIZE] = {
 	[41 ] = { RO_ATTRS(api_version)                         , ATTR_TYPE_STRING        , 0x2   , av_string           , NULL                                , .min.ux = 6         , .max.ux = 11        },
 	[42 ] = { RO_ATTRX(qrtc)                                , ATTR_TYPE_U32           , 0x2   , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 0         },
 	[43 ] = { RW_ATTRX(qrtc_last_set)                       , ATTR_TYPE_U32           , 0x1a  , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 0         },
-	[44 ] = { RW_ATTRX(sh_offset)                           , ATTR_TYPE_FLOAT         , 0x13  , av_float            , NULL                                , .min.fx = 1.2e-38   , .max.fx = 3.4e+38   },
+	[44 ] = { RW_ATTRX(sh_offset)                           , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 1.2e-38   , .max.fx = 3.4e+38   },
 	[45 ] = { RW_ATTRX(analog_sense_interval)               , ATTR_TYPE_U32           , 0x1b  , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 86400     },
 	[46 ] = { RO_ATTRE(tamper_switch_status)                , ATTR_TYPE_BOOL          , 0xa   , av_bool             , NULL                                , .min.ux = 0         , .max.ux = 1         },
-	[47 ] = { RW_ATTRX(therm_1_coefficient_a)               , ATTR_TYPE_FLOAT         , 0x13  , av_float            , NULL                                , .min.fx = 1.2e-38   , .max.fx = 3.4e+38   },
-	[48 ] = { RW_ATTRX(therm_2_coefficient_a)               , ATTR_TYPE_FLOAT         , 0x13  , av_float            , NULL                                , .min.fx = 1.2e-38   , .max.fx = 3.4e+38   },
-	[49 ] = { RW_ATTRX(therm_3_coefficient_a)               , ATTR_TYPE_FLOAT         , 0x13  , av_float            , NULL                                , .min.fx = 1.2e-38   , .max.fx = 3.4e+38   },
-	[50 ] = { RW_ATTRX(therm_4_coefficient_a)               , ATTR_TYPE_FLOAT         , 0x13  , av_float            , NULL                                , .min.fx = 1.2e-38   , .max.fx = 3.4e+38   },
-	[51 ] = { RW_ATTRX(therm_1_coefficient_b)               , ATTR_TYPE_FLOAT         , 0x13  , av_float            , NULL                                , .min.fx = 1.2e-38   , .max.fx = 3.4e+38   },
-	[52 ] = { RW_ATTRX(therm_2_coefficient_b)               , ATTR_TYPE_FLOAT         , 0x13  , av_float            , NULL                                , .min.fx = 1.2e-38   , .max.fx = 3.4e+38   },
-	[53 ] = { RW_ATTRX(therm_3_coefficient_b)               , ATTR_TYPE_FLOAT         , 0x13  , av_float            , NULL                                , .min.fx = 1.2e-38   , .max.fx = 3.4e+38   },
-	[54 ] = { RW_ATTRX(therm_4_coefficient_b)               , ATTR_TYPE_FLOAT         , 0x13  , av_float            , NULL                                , .min.fx = 1.2e-38   , .max.fx = 3.4e+38   },
-	[55 ] = { RW_ATTRX(therm_1_coefficient_c)               , ATTR_TYPE_FLOAT         , 0x13  , av_float            , NULL                                , .min.fx = 1.2e-38   , .max.fx = 3.4e+38   },
-	[56 ] = { RW_ATTRX(therm_2_coefficient_c)               , ATTR_TYPE_FLOAT         , 0x13  , av_float            , NULL                                , .min.fx = 1.2e-38   , .max.fx = 3.4e+38   },
-	[57 ] = { RW_ATTRX(therm_3_coefficient_c)               , ATTR_TYPE_FLOAT         , 0x13  , av_float            , NULL                                , .min.fx = 1.2e-38   , .max.fx = 3.4e+38   },
-	[58 ] = { RW_ATTRX(therm_4_coefficient_c)               , ATTR_TYPE_FLOAT         , 0x13  , av_float            , NULL                                , .min.fx = 1.2e-38   , .max.fx = 3.4e+38   },
+	[47 ] = { RW_ATTRX(therm_1_coefficient_a)               , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 1.2e-38   , .max.fx = 3.4e+38   },
+	[48 ] = { RW_ATTRX(therm_2_coefficient_a)               , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 1.2e-38   , .max.fx = 3.4e+38   },
+	[49 ] = { RW_ATTRX(therm_3_coefficient_a)               , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 1.2e-38   , .max.fx = 3.4e+38   },
+	[50 ] = { RW_ATTRX(therm_4_coefficient_a)               , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 1.2e-38   , .max.fx = 3.4e+38   },
+	[51 ] = { RW_ATTRX(therm_1_coefficient_b)               , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 1.2e-38   , .max.fx = 3.4e+38   },
+	[52 ] = { RW_ATTRX(therm_2_coefficient_b)               , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 1.2e-38   , .max.fx = 3.4e+38   },
+	[53 ] = { RW_ATTRX(therm_3_coefficient_b)               , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 1.2e-38   , .max.fx = 3.4e+38   },
+	[54 ] = { RW_ATTRX(therm_4_coefficient_b)               , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 1.2e-38   , .max.fx = 3.4e+38   },
+	[55 ] = { RW_ATTRX(therm_1_coefficient_c)               , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 1.2e-38   , .max.fx = 3.4e+38   },
+	[56 ] = { RW_ATTRX(therm_2_coefficient_c)               , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 1.2e-38   , .max.fx = 3.4e+38   },
+	[57 ] = { RW_ATTRX(therm_3_coefficient_c)               , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 1.2e-38   , .max.fx = 3.4e+38   },
+	[58 ] = { RW_ATTRX(therm_4_coefficient_c)               , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 1.2e-38   , .max.fx = 3.4e+38   },
 	[59 ] = { RW_ATTRX(factory_reset_enable)                , ATTR_TYPE_BOOL          , 0x13  , av_bool             , NULL                                , .min.ux = 0         , .max.ux = 1         },
-	[60 ] = { RO_ATTRX(adc_power_simulated)                 , ATTR_TYPE_BOOL          , 0x3   , av_bool             , NULL                                , .min.ux = 0         , .max.ux = 1         },
+	[60 ] = { RO_ATTRX(adc_power_simulated)                 , ATTR_TYPE_BOOL          , 0x3   , av_simen            , NULL                                , .min.ux = 0         , .max.ux = 1         },
 	[61 ] = { RO_ATTRX(adc_power_simulated_counts)          , ATTR_TYPE_S16           , 0x3   , av_int16            , NULL                                , .min.sx = 0         , .max.sx = 4095      },
-	[62 ] = { RO_ATTRX(adc_analog_sensor_simulated)         , ATTR_TYPE_BOOL          , 0x3   , av_bool             , NULL                                , .min.ux = 0         , .max.ux = 1         },
+	[62 ] = { RO_ATTRX(adc_analog_sensor_simulated)         , ATTR_TYPE_BOOL          , 0x3   , av_simen            , NULL                                , .min.ux = 0         , .max.ux = 1         },
 	[63 ] = { RO_ATTRX(adc_analog_sensor_simulated_counts)  , ATTR_TYPE_S16           , 0x3   , av_int16            , NULL                                , .min.sx = 0         , .max.sx = 4095      },
-	[64 ] = { RO_ATTRX(adc_thermistor_simulated)            , ATTR_TYPE_BOOL          , 0x3   , av_bool             , NULL                                , .min.ux = 0         , .max.ux = 1         },
+	[64 ] = { RO_ATTRX(adc_thermistor_simulated)            , ATTR_TYPE_BOOL          , 0x3   , av_simen            , NULL                                , .min.ux = 0         , .max.ux = 1         },
 	[65 ] = { RO_ATTRX(adc_thermistor_simulated_counts)     , ATTR_TYPE_S16           , 0x3   , av_int16            , NULL                                , .min.sx = 0         , .max.sx = 4095      },
-	[66 ] = { RO_ATTRX(adc_vref_simulated)                  , ATTR_TYPE_BOOL          , 0x3   , av_bool             , NULL                                , .min.ux = 0         , .max.ux = 1         },
+	[66 ] = { RO_ATTRX(adc_vref_simulated)                  , ATTR_TYPE_BOOL          , 0x3   , av_simen            , NULL                                , .min.ux = 0         , .max.ux = 1         },
 	[67 ] = { RO_ATTRX(adc_vref_simulated_counts)           , ATTR_TYPE_S16           , 0x3   , av_int16            , NULL                                , .min.sx = 0         , .max.sx = 4095      },
-	[68 ] = { RO_ATTRX(voltage_1_simulated)                 , ATTR_TYPE_BOOL          , 0x3   , av_bool             , NULL                                , .min.ux = 0         , .max.ux = 1         },
+	[68 ] = { RO_ATTRX(voltage_1_simulated)                 , ATTR_TYPE_BOOL          , 0x3   , av_simen            , NULL                                , .min.ux = 0         , .max.ux = 1         },
 	[69 ] = { RO_ATTRX(voltage_1_simulated_value)           , ATTR_TYPE_FLOAT         , 0x3   , av_float            , NULL                                , .min.fx = -3.4e+38  , .max.fx = 3.4e+38   },
-	[70 ] = { RO_ATTRX(voltage_2_simulated)                 , ATTR_TYPE_BOOL          , 0x3   , av_bool             , NULL                                , .min.ux = 0         , .max.ux = 1         },
+	[70 ] = { RO_ATTRX(voltage_2_simulated)                 , ATTR_TYPE_BOOL          , 0x3   , av_simen            , NULL                                , .min.ux = 0         , .max.ux = 1         },
 	[71 ] = { RO_ATTRX(voltage_2_simulated_value)           , ATTR_TYPE_FLOAT         , 0x3   , av_float            , NULL                                , .min.fx = -3.4e+38  , .max.fx = 3.4e+38   },
-	[72 ] = { RO_ATTRX(voltage_3_simulated)                 , ATTR_TYPE_BOOL          , 0x3   , av_bool             , NULL                                , .min.ux = 0         , .max.ux = 1         },
+	[72 ] = { RO_ATTRX(voltage_3_simulated)                 , ATTR_TYPE_BOOL          , 0x3   , av_simen            , NULL                                , .min.ux = 0         , .max.ux = 1         },
 	[73 ] = { RO_ATTRX(voltage_3_simulated_value)           , ATTR_TYPE_FLOAT         , 0x3   , av_float            , NULL                                , .min.fx = -3.4e+38  , .max.fx = 3.4e+38   },
-	[74 ] = { RO_ATTRX(voltage_4_simulated)                 , ATTR_TYPE_BOOL          , 0x3   , av_bool             , NULL                                , .min.ux = 0         , .max.ux = 1         },
+	[74 ] = { RO_ATTRX(voltage_4_simulated)                 , ATTR_TYPE_BOOL          , 0x3   , av_simen            , NULL                                , .min.ux = 0         , .max.ux = 1         },
 	[75 ] = { RO_ATTRX(voltage_4_simulated_value)           , ATTR_TYPE_FLOAT         , 0x3   , av_float            , NULL                                , .min.fx = -3.4e+38  , .max.fx = 3.4e+38   },
-	[76 ] = { RO_ATTRX(ultrasonic_simulated)                , ATTR_TYPE_BOOL          , 0x3   , av_bool             , NULL                                , .min.ux = 0         , .max.ux = 1         },
+	[76 ] = { RO_ATTRX(ultrasonic_simulated)                , ATTR_TYPE_BOOL          , 0x3   , av_simen            , NULL                                , .min.ux = 0         , .max.ux = 1         },
 	[77 ] = { RO_ATTRX(ultrasonic_simulated_value)          , ATTR_TYPE_FLOAT         , 0x3   , av_float            , NULL                                , .min.fx = -3.4e+38  , .max.fx = 3.4e+38   },
-	[78 ] = { RO_ATTRX(pressure_simulated)                  , ATTR_TYPE_BOOL          , 0x3   , av_bool             , NULL                                , .min.ux = 0         , .max.ux = 1         },
+	[78 ] = { RO_ATTRX(pressure_simulated)                  , ATTR_TYPE_BOOL          , 0x3   , av_simen            , NULL                                , .min.ux = 0         , .max.ux = 1         },
 	[79 ] = { RO_ATTRX(pressure_simulated_value)            , ATTR_TYPE_FLOAT         , 0x3   , av_float            , NULL                                , .min.fx = -3.4e+38  , .max.fx = 3.4e+38   },
-	[80 ] = { RO_ATTRX(current_1_simulated)                 , ATTR_TYPE_BOOL          , 0x3   , av_bool             , NULL                                , .min.ux = 0         , .max.ux = 1         },
+	[80 ] = { RO_ATTRX(current_1_simulated)                 , ATTR_TYPE_BOOL          , 0x3   , av_simen            , NULL                                , .min.ux = 0         , .max.ux = 1         },
 	[81 ] = { RO_ATTRX(current_1_simulated_value)           , ATTR_TYPE_FLOAT         , 0x3   , av_float            , NULL                                , .min.fx = -3.4e+38  , .max.fx = 3.4e+38   },
-	[82 ] = { RO_ATTRX(current_2_simulated)                 , ATTR_TYPE_BOOL          , 0x3   , av_bool             , NULL                                , .min.ux = 0         , .max.ux = 1         },
+	[82 ] = { RO_ATTRX(current_2_simulated)                 , ATTR_TYPE_BOOL          , 0x3   , av_simen            , NULL                                , .min.ux = 0         , .max.ux = 1         },
 	[83 ] = { RO_ATTRX(current_2_simulated_value)           , ATTR_TYPE_FLOAT         , 0x3   , av_float            , NULL                                , .min.fx = -3.4e+38  , .max.fx = 3.4e+38   },
-	[84 ] = { RO_ATTRX(current_3_simulated)                 , ATTR_TYPE_BOOL          , 0x3   , av_bool             , NULL                                , .min.ux = 0         , .max.ux = 1         },
+	[84 ] = { RO_ATTRX(current_3_simulated)                 , ATTR_TYPE_BOOL          , 0x3   , av_simen            , NULL                                , .min.ux = 0         , .max.ux = 1         },
 	[85 ] = { RO_ATTRX(current_3_simulated_value)           , ATTR_TYPE_FLOAT         , 0x3   , av_float            , NULL                                , .min.fx = -3.4e+38  , .max.fx = 3.4e+38   },
-	[86 ] = { RO_ATTRX(current_4_simulated)                 , ATTR_TYPE_BOOL          , 0x3   , av_bool             , NULL                                , .min.ux = 0         , .max.ux = 1         },
+	[86 ] = { RO_ATTRX(current_4_simulated)                 , ATTR_TYPE_BOOL          , 0x3   , av_simen            , NULL                                , .min.ux = 0         , .max.ux = 1         },
 	[87 ] = { RO_ATTRX(current_4_simulated_value)           , ATTR_TYPE_FLOAT         , 0x3   , av_float            , NULL                                , .min.fx = -3.4e+38  , .max.fx = 3.4e+38   },
-	[88 ] = { RO_ATTRX(vref_simulated)                      , ATTR_TYPE_BOOL          , 0x3   , av_bool             , NULL                                , .min.ux = 0         , .max.ux = 1         },
+	[88 ] = { RO_ATTRX(vref_simulated)                      , ATTR_TYPE_BOOL          , 0x3   , av_simen            , NULL                                , .min.ux = 0         , .max.ux = 1         },
 	[89 ] = { RO_ATTRX(vref_simulated_value)                , ATTR_TYPE_FLOAT         , 0x3   , av_float            , NULL                                , .min.fx = -3.4e+38  , .max.fx = 3.4e+38   },
-	[90 ] = { RO_ATTRX(temperature_1_simulated)             , ATTR_TYPE_BOOL          , 0x3   , av_bool             , NULL                                , .min.ux = 0         , .max.ux = 1         },
+	[90 ] = { RO_ATTRX(temperature_1_simulated)             , ATTR_TYPE_BOOL          , 0x3   , av_simen            , NULL                                , .min.ux = 0         , .max.ux = 1         },
 	[91 ] = { RO_ATTRX(temperature_1_simulated_value)       , ATTR_TYPE_FLOAT         , 0x3   , av_float            , NULL                                , .min.fx = -3.4e+38  , .max.fx = 3.4e+38   },
-	[92 ] = { RO_ATTRX(temperature_2_simulated)             , ATTR_TYPE_BOOL          , 0x3   , av_bool             , NULL                                , .min.ux = 0         , .max.ux = 1         },
+	[92 ] = { RO_ATTRX(temperature_2_simulated)             , ATTR_TYPE_BOOL          , 0x3   , av_simen            , NULL                                , .min.ux = 0         , .max.ux = 1         },
 	[93 ] = { RO_ATTRX(temperature_2_simulated_value)       , ATTR_TYPE_FLOAT         , 0x3   , av_float            , NULL                                , .min.fx = -3.4e+38  , .max.fx = 3.4e+38   },
-	[94 ] = { RO_ATTRX(temperature_3_simulated)             , ATTR_TYPE_BOOL          , 0x3   , av_bool             , NULL                                , .min.ux = 0         , .max.ux = 1         },
+	[94 ] = { RO_ATTRX(temperature_3_simulated)             , ATTR_TYPE_BOOL          , 0x3   , av_simen            , NULL                                , .min.ux = 0         , .max.ux = 1         },
 	[95 ] = { RO_ATTRX(temperature_3_simulated_value)       , ATTR_TYPE_FLOAT         , 0x3   , av_float            , NULL                                , .min.fx = -3.4e+38  , .max.fx = 3.4e+38   },
-	[96 ] = { RO_ATTRX(temperature_4_simulated)             , ATTR_TYPE_BOOL          , 0x3   , av_bool             , NULL                                , .min.ux = 0         , .max.ux = 1         },
+	[96 ] = { RO_ATTRX(temperature_4_simulated)             , ATTR_TYPE_BOOL          , 0x3   , av_simen            , NULL                                , .min.ux = 0         , .max.ux = 1         },
 	[97 ] = { RO_ATTRX(temperature_4_simulated_value)       , ATTR_TYPE_FLOAT         , 0x3   , av_float            , NULL                                , .min.fx = -3.4e+38  , .max.fx = 3.4e+38   },
-	[98 ] = { RO_ATTRX(power_volts_simulated)               , ATTR_TYPE_BOOL          , 0x3   , av_bool             , NULL                                , .min.ux = 0         , .max.ux = 1         },
+	[98 ] = { RO_ATTRX(power_volts_simulated)               , ATTR_TYPE_BOOL          , 0x3   , av_simen            , NULL                                , .min.ux = 0         , .max.ux = 1         },
 	[99 ] = { RO_ATTRX(power_volts_simulated_value)         , ATTR_TYPE_FLOAT         , 0x3   , av_float            , NULL                                , .min.fx = 0.0       , .max.fx = 4.0       },
 	[100] = { RO_ATTRX(digital_input_1_simulated)           , ATTR_TYPE_BOOL          , 0x3   , av_din1simen        , NULL                                , .min.ux = 0         , .max.ux = 1         },
 	[101] = { RO_ATTRX(digital_input_1_simulated_value)     , ATTR_TYPE_BOOL          , 0x3   , av_din1sim          , NULL                                , .min.ux = 0         , .max.ux = 1         },
@@ -510,7 +620,7 @@ const struct attr_table_entry ATTR_TABLE[ATTR_TABLE_SIZE] = {
 	[113] = { RW_ATTRS(load_path)                           , ATTR_TYPE_STRING        , 0x13  , av_string           , NULL                                , .min.ux = 0         , .max.ux = 32        },
 	[114] = { RO_ATTRS(dump_path)                           , ATTR_TYPE_STRING        , 0x2   , av_string           , NULL                                , .min.ux = 0         , .max.ux = 32        },
 	[115] = { RO_ATTRE(bluetooth_flags)                     , ATTR_TYPE_U32           , 0xb   , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 0         },
-	[116] = { RW_ATTRE(event_filter_flags)                  , ATTR_TYPE_U32           , 0x13  , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 2097151   },
+	[116] = { RW_ATTRE(event_filter_flags)                  , ATTR_TYPE_U32           , 0x1b  , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 2097151   },
 	[117] = { RO_ATTRS(board)                               , ATTR_TYPE_STRING        , 0x2   , av_string           , NULL                                , .min.ux = 1         , .max.ux = 64        },
 	[118] = { RW_ATTRX(log_on_boot)                         , ATTR_TYPE_BOOL          , 0x1b  , av_bool             , NULL                                , .min.ux = 0         , .max.ux = 1         },
 	[119] = { RO_ATTRX(input_config_changed)                , ATTR_TYPE_BOOL          , 0x2   , av_bool             , NULL                                , .min.ux = 0         , .max.ux = 1         },
@@ -551,7 +661,62 @@ const struct attr_table_entry ATTR_TABLE[ATTR_TABLE_SIZE] = {
 	[154] = { RW_ATTRX(smp_auth_req)                        , ATTR_TYPE_BOOL          , 0x1b  , av_bool             , NULL                                , .min.ux = 0         , .max.ux = 1         },
 	[155] = { RW_ATTRX(smp_auth_timeout)                    , ATTR_TYPE_U32           , 0x1b  , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 86400     },
 	[156] = { RW_ATTRS(shell_password)                      , ATTR_TYPE_STRING        , 0x91  , av_string           , NULL                                , .min.ux = 4         , .max.ux = 32        },
-	[157] = { RW_ATTRX(shell_session_timeout)               , ATTR_TYPE_U8            , 0x13  , av_uint8            , NULL                                , .min.ux = 0         , .max.ux = 255       }
+	[157] = { RW_ATTRX(shell_session_timeout)               , ATTR_TYPE_U8            , 0x13  , av_uint8            , NULL                                , .min.ux = 0         , .max.ux = 255       },
+	[158] = { RW_ATTRX(temperature_1_deadband)              , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 0.0       , .max.fx = 3.4e+38   },
+	[159] = { RW_ATTRX(temperature_2_deadband)              , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 0.0       , .max.fx = 3.4e+38   },
+	[160] = { RW_ATTRX(temperature_3_deadband)              , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 0.0       , .max.fx = 3.4e+38   },
+	[161] = { RW_ATTRX(temperature_4_deadband)              , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 0.0       , .max.fx = 3.4e+38   },
+	[162] = { RW_ATTRX(temperature_1_deadband_percent)      , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 0.0       , .max.fx = 100.0     },
+	[163] = { RW_ATTRX(temperature_2_deadband_percent)      , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 0.0       , .max.fx = 100.0     },
+	[164] = { RW_ATTRX(temperature_3_deadband_percent)      , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 0.0       , .max.fx = 100.0     },
+	[165] = { RW_ATTRX(temperature_4_deadband_percent)      , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 0.0       , .max.fx = 100.0     },
+	[166] = { RW_ATTRX(analog_input_1_deadband)             , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 0.0       , .max.fx = 3.4e+38   },
+	[167] = { RW_ATTRX(analog_input_2_deadband)             , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 0.0       , .max.fx = 3.4e+38   },
+	[168] = { RW_ATTRX(analog_input_3_deadband)             , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 0.0       , .max.fx = 3.4e+38   },
+	[169] = { RW_ATTRX(analog_input_4_deadband)             , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 0.0       , .max.fx = 3.4e+38   },
+	[170] = { RW_ATTRX(analog_input_1_deadband_percent)     , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 0.0       , .max.fx = 100.0     },
+	[171] = { RW_ATTRX(analog_input_2_deadband_percent)     , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 0.0       , .max.fx = 100.0     },
+	[172] = { RW_ATTRX(analog_input_3_deadband_percent)     , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 0.0       , .max.fx = 100.0     },
+	[173] = { RW_ATTRX(analog_input_4_deadband_percent)     , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 0.0       , .max.fx = 100.0     },
+	[174] = { RW_ATTRX(deadband_heartbeat)                  , ATTR_TYPE_U32           , 0x1b  , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 604800    },
+	[175] = { RW_ATTRX(temperature_sense_interval_min)      , ATTR_TYPE_U32           , 0x1b  , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 86400     },
+	[176] = { RW_ATTRX(temperature_sense_interval_max)      , ATTR_TYPE_U32           , 0x1b  , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 86400     },
+	[177] = { RW_ATTRX(temperature_slope_threshold)         , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 0.0       , .max.fx = 3.4e+38   },
+	[178] = { RW_ATTRX(analog_sense_interval_min)           , ATTR_TYPE_U32           , 0x1b  , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 86400     },
+	[179] = { RW_ATTRX(analog_sense_interval_max)           , ATTR_TYPE_U32           , 0x1b  , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 86400     },
+	[180] = { RW_ATTRX(analog_slope_threshold)              , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 0.0       , .max.fx = 3.4e+38   },
+	[181] = { RW_ATTRX(power_sense_interval_min)            , ATTR_TYPE_U32           , 0x1b  , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 86400     },
+	[182] = { RW_ATTRX(power_sense_interval_max)            , ATTR_TYPE_U32           , 0x1b  , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 86400     },
+	[183] = { RW_ATTRX(power_slope_threshold)               , ATTR_TYPE_FLOAT         , 0x1b  , av_float            , NULL                                , .min.fx = 0.0       , .max.fx = 3.4e+38   },
+	[184] = { RO_ATTRX(sample_wakeups)                      , ATTR_TYPE_U32           , 0x2   , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 0         },
+	[185] = { RO_ATTRX(sample_wakeups_per_hour)             , ATTR_TYPE_U32           , 0x2   , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 0         },
+	[186] = { RO_ATTRX(temperature_sample_lateness)         , ATTR_TYPE_S32           , 0x2   , av_int32            , NULL                                , .min.sx = 0         , .max.sx = 0         },
+	[187] = { RO_ATTRX(temperature_sample_jitter_max)       , ATTR_TYPE_U32           , 0x2   , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 0         },
+	[188] = { RO_ATTRX(temperature_sample_overruns)         , ATTR_TYPE_U32           , 0x2   , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 0         },
+	[189] = { RO_ATTRX(analog_sample_lateness)              , ATTR_TYPE_S32           , 0x2   , av_int32            , NULL                                , .min.sx = 0         , .max.sx = 0         },
+	[190] = { RO_ATTRX(analog_sample_jitter_max)            , ATTR_TYPE_U32           , 0x2   , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 0         },
+	[191] = { RO_ATTRX(analog_sample_overruns)              , ATTR_TYPE_U32           , 0x2   , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 0         },
+	[192] = { RO_ATTRX(power_sample_lateness)               , ATTR_TYPE_S32           , 0x2   , av_int32            , NULL                                , .min.sx = 0         , .max.sx = 0         },
+	[193] = { RO_ATTRX(power_sample_jitter_max)             , ATTR_TYPE_U32           , 0x2   , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 0         },
+	[194] = { RO_ATTRX(power_sample_overruns)               , ATTR_TYPE_U32           , 0x2   , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 0         },
+	[195] = { RW_ATTRX(event_rate_limit)                    , ATTR_TYPE_U32           , 0x1b  , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 1000      },
+	[196] = { RW_ATTRX(event_rate_window)                   , ATTR_TYPE_U32           , 0x1b  , av_uint32           , NULL                                , .min.ux = 1         , .max.ux = 86400     },
+	[197] = { RO_ATTRX(event_rate_dropped)                  , ATTR_TYPE_U32           , 0x2   , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 0         },
+	[198] = { RO_ATTRX(advert_hci_commands)                 , ATTR_TYPE_U32           , 0x2   , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 0         },
+	[199] = { RO_ATTRX(advert_hci_commands_per_hour)        , ATTR_TYPE_U32           , 0x2   , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 0         },
+	[200] = { RO_ATTRX(advert_updates_skipped)              , ATTR_TYPE_U32           , 0x2   , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 0         },
+	[201] = { RW_ATTRX(advertising_dual_phy_ratio)          , ATTR_TYPE_U8            , 0x1b  , av_uint8            , NULL                                , .min.ux = 0         , .max.ux = 10        },
+	[202] = { RW_ATTRX(advertising_adaptive)                , ATTR_TYPE_BOOL          , 0x1b  , av_bool             , NULL                                , .min.ux = 0         , .max.ux = 1         },
+	[203] = { RW_ATTRX(advertising_interval_fast)           , ATTR_TYPE_U16           , 0x1b  , av_uint16           , NULL                                , .min.ux = 100       , .max.ux = 10000     },
+	[204] = { RW_ATTRX(advertising_interval_idle)           , ATTR_TYPE_U16           , 0x1b  , av_uint16           , NULL                                , .min.ux = 500       , .max.ux = 10000     },
+	[205] = { RW_ATTRX(advertising_interval_growth)         , ATTR_TYPE_U16           , 0x1b  , av_uint16           , NULL                                , .min.ux = 101       , .max.ux = 1000      },
+	[206] = { RW_ATTRX(advertising_alarm_hold)              , ATTR_TYPE_U16           , 0x1b  , av_uint16           , NULL                                , .min.ux = 0         , .max.ux = 3600      },
+	[207] = { RO_ATTRX(advertising_interval_active)         , ATTR_TYPE_U16           , 0x2   , av_uint16           , NULL                                , .min.ux = 0         , .max.ux = 0         },
+	[208] = { RO_ATTRX(event_stream_notifications)          , ATTR_TYPE_U32           , 0x2   , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 0         },
+	[209] = { RO_ATTRX(event_stream_dropped)                , ATTR_TYPE_U32           , 0x2   , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 0         },
+	[210] = { RO_ATTRX(event_stream_latency)                , ATTR_TYPE_U32           , 0x2   , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 0         },
+	[211] = { RO_ATTRX(conn_policy_throughput)              , ATTR_TYPE_U32           , 0x2   , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 0         },
+	[212] = { RO_ATTRX(conn_policy_dle_blacklisted)         , ATTR_TYPE_U32           , 0x2   , av_uint32           , NULL                                , .min.ux = 0         , .max.ux = 0         }
 };
 /* pyend */
 
@@ -0,0 +1,93 @@
+/**
+ * @file AdaptiveInterval.h
+ * @brief Sample intervals that follow how fast a group of signals changes
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __ADAPTIVE_INTERVAL_H__
+#define __ADAPTIVE_INTERVAL_H__
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include <zephyr/types.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/* Global Constants, Macros and Type Definitions                              */
+/******************************************************************************/
+/* Most channels in a group */
+#define ADAPTIVE_INTERVAL_CHANNELS 4
+
+/* Adaptive interval settings for a group of channels */
+typedef struct AdaptiveConfig {
+	/* Seconds. A min of 0 or a max below min keeps the fixed interval. */
+	uint32_t min;
+	uint32_t max;
+	/* Milli-units per minute */
+	int32_t slope_threshold;
+} AdaptiveConfig_t;
+
+/* Adaptive sampling state for a group of channels. The interval is 0 until
+ * the first scan has completed.
+ */
+typedef struct AdaptiveState {
+	uint32_t interval;
+	bool fast;
+	uint8_t valid;
+	int32_t last[ADAPTIVE_INTERVAL_CHANNELS];
+	int64_t timestamp[ADAPTIVE_INTERVAL_CHANNELS];
+} AdaptiveState_t;
+
+/******************************************************************************/
+/* Global Function Prototypes                                                 */
+/******************************************************************************/
+/**
+ * @brief Add a reading of one channel to the current scan. The scan is fast
+ * when the rate of change since the previous reading of the channel is above
+ * the threshold.
+ *
+ * @param state of the group
+ * @param channel less than ADAPTIVE_INTERVAL_CHANNELS
+ * @param value in milli-units
+ * @param threshold in milli-units per minute
+ * @param now uptime of the reading in milliseconds
+ */
+void AdaptiveInterval_Sample(AdaptiveState_t *state, size_t channel,
+			     int32_t value, int32_t threshold, int64_t now);
+
+/**
+ * @brief End a scan. A fast scan drops straight to the shortest interval and
+ * a flat one doubles the interval up to the longest.
+ *
+ * @param state of the group
+ * @param cfg settings of the group
+ */
+void AdaptiveInterval_Update(AdaptiveState_t *state,
+			     const AdaptiveConfig_t *cfg);
+
+/**
+ * @brief Get the time until the next scan
+ *
+ * @param state of the group
+ * @param cfg settings of the group
+ * @param fixed interval in seconds, 0 disables sampling
+ *
+ * @retval interval in seconds, the fixed interval when adaptive sampling is
+ * disabled or no scan has completed
+ */
+uint32_t AdaptiveInterval_Get(const AdaptiveState_t *state,
+			      const AdaptiveConfig_t *cfg, uint32_t fixed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ADAPTIVE_INTERVAL_H__ */
@@ -15,6 +15,8 @@
 #include <zephyr/types.h>
 #include <stddef.h>
 
+#include "Framework.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -65,6 +67,28 @@ typedef enum AdcPwrSequence {
 	ADC_PWR_SEQ_BYPASS
 } AdcPwrSequence_t;
 
+/* A scan measures several mux inputs with the circuit powered once.
+ * Bit n of channel_mask selects MuxInput_t n. All of the selected types must
+ * use the same circuit (thermistor or analog) because they cannot be
+ * interleaved.
+ */
+typedef struct AdcBt6ScanPlan {
+	uint8_t channel_mask;
+	AdcMeasurementType_t type[NUMBER_OF_ANALOG_INPUTS];
+} AdcBt6ScanPlan_t;
+
+/* The integer conversions return the float result scaled by this */
+#define ADC_BT6_MILLI 1000
+
+typedef struct AdcBt6Stats {
+	/* Number of circuit power enables plus disables */
+	uint32_t transitions;
+	/* Total time spent busy waiting for power and mux settling */
+	uint32_t busy_wait_us;
+	/* Number of I2C writes to the expander output register */
+	uint32_t expander_writes;
+} AdcBt6Stats_t;
+
 /******************************************************************************/
 /* Global Function Prototypes                                                 */
 /******************************************************************************/
@@ -95,11 +119,81 @@ int AdcBt6_read_power_volts(int16_t *raw, float *v);
  * @param pwr Use a power sequence otherwise the user must
  * call ConfigPower and DisablePower before and this operation.
  *
+ * @note Pressure and ultrasonic sensors are brought up in the order circuit
+ * power, mux, then the 5V and B+ rails. They settle for 100 ms (pressure) or
+ * 400 ms (ultrasonic) without the ADC lock held, so other measurements can
+ * run meanwhile, but the caller is blocked. Use AdcBt6_MeasureSettled to
+ * measure them without blocking.
+ *
  * @retval 0 on success, negative otherwise
  */
 int AdcBt6_Measure(int16_t *raw, MuxInput_t input, AdcMeasurementType_t type,
 		   AdcPwrSequence_t power);
 
+/**
+ * @brief Start measuring a group of pressure and ultrasonic inputs without
+ * blocking for the sensors to settle.
+ *
+ * @note The circuit is powered and the first input selected before the 5V
+ * and B+ rails are enabled. The rails are enabled once for the whole group
+ * and the longest settle time of the selected types is waited once. The ADC
+ * lock is only taken to power the circuit and for the conversions, and the
+ * rails are disabled after the last one. The results are sent to rxId as an
+ * AnalogSettledMsg_t with code FMC_ANALOG_SETTLED. The status of the message
+ * is the bitmask of the inputs that were sampled, or a negative error code.
+ * Sending is retried for about a second while the buffer pool is exhausted,
+ * after which the results are dropped. The receiver must not rely on the
+ * message arriving.
+ *
+ * @param plan of inputs to measure. Every type must be pressure or
+ * ultrasonic.
+ * @param rxId is the framework task that receives the results
+ *
+ * @retval 0 if started, -EBUSY if a group is already settling,
+ * negative error code otherwise
+ */
+int AdcBt6_MeasureSettled(const AdcBt6ScanPlan_t *plan, FwkId_t rxId);
+
+/**
+ * @brief Measure the RMS of an analog input over a burst of samples.
+ *
+ * @note The burst spans CONFIG_ADC_BT6_AC_BURST_SAMPLES samples taken every
+ * CONFIG_ADC_BT6_AC_BURST_INTERVAL_US. The ADC lock is held for the whole
+ * burst (100 ms with the defaults), so other measurements wait for it. When
+ * CONFIG_ADC_BT6_AC_CURRENT_BURST is disabled this is the same as
+ * AdcBt6_Measure.
+ *
+ * @param rms is the RMS value of the AC part of the input in ADC counts. The
+ * mean of the burst (the DC offset) is removed.
+ * @param input is the input (0-3) to measure
+ * @param type of measurement to perform (voltage or current)
+ * @param pwr power sequence (see AdcBt6_Measure)
+ *
+ * @retval 0 on success, negative otherwise
+ */
+int AdcBt6_MeasureRms(int16_t *rms, MuxInput_t input, AdcMeasurementType_t type,
+		      AdcPwrSequence_t power);
+
+/**
+ * @brief Measure all of the inputs selected by a scan plan in one ADC
+ * session. The circuit is powered up once before the first input and
+ * powered down once after the last.
+ *
+ * @param plan of inputs and the type of measurement for each
+ * @param results array of NUMBER_OF_ANALOG_INPUTS raw values indexed by input
+ *
+ * @retval bitmask of the inputs that were sampled successfully,
+ * negative error code otherwise
+ */
+int AdcBt6_MeasureScan(const AdcBt6ScanPlan_t *plan, int16_t *results);
+
+/**
+ * @brief Get the running power sequencing and expander counters.
+ *
+ * @param stats is filled with the counts since boot
+ */
+void AdcBt6_GetStats(AdcBt6Stats_t *stats);
+
 /**
  * @brief Calibrate thermistor with therm1 connected to a  ~560 Ohm resistor
  * and therm2 connected to a ~330K Ohm resistor.
@@ -137,18 +231,22 @@ void AdcBt6_ConfigPower(AdcMeasurementType_t type);
 void AdcBt6_DisablePower(void);
 
 /**
- * @brief Helper Functions
+ * @brief Hold the 5V and B+ rails on for pressure and ultrasonic sensors.
  *
- * @note These functions include the required switching time delays when
- * power is enabled. Enable 5V output before enabling b+.  Disable 5V
- * after disabling b+.
+ * @note The rails are reference counted. The first user enables 5V and then
+ * B+, including the switching delays, and the last release disables B+ and
+ * then 5V. Every call must be paired with AdcBt6_RailsRelease.
  *
  * @retval negative on error, 0 on success.
  */
-int AdcBt6_FiveVoltEnable(void);
-int AdcBt6_FiveVoltDisable(void);
-int AdcBt6_BplusEnable(void);
-int AdcBt6_BplusDisable(void);
+int AdcBt6_RailsAcquire(void);
+
+/**
+ * @brief Release a hold taken with AdcBt6_RailsAcquire.
+ *
+ * @retval negative on error, 0 on success.
+ */
+int AdcBt6_RailsRelease(void);
 
 /**
  * @brief Conversion function
@@ -200,17 +298,33 @@ float AdcBt6_ConvertACCurrent150(size_t channel, int32_t raw);
 float AdcBt6_ConvertACCurrent500(size_t channel, int32_t raw);
 
 /**
- * @brief Configure the analog input selection.
+ * @brief Integer conversion functions. These don't use the FPU.
+ *
+ * @retval the result of the matching float conversion multiplied by
+ * ADC_BT6_MILLI (for example millivolts from AdcBt6_ConvertVoltageMilli)
+ */
+int32_t AdcBt6_ConvertVoltageMilli(size_t channel, int32_t raw);
+int32_t AdcBt6_ConvertUltrasonicMilli(size_t channel, int32_t raw);
+int32_t AdcBt6_ConvertPressureMilli(size_t channel, int32_t raw);
+int32_t AdcBt6_ConvertCurrentMilli(size_t channel, int32_t raw);
+int32_t AdcBt6_ConvertACCurrent20Milli(size_t channel, int32_t raw);
+int32_t AdcBt6_ConvertACCurrent150Milli(size_t channel, int32_t raw);
+int32_t AdcBt6_ConvertACCurrent500Milli(size_t channel, int32_t raw);
+int32_t AdcBt6_ConvertThermToTemperatureMilli(size_t channel, int32_t raw);
+
+/**
+ * @brief Configure the analog input selection from the analog input types.
+ * Call this when an analog_input_N_type changes.
  *
  * @note
  * The AINx_SEL lines need to be maintained at all times.
  * There will always be a voltage or current applied at the terminal so
  * the proper terminal load is required.
  * (2M for voltage input, 250 ohm for current input)
+ * The expander is only written when the selection changes.
  *
  * @retval negative error code, 0 on success
  */
-/* todo: this needs to be called from sensor task when type 1-4 changes */
 int AdcBt6_ConfigAinSelects(void);
 
 /**
@@ -229,12 +343,25 @@ float AdcBt6_ConvertVref(int32_t raw);
 float AdcBt6_ApplyThermistorCalibration(int32_t raw);
 
 /**
- * @brief Use Steinhart-Hart equation to calculate temperature.
+ * @brief Convert a thermistor reading to temperature.
+ *
+ * @note The result is interpolated from a per-channel table of the
+ * Steinhart-Hart equation and is limited to -40 to 125 Celsius. An open
+ * circuit reads -40 and a short reads 125.
  *
  * @retval temperature in Celsius
  */
 float AdcBt6_ConvertThermToTemperature(size_t channel, int32_t raw);
 
+/**
+ * @brief Rebuild the thermistor tables. Call this when a Steinhart-Hart
+ * coefficient, the offset or the calibration changes.
+ *
+ * @note The tables are built on the calling thread and then published in
+ * one step. Conversions made during the build use the previous tables.
+ */
+void AdcBt6_RebuildThermistorTables(void);
+
 /**
  * @brief Get type enum as string.
  */
@@ -0,0 +1,54 @@
+/**
+ * @file AdvertInterval.h
+ * @brief Advertising interval that follows the event traffic
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __ADVERT_INTERVAL_H__
+#define __ADVERT_INTERVAL_H__
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include <zephyr/types.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/* Global Constants, Macros and Type Definitions                              */
+/******************************************************************************/
+typedef struct AdvertIntervalConfig {
+	/* Milliseconds */
+	uint32_t fast;
+	uint32_t idle;
+	/* The next interval as a percentage of the previous one */
+	uint32_t growth;
+} AdvertIntervalConfig_t;
+
+/******************************************************************************/
+/* Global Function Prototypes                                                 */
+/******************************************************************************/
+/**
+ * @brief Get the advertising interval for the next advertising duration.
+ * A busy duration uses the fast interval. Otherwise the interval grows
+ * towards the idle interval.
+ *
+ * @param current interval in milliseconds
+ * @param busy true when there are new events or a fresh alarm
+ * @param cfg interval bounds and growth
+ *
+ * @retval interval in milliseconds, between fast and idle
+ */
+uint32_t AdvertInterval_Next(uint32_t current, bool busy,
+			     const AdvertIntervalConfig_t *cfg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ADVERT_INTERVAL_H__ */
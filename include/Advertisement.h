@@ -64,6 +64,27 @@ void Advertisement_ExtendedSet(bool status);
  */
 int Advertisement_Update(SensorMsg_t *sensor_event);
 
+/**
+ * @brief Update the advertisement with several events. The first event is
+ * placed in the legacy record. When event packing is enabled all of them are
+ * placed in the packed record of the coded PHY advertisement.
+ *
+ * @param events to advertise, highest priority first
+ * @param count of events, at most Advertisement_EventCapacity()
+ *
+ * @retval negative error code, 0 on success
+ */
+int Advertisement_UpdateEvents(const SensorMsg_t *events, size_t count);
+
+/**
+ * @brief Get the number of events that one advertisement can carry with the
+ * PHY that is enabled
+ *
+ * @retval 1 for legacy advertisements or when the 1M set also runs,
+ * otherwise the packed event limit
+ */
+size_t Advertisement_EventCapacity(void);
+
 /**
  * @brief The advertisment interval has been set elsewhere and needs 
  * parameter changed and read from the attribute
@@ -72,6 +93,16 @@ int Advertisement_Update(SensorMsg_t *sensor_event);
  */
 int Advertisement_IntervalUpdate(void);
 
+/**
+ * @brief Set the advertisment interval without changing the interval
+ * attribute. Advertising is only restarted if the interval changed.
+ *
+ * @param milliseconds advertising interval
+ *
+ * @retval negative error code, 0 on success
+ */
+int Advertisement_IntervalSet(uint32_t milliseconds);
+
 /**
  * @brief This will set the interval back to what default was and 
  * not change interval attribute
@@ -15,6 +15,9 @@
 #include <zephyr/types.h>
 #include <stddef.h>
 
+#include "lcz_sensor_event.h"
+#include "Advertisement.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -54,6 +57,23 @@ bool ble_is_connected(void);
  */
 bool ble_conn_last_was_le_coded(void);
 
+/**
+ * @brief Add an event to the pending advertisement events. There is one slot
+ * for each event type and a newer event replaces one that hasn't been sent.
+ * Alarms are advertised before periodic readings. Events are only stored in
+ * active mode when there isn't a connection. In a connection they are passed
+ * to the event stream when it is enabled.
+ *
+ * @note This can be called from any thread.
+ *
+ * @param sensor_event to advertise
+ *
+ * @retval 0 on success, -EPERM if events aren't being advertised or
+ * streamed, -EINVAL if the event type is never advertised, -ENOMEM if the
+ * event stream queue is full
+ */
+int BleTask_PostEvent(const SensorMsg_t *sensor_event);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,39 @@
+/**
+ * @file ConnPolicy.h
+ * @brief Connection parameters that follow mcumgr image and file traffic
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __CONN_POLICY_H__
+#define __CONN_POLICY_H__
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include <zephyr/types.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/* Global Function Prototypes                                                 */
+/******************************************************************************/
+/**
+ * @brief Report image or file management traffic. The first call after the
+ * link has been idle requests the transfer parameters, each call restarts
+ * the idle timer. Calls are ignored unless the connected client has
+ * subscribed to the Bluetooth SMP characteristic.
+ *
+ * @param bytes of image data received, 0 if the amount isn't known
+ */
+void ConnPolicy_Activity(size_t bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CONN_POLICY_H__ */
@@ -0,0 +1,71 @@
+/**
+ * @file EventPack.h
+ * @brief Several sensor events packed into one advertising record
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __EVENT_PACK_H__
+#define __EVENT_PACK_H__
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include <zephyr/types.h>
+#include <stddef.h>
+
+#include "lcz_sensor_event.h"
+#include "Advertisement.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/* Global Constants, Macros and Type Definitions                              */
+/******************************************************************************/
+/* Record layout, all fields are little endian.
+ *
+ * Header
+ *   companyId   2
+ *   protocolId  2
+ *   version     1
+ *   count       1  number of events that follow
+ *   epoch       4  seconds of the newest event
+ * Event
+ *   recordType  1  SensorEventType_t
+ *   epochDelta  2  seconds before the record epoch, saturated
+ *   id          2  least significant bits of the event id
+ *   data        4  SensorEventData_t
+ */
+#define EVENT_PACK_PROTOCOL_ID 0x0080
+#define EVENT_PACK_VERSION 1
+#define EVENT_PACK_HEADER_SIZE 10
+#define EVENT_PACK_EVENT_SIZE 9
+
+#define EVENT_PACK_SIZE(n)                                                     \
+	(EVENT_PACK_HEADER_SIZE + ((n) * EVENT_PACK_EVENT_SIZE))
+
+/******************************************************************************/
+/* Global Function Prototypes                                                 */
+/******************************************************************************/
+/**
+ * @brief Encode events into a packed record
+ *
+ * @param buf destination
+ * @param size of destination
+ * @param events to encode, 0 gives a record with only the header
+ * @param count of events
+ *
+ * @retval length of the record, -EINVAL if there are too many events,
+ * -ENOMEM if it doesn't fit
+ */
+int EventPack_Encode(uint8_t *buf, size_t size, const SensorMsg_t *events,
+		     size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __EVENT_PACK_H__ */
@@ -0,0 +1,55 @@
+/**
+ * @file EventStream.h
+ * @brief GATT service that streams sensor events to a connected client
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __EVENT_STREAM_H__
+#define __EVENT_STREAM_H__
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include <zephyr/types.h>
+#include <stddef.h>
+
+#include "lcz_sensor_event.h"
+#include "Advertisement.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/* Global Constants, Macros and Type Definitions                              */
+/******************************************************************************/
+/* Each notification holds as many records as fit in the ATT MTU. All fields
+ * are little endian.
+ *
+ *   type   1  SensorEventType_t
+ *   id     4
+ *   epoch  4
+ *   data   4  SensorEventData_t
+ */
+#define EVENT_STREAM_RECORD_SIZE 13
+
+/******************************************************************************/
+/* Global Function Prototypes                                                 */
+/******************************************************************************/
+/**
+ * @brief Queue an event for the connected client
+ *
+ * @param sensor_event to send
+ *
+ * @retval 0 on success, -EPERM if no client is subscribed,
+ * -ENOMEM if the queue is full
+ */
+int EventStream_Post(const SensorMsg_t *sensor_event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __EVENT_STREAM_H__ */
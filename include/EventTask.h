@@ -15,6 +15,8 @@
 #include <zephyr/types.h>
 #include <stddef.h>
 
+#include "lcz_sensor_event.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -40,6 +42,32 @@ extern "C" {
  */
 void EventTask_Initialize(void);
 
+/**
+ * @brief Filter, timestamp and queue a sensor event for advertising.
+ *
+ * @note This runs in the context of the producer and doesn't take a buffer
+ * from the pool. The event is written once into the BLE task advertisement
+ * queue.
+ *
+ * @param type of event
+ * @param data of event
+ * @param sampleTime is the uptime in milliseconds when the data was acquired,
+ * 0 to use the current time
+ *
+ * @retval 0 on success, -EPERM if the event type is filtered or rate
+ * limited, negative error code if it can't be queued. The latest rate limited
+ * event of each type is sent when its window ends.
+ */
+int EventTask_Post(SensorEventType_t type, SensorEventData_t data,
+		   int64_t sampleTime);
+
+/**
+ * @brief Get the event_filter_flags bit of an event type.
+ *
+ * @retval the bit, 0 if the type is never advertised
+ */
+uint32_t EventTask_FilterBit(SensorEventType_t type);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,81 @@
+/**
+ * @file PendingEvents.h
+ * @brief Events waiting to be advertised, one slot per event type
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __PENDING_EVENTS_H__
+#define __PENDING_EVENTS_H__
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include <zephyr/types.h>
+#include <stdbool.h>
+
+#include "lcz_sensor_event.h"
+#include "Advertisement.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/* Global Constants, Macros and Type Definitions                              */
+/******************************************************************************/
+/* An event is stored in the slot given by the bit position of its
+ * event_filter_flags bit. A newer event of the same type replaces it.
+ */
+#define PENDING_EVENTS_SLOTS 32
+
+typedef struct PendingEvents {
+	SensorMsg_t slot[PENDING_EVENTS_SLOTS];
+	/* Bit n is set when slot n hasn't been taken */
+	uint32_t pending;
+	/* Round robin position within each priority class */
+	uint8_t alarmCursor;
+	uint8_t telemetryCursor;
+} PendingEvents_t;
+
+/******************************************************************************/
+/* Global Function Prototypes                                                 */
+/******************************************************************************/
+/**
+ * @brief Store an event. The caller serialises access to the store.
+ *
+ * @param store of events
+ * @param event to store
+ * @param bit of the event type, exactly one bit must be set
+ *
+ * @retval true if an event of the same type that hadn't been taken was
+ * replaced
+ */
+bool PendingEvents_Put(PendingEvents_t *store, const SensorMsg_t *event,
+		       uint32_t bit);
+
+/**
+ * @brief Take the next event. Alarms are taken before the other events.
+ * Within each class the slots are taken round robin so that a fast changing
+ * reading can't starve the others.
+ *
+ * @param store of events
+ * @param alarms bits of the event types that are alarms
+ * @param event taken
+ *
+ * @retval 0 on success, -ENOENT if the store is empty
+ */
+int PendingEvents_Take(PendingEvents_t *store, uint32_t alarms,
+		       SensorMsg_t *event);
+
+/**
+ * @brief Discard all of the events
+ */
+void PendingEvents_Purge(PendingEvents_t *store);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PENDING_EVENTS_H__ */
@@ -0,0 +1,66 @@
+/**
+ * @file PeriodicAdvert.h
+ * @brief Periodic advertising train carrying a rolling window of samples
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __PERIODIC_ADVERT_H__
+#define __PERIODIC_ADVERT_H__
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include <zephyr/types.h>
+#include <stddef.h>
+
+#include "lcz_sensor_event.h"
+#include "PeriodicFrame.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/* Global Function Prototypes                                                 */
+/******************************************************************************/
+/**
+ * @brief Create the periodic advertising set
+ *
+ * @retval negative error code, 0 on success
+ */
+int PeriodicAdvert_Init(void);
+
+/**
+ * @brief Start the periodic advertising train
+ *
+ * @retval negative error code, 0 on success
+ */
+int PeriodicAdvert_Start(void);
+
+/**
+ * @brief Stop the periodic advertising train
+ *
+ * @retval negative error code, 0 on success
+ */
+int PeriodicAdvert_Stop(void);
+
+/**
+ * @brief Add a sample to the rolling window. The oldest sample is dropped
+ * when the window is full. The periodic data is updated at most once per
+ * periodic advertising interval.
+ *
+ * @param type of event
+ * @param data of event
+ * @param epoch seconds when the data was acquired
+ * @param ms milliseconds when the data was acquired
+ */
+void PeriodicAdvert_AddSample(SensorEventType_t type, SensorEventData_t data,
+			      uint32_t epoch, uint16_t ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PERIODIC_ADVERT_H__ */
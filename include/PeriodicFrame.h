@@ -0,0 +1,81 @@
+/**
+ * @file PeriodicFrame.h
+ * @brief Rolling window of samples encoded for the periodic advertising train
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __PERIODIC_FRAME_H__
+#define __PERIODIC_FRAME_H__
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include <zephyr/types.h>
+#include <stddef.h>
+
+#include "lcz_sensor_event.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/* Global Constants, Macros and Type Definitions                              */
+/******************************************************************************/
+/* Frame layout, all fields are little endian.
+ *
+ * Header
+ *   companyId   2
+ *   protocolId  2
+ *   version     1
+ *   sequence    1  incremented each time the frame changes
+ *   count       1  number of samples that follow
+ *   epoch       4  seconds of the newest sample
+ *   ms          2  milliseconds of the newest sample
+ * Sample, oldest first
+ *   type        1  SensorEventType_t
+ *   age         2  tenths of a second before the newest sample, saturated
+ *   data        4  SensorEventData_t
+ */
+#define PERIODIC_FRAME_PROTOCOL_ID 0x0081
+#define PERIODIC_FRAME_VERSION 1
+#define PERIODIC_FRAME_HEADER_SIZE 13
+#define PERIODIC_FRAME_SAMPLE_SIZE 7
+#define PERIODIC_FRAME_AGE_UNIT_MS 100
+
+#define PERIODIC_FRAME_SIZE(n)                                                 \
+	(PERIODIC_FRAME_HEADER_SIZE + ((n) * PERIODIC_FRAME_SAMPLE_SIZE))
+
+typedef struct {
+	SensorEventType_t type;
+	SensorEventData_t data;
+	uint32_t epoch;
+	uint16_t ms;
+} PeriodicSample_t;
+
+/******************************************************************************/
+/* Global Function Prototypes                                                 */
+/******************************************************************************/
+/**
+ * @brief Encode samples into a frame
+ *
+ * @param buf destination
+ * @param size of destination
+ * @param samples to encode, oldest first
+ * @param count of samples
+ * @param sequence number of the frame
+ *
+ * @retval length of the frame, -EINVAL if there are no samples, -ENOMEM if
+ * it doesn't fit
+ */
+int PeriodicFrame_Encode(uint8_t *buf, size_t size,
+			 const PeriodicSample_t *samples, size_t count,
+			 uint8_t sequence);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PERIODIC_FRAME_H__ */
@@ -0,0 +1,78 @@
+/**
+ * @file SampleSchedule.h
+ * @brief Deadline arithmetic for the sensor readings that share a timer
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __SAMPLE_SCHEDULE_H__
+#define __SAMPLE_SCHEDULE_H__
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include <zephyr/types.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/* Global Function Prototypes                                                 */
+/******************************************************************************/
+/**
+ * @brief Get the deadline of the next reading of a group. Deadlines are on a
+ * fixed grid so the time taken by a reading doesn't accumulate.
+ *
+ * @param anchor deadline of the last reading, 0 to line the first reading up
+ * with a multiple of the period in real time
+ * @param now uptime in milliseconds
+ * @param epochMs real time in milliseconds, only used when anchor is 0
+ * @param period between readings in milliseconds, greater than 0
+ * @param missed set to the number of deadlines that had already passed
+ *
+ * @retval uptime of the deadline in milliseconds, always after now
+ */
+int64_t SampleSchedule_Deadline(int64_t anchor, int64_t now, int64_t epochMs,
+				int64_t period, uint32_t *missed);
+
+/**
+ * @brief Get the earliest deadline
+ *
+ * @param deadline of each group, 0 when the group isn't scheduled
+ * @param count of groups
+ *
+ * @retval the earliest deadline, 0 if no group is scheduled
+ */
+int64_t SampleSchedule_Earliest(const int64_t *deadline, size_t count);
+
+/**
+ * @brief Get the groups that are due. A wakeup takes everything that is due
+ * before the end of the window so that groups share it.
+ *
+ * @param deadline of each group, 0 when the group isn't scheduled
+ * @param count of groups, at most 32
+ * @param window end of the window in milliseconds of uptime
+ *
+ * @retval bit n is set when group n is due
+ */
+uint32_t SampleSchedule_Due(const int64_t *deadline, size_t count,
+			    int64_t window);
+
+/**
+ * @brief Scale a count to one hour
+ *
+ * @param count of events in the window
+ * @param elapsed length of the window in milliseconds
+ *
+ * @retval events per hour, 0 if no time has elapsed
+ */
+uint32_t SampleSchedule_PerHour(uint32_t count, int64_t elapsed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SAMPLE_SCHEDULE_H__ */
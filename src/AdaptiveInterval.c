@@ -0,0 +1,81 @@
+/**
+ * @file AdaptiveInterval.c
+ * @brief Sample intervals that follow how fast a group of signals changes
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr.h>
+
+#include "AdaptiveInterval.h"
+
+/**************************************************************************************************/
+/* Local Function Prototypes                                                                      */
+/**************************************************************************************************/
+static bool Enabled(const AdaptiveConfig_t *cfg);
+
+/**************************************************************************************************/
+/* Global Function Definitions                                                                    */
+/**************************************************************************************************/
+void AdaptiveInterval_Sample(AdaptiveState_t *state, size_t channel, int32_t value,
+			     int32_t threshold, int64_t now)
+{
+	int64_t elapsed;
+	int64_t slope;
+
+	if (channel >= ADAPTIVE_INTERVAL_CHANNELS) {
+		return;
+	}
+
+	if (state->valid & BIT(channel)) {
+		elapsed = now - state->timestamp[channel];
+		if (elapsed > 0) {
+			slope = (((int64_t)value - state->last[channel]) *
+				 (MSEC_PER_SEC * SEC_PER_MIN)) /
+				elapsed;
+			slope = (slope < 0) ? -slope : slope;
+			if (slope > threshold) {
+				state->fast = true;
+			}
+		}
+	}
+
+	state->valid |= BIT(channel);
+	state->last[channel] = value;
+	state->timestamp[channel] = now;
+}
+
+void AdaptiveInterval_Update(AdaptiveState_t *state, const AdaptiveConfig_t *cfg)
+{
+	if (!Enabled(cfg)) {
+		state->interval = 0;
+	} else if (state->fast || state->interval == 0) {
+		state->interval = cfg->min;
+	} else {
+		state->interval = MIN(cfg->max, state->interval * 2);
+	}
+	state->fast = false;
+}
+
+uint32_t AdaptiveInterval_Get(const AdaptiveState_t *state, const AdaptiveConfig_t *cfg,
+			      uint32_t fixed)
+{
+	/* A fixed interval of 0 disables sampling */
+	if (fixed == 0 || !Enabled(cfg) || state->interval == 0) {
+		return fixed;
+	}
+	return MAX(cfg->min, MIN(state->interval, cfg->max));
+}
+
+/**************************************************************************************************/
+/* Local Function Definitions                                                                     */
+/**************************************************************************************************/
+static bool Enabled(const AdaptiveConfig_t *cfg)
+{
+	return (cfg->min != 0 && cfg->max >= cfg->min);
+}
@@ -16,19 +16,26 @@ LOG_MODULE_REGISTER(AdcBt6, CONFIG_ADC_BT6_LOG_LEVEL);
 /******************************************************************************/
 #include <zephyr.h>
 #include <drivers/adc.h>
+#ifdef CONFIG_ADC_NRFX_SAADC
 #include <hal/nrf_saadc.h>
+#endif
 #include <drivers/i2c.h>
 #include <string.h>
 #include <stdio.h>
 #include <math.h>
 #include <locking_defs.h>
 #include <locking.h>
+#ifdef CONFIG_ADC_BT6_AC_BURST_CMSIS_DSP
+#include <arm_math.h>
+#endif
 
+#include "FrameworkIncludes.h"
 #include "BspSupport.h"
 #include "laird_utility_macros.h"
 #include "file_system_utilities.h"
 #include "lcz_param_file.h"
 #include "attr.h"
+#include "attr_custom_validator.h"
 #include "AnalogInput.h"
 #include "AdcBt6.h"
 #include "SensorTask.h"
@@ -44,7 +51,12 @@ LOG_MODULE_REGISTER(AdcBt6, CONFIG_ADC_BT6_LOG_LEVEL);
 #define ADC_GAIN_THERMISTOR       ADC_GAIN_1_4
 #define ADC_REFERENCE_DEFAULT     ADC_REF_INTERNAL
 #define ADC_REFERENCE_THERMISTOR  ADC_REF_VDD_1_4
+#ifdef CONFIG_ADC_EMUL
+/* The emulated ADC only accepts the default */
+#define ADC_ACQUISITION_TIME      ADC_ACQ_TIME_DEFAULT
+#else
 #define ADC_ACQUISITION_TIME      ADC_ACQ_TIME(ADC_ACQ_TIME_MICROSECONDS, 10)
+#endif
 /* clang-format on */
 
 /* clang-format off */
@@ -72,6 +84,21 @@ const uint32_t I2C_CFG = I2C_SPEED_SET(I2C_SPEED_STANDARD) | I2C_MODE_CONTROLLER
 #define ULTRASONIC_DELAY_MS 400 /* 2 measurements */
 #define PRESSURE_DELAY_MS 100
 
+/* Settled measurements wait for the ADC lock on their own thread so that
+ * the system work queue is never blocked by a synchronous measurement.
+ */
+#ifndef ADC_BT6_SETTLE_PRIORITY
+#define ADC_BT6_SETTLE_PRIORITY K_PRIO_PREEMPT(1)
+#endif
+
+#ifndef ADC_BT6_SETTLE_STACK_DEPTH
+#define ADC_BT6_SETTLE_STACK_DEPTH 2048
+#endif
+
+/* Sending the results is retried while the buffer pool is exhausted */
+#define SETTLE_SEND_RETRY_MS 10
+#define SETTLE_SEND_ATTEMPTS 100
+
 /* Constants for converting ADC counts to voltage */
 #define ANALOG_VOLTAGE_CONVERSION_FACTOR 281.2
 #define ANALOG_CURRENT_CONVERSION_FACTOR 71.875
@@ -80,12 +107,41 @@ const uint32_t I2C_CFG = I2C_SPEED_SET(I2C_SPEED_STANDARD) | I2C_MODE_CONTROLLER
 #define ACCURRENT_150AMP_CONVERSION_FACTOR (150.0 / 5.0)
 #define ACCURRENT_500AMP_CONVERSION_FACTOR (500.0 / 5.0)
 
+/* Integer forms of the conversion factors. 1000 / 281.2 = 2500 / 703 and
+ * 1000 / 71.875 = 320 / 23.
+ */
+#define ANALOG_VOLTAGE_MILLI_NUM 2500
+#define ANALOG_VOLTAGE_MILLI_DEN 703
+#define ANALOG_CURRENT_MILLI_NUM 320
+#define ANALOG_CURRENT_MILLI_DEN 23
+#define ULTRASONIC_MILLI_FACTOR (10240 / 5)
+#define PRESSURE_MILLI_FACTOR 75
+#define PRESSURE_MILLI_OFFSET 37500
+#define ACCURRENT_20AMP_MILLI_FACTOR (20 / 5)
+#define ACCURRENT_150AMP_MILLI_FACTOR (150 / 5)
+#define ACCURRENT_500AMP_MILLI_FACTOR (500 / 5)
+
 /* Constants for Steinhart-Hart Equation for the Focus thermistor */
 #define THERMISTOR_S_H_A 1.132e-3
 #define THERMISTOR_S_H_B 2.338e-4
 #define THERMISTOR_S_H_C 8.780e-8
 #define THERMISTOR_S_H_OFFSET 273.15
 
+/* Thermistor temperatures are interpolated from a table indexed by raw ADC
+ * counts. The calibration (ge, oe), Steinhart-Hart coefficients and offset
+ * are folded into the table when it is built.
+ */
+#define THERM_TABLE_SHIFT CONFIG_ADC_BT6_THERMISTOR_TABLE_SHIFT
+#define THERM_TABLE_STEP BIT(THERM_TABLE_SHIFT)
+#define THERM_TABLE_SIZE ((BIT(ADC_RESOLUTION) >> THERM_TABLE_SHIFT) + 1)
+#define THERM_TABLE_SCALE 100
+#define THERM_TABLE_MAX_RAW ((1 << ADC_RESOLUTION) - 1)
+/* Results are limited to the rated range of the thermistor. The entries
+ * themselves aren't, so that the interpolation next to a limit is exact.
+ */
+#define THERM_TABLE_MIN_CENTI (-40 * THERM_TABLE_SCALE)
+#define THERM_TABLE_MAX_CENTI (125 * THERM_TABLE_SCALE)
+
 /* Used to convert incoming simulated voltage values to millivolts */
 #define ADC_BT6_VOLTS_TO_MILLIVOLTS 1000.0f
 
@@ -105,17 +161,44 @@ struct expander {
 };
 BUILD_ASSERT(sizeof(struct expander) == sizeof(uint8_t), "Union error");
 
+typedef struct ThermTables {
+	/* Hundredths of a degree Celsius every THERM_TABLE_STEP raw counts */
+	int16_t centi[NUMBER_OF_ANALOG_INPUTS][THERM_TABLE_SIZE];
+} ThermTables_t;
+
+/* Pressure and ultrasonic measurements waiting for their sensors to settle */
+typedef struct AdcSettle {
+	struct k_work_delayable work;
+	atomic_t busy;
+	AdcBt6ScanPlan_t plan;
+	FwkId_t rxId;
+	/* Results kept until they can be sent */
+	bool scanned;
+	int status;
+	int16_t raw[NUMBER_OF_ANALOG_INPUTS];
+	int64_t timestamp;
+	uint32_t sendAttempts;
+} AdcSettle_t;
+
 typedef struct AdcObj {
 	struct adc_channel_cfg channel_cfg;
 	const struct device *dev;
 	const struct device *i2c;
 	struct expander expander;
+	/* Last value written to the expander output register */
+	struct expander expanderWritten;
+	bool expanderSynced;
 	bool calibrate;
 	bool fiveEnabled;
 	bool bPlusEnabled;
+	/* The 5V and B+ rails are reference counted */
+	struct k_mutex railMutex;
+	uint8_t railUsers;
+	AdcSettle_t settle;
 	int32_t ref;
 	float ge;
 	float oe;
+	AdcBt6Stats_t stats;
 } AdcObj_t;
 
 #define CONFIG_ATTR_FLOAT_MAX_STR_SIZE 20
@@ -132,20 +215,58 @@ typedef struct AdcObj {
 /******************************************************************************/
 static AdcObj_t adcObj;
 static struct adc_channel_cfg *const pcfg = &adcObj.channel_cfg;
+/* The tables are rebuilt into the set that isn't published and then swapped
+ * in. The generation changes before a set is written so that a conversion
+ * that was reading it retries.
+ */
+static ThermTables_t thermTables[2];
+static atomic_ptr_t thermTablesActive;
+static atomic_t thermGeneration;
+static K_MUTEX_DEFINE(thermBuildMutex);
+
+K_THREAD_STACK_DEFINE(adcSettleStack, ADC_BT6_SETTLE_STACK_DEPTH);
+static struct k_work_q adcSettleQueue;
+
+#ifdef CONFIG_ADC_BT6_AC_CURRENT_BURST
+static int16_t burstBuffer[CONFIG_ADC_BT6_AC_BURST_SAMPLES];
+#endif
 
 /******************************************************************************/
 /* Local Function Prototypes                                                  */
 /******************************************************************************/
 static int SampleChannel(int16_t *raw, AnalogChannel_t channel);
+#ifdef CONFIG_ADC_BT6_AC_CURRENT_BURST
+static int SampleBurst(int16_t *rms, AnalogChannel_t channel);
+static int16_t Rms(int16_t *samples, size_t count);
+#endif
 static int ConfigureChannel(AnalogChannel_t channel);
 
 static AnalogChannel_t GetChannel(AdcMeasurementType_t type);
 static int InitExpander(void);
 static int ConfigMux(MuxInput_t input);
-static void UltrasonicOrPressurePowerAndDelayHandler(AdcMeasurementType_t type);
-static void UltrasonicOrPressureDisablePower(AdcMeasurementType_t type);
+static int SyncExpander(bool *written);
+static int MeasureLocked(int16_t *raw, MuxInput_t input,
+			 AdcMeasurementType_t type, AdcPwrSequence_t power,
+			 bool burst);
+static int BringUpLocked(MuxInput_t input, AdcMeasurementType_t type,
+			 AdcPwrSequence_t power);
+static int MeasureAfterSettle(int16_t *raw, MuxInput_t input,
+			      AdcMeasurementType_t type,
+			      AdcPwrSequence_t power);
+static bool IsThermistorCircuit(AdcMeasurementType_t type);
+static bool NeedsRails(AdcMeasurementType_t type);
+static int ValidatePlan(const AdcBt6ScanPlan_t *plan, bool rails);
+static int ScanLocked(const AdcBt6ScanPlan_t *plan, int16_t *results);
+static uint32_t SettleTimeMs(AdcMeasurementType_t type);
+static int FiveVoltEnable(void);
+static int FiveVoltDisable(void);
+static int BplusEnable(void);
+static int BplusDisable(void);
+static void SettleWorkHandler(struct k_work *work);
 static bool ValidInputForCurrentMeasurement(MuxInput_t input);
 static float Steinhart_Hart(float calibrated, float a, float b, float c);
+static void BuildThermistorTable(int16_t *centi, size_t channel);
+static int32_t ThermistorLookup(size_t channel, int32_t raw);
 static bool ADCChannelIsSimulated(AnalogChannel_t channel,
 				  int16_t *simulated_value);
 static bool VoltageIsSimulated(size_t channel, float *simulated_value);
@@ -154,6 +275,9 @@ static bool PressureIsSimulated(float *simulated_value);
 static bool CurrentIsSimulated(size_t channel, float *simulated_value);
 static bool VrefIsSimulated(float *simulated_value);
 static bool TemperatureIsSimulated(size_t channel, float *simulated_value);
+static int32_t ScaleVoltageMilli(size_t channel, int32_t raw, int32_t factor);
+static int32_t DivRoundClosest(int64_t n, int32_t d);
+static int32_t ToMilli(float value);
 static bool power_volt_is_simulated(float *simulated_value);
 
 /******************************************************************************/
@@ -163,8 +287,14 @@ int AdcBt6_Init(void)
 {
 	int status = 0;
 	ssize_t readReturn;
-	adcObj.calibrate = true;
+	adcObj.calibrate = IS_ENABLED(CONFIG_ADC_NRFX_SAADC);
 	adcObj.dev = device_get_binding(ADC_DEVICE_NAME);
+	k_mutex_init(&adcObj.railMutex);
+	k_work_init_delayable(&adcObj.settle.work, SettleWorkHandler);
+	k_work_queue_start(&adcSettleQueue, adcSettleStack,
+			   K_THREAD_STACK_SIZEOF(adcSettleStack),
+			   ADC_BT6_SETTLE_PRIORITY, NULL);
+	k_thread_name_set(&adcSettleQueue.thread, "adc_settle");
 
 	if (adcObj.dev == NULL) {
 		__ASSERT(false, "Failed to get device binding");
@@ -196,6 +326,8 @@ int AdcBt6_Init(void)
 		attr_copy_float(&adcObj.oe, ATTR_ID_oe);
 	}
 
+	AdcBt6_RebuildThermistorTables();
+
 	return status;
 }
 
@@ -234,42 +366,128 @@ int AdcBt6_Measure(int16_t *raw, MuxInput_t input, AdcMeasurementType_t type,
 
 	/** @ref Hardware Sensor Measurement Procedures.docx */
 
-	if (type < NUMBER_OF_ADC_TYPES) {
+	if (type >= NUMBER_OF_ADC_TYPES) {
+		LOG_ERR("Invalid measurement type");
+	} else if (NeedsRails(type) && power != ADC_PWR_SEQ_BYPASS) {
+		rc = MeasureAfterSettle(raw, input, type, power);
+	} else {
 		locking_take(LOCKING_ID_adc, K_FOREVER);
+		rc = MeasureLocked(raw, input, type, power, false);
+		locking_give(LOCKING_ID_adc);
+	}
+	return rc;
+}
 
-		if (power == ADC_PWR_SEQ_SINGLE || power == ADC_PWR_SEQ_START) {
-			AdcBt6_ConfigPower(type);
-		}
+int AdcBt6_MeasureSettled(const AdcBt6ScanPlan_t *plan, FwkId_t rxId)
+{
+	uint32_t settleMs = 0;
+	MuxInput_t first;
+	size_t i;
+	int rc;
 
-		if (type == ADC_TYPE_VREF) {
-			rc = 0;
-		} else {
-			rc = ConfigMux(input);
-		}
+	if (adcObj.dev == NULL) {
+		return -EIO;
+	}
 
-		if (power != ADC_PWR_SEQ_BYPASS) {
-			UltrasonicOrPressurePowerAndDelayHandler(type);
-		}
+	rc = ValidatePlan(plan, true);
+	if (rc == 0) {
+		return -EINVAL;
+	} else if (rc < 0) {
+		return rc;
+	}
 
-		if (rc == 0) {
-			rc = SampleChannel(raw, GetChannel(type));
-		}
+	/* Cleared by the work handler once the results are taken */
+	if (!atomic_cas(&adcObj.settle.busy, 0, 1)) {
+		return -EBUSY;
+	}
 
-		if (power == ADC_PWR_SEQ_SINGLE || power == ADC_PWR_SEQ_END) {
-			AdcBt6_DisablePower();
+	/* The rails are brought up once and every sensor settles in parallel */
+	for (i = 0; i < NUMBER_OF_ANALOG_INPUTS; i++) {
+		if (plan->channel_mask & BIT(i)) {
+			settleMs = MAX(settleMs, SettleTimeMs(plan->type[i]));
 		}
+	}
+
+	adcObj.settle.plan = *plan;
+	adcObj.settle.plan.channel_mask = (uint8_t)rc;
+	adcObj.settle.rxId = rxId;
+	adcObj.settle.scanned = false;
 
-		if (power != ADC_PWR_SEQ_BYPASS) {
-			UltrasonicOrPressureDisablePower(type);
+	/* The scan powers the circuit and selects each input again after the
+	 * sensors have settled.
+	 */
+	first = find_lsb_set(rc) - 1;
+	locking_take(LOCKING_ID_adc, K_FOREVER);
+	(void)BringUpLocked(first, plan->type[first], ADC_PWR_SEQ_START);
+	locking_give(LOCKING_ID_adc);
+	AdcBt6_RailsAcquire();
+	k_work_schedule_for_queue(&adcSettleQueue, &adcObj.settle.work,
+				  K_MSEC(settleMs));
+
+	return 0;
+}
+
+int AdcBt6_MeasureRms(int16_t *rms, MuxInput_t input, AdcMeasurementType_t type,
+		      AdcPwrSequence_t power)
+{
+#ifdef CONFIG_ADC_BT6_AC_CURRENT_BURST
+	int rc = -EINVAL;
+	if (adcObj.dev == NULL) {
+		rc = -EIO;
+		return rc;
+	}
+
+	if (type == ADC_TYPE_CURRENT) {
+		if (!ValidInputForCurrentMeasurement(input)) {
+			LOG_ERR("Invalid input for current measurement");
+			return rc;
 		}
+	}
 
+	if (type == ADC_TYPE_VOLTAGE || type == ADC_TYPE_CURRENT) {
+		locking_take(LOCKING_ID_adc, K_FOREVER);
+		rc = MeasureLocked(rms, input, type, power, true);
 		locking_give(LOCKING_ID_adc);
 	} else {
-		LOG_ERR("Invalid measurement type");
+		LOG_ERR("Invalid burst measurement type");
+	}
+	return rc;
+#else
+	return AdcBt6_Measure(rms, input, type, power);
+#endif
+}
+
+int AdcBt6_MeasureScan(const AdcBt6ScanPlan_t *plan, int16_t *results)
+{
+	int rc;
+
+	if (adcObj.dev == NULL) {
+		return -EIO;
 	}
+
+	if (results == NULL) {
+		return -EINVAL;
+	}
+
+	rc = ValidatePlan(plan, false);
+	if (rc <= 0) {
+		return rc;
+	}
+
+	locking_take(LOCKING_ID_adc, K_FOREVER);
+	rc = ScanLocked(plan, results);
+	locking_give(LOCKING_ID_adc);
+
 	return rc;
 }
 
+void AdcBt6_GetStats(AdcBt6Stats_t *stats)
+{
+	locking_take(LOCKING_ID_adc, K_FOREVER);
+	*stats = adcObj.stats;
+	locking_give(LOCKING_ID_adc);
+}
+
 int AdcBt6_CalibrateThermistor(float c1, float c2, float *ge, float *oe)
 {
 	int rc = -EINVAL;
@@ -317,6 +535,7 @@ int AdcBt6_CalibrateThermistor(float c1, float c2, float *ge, float *oe)
 		lcz_param_file_write("oe", &adcObj.oe, sizeof(adcObj.oe));
 		attr_set_float(ATTR_ID_ge, adcObj.ge);
 		attr_set_float(ATTR_ID_oe, adcObj.oe);
+		AdcBt6_RebuildThermistorTables();
 	} else {
 		LOG_ERR("Thermistor calibration error");
 	}
@@ -337,58 +556,40 @@ const char *AdcBt6_GetTypeString(AdcMeasurementType_t type)
 	}
 }
 
-int AdcBt6_FiveVoltEnable(void)
+int AdcBt6_RailsAcquire(void)
 {
-	int rc = -EINVAL;
-	if (!adcObj.bPlusEnabled) {
-		rc = BSP_PinSet(FIVE_VOLT_ENABLE_PIN, 1);
-	} else {
-		LOG_ERR("Enable 5V before enabling b+");
-	}
-
-	if (rc == 0) {
-		k_sleep(K_MSEC(V_5_ENABLE_DELAY_MS));
-		adcObj.fiveEnabled = true;
-	}
-	return rc;
-}
-
-int AdcBt6_FiveVoltDisable(void)
-{
-	int rc = -EINVAL;
-	if (!adcObj.bPlusEnabled) {
-		rc = BSP_PinSet(FIVE_VOLT_ENABLE_PIN, 0);
-	} else {
-		LOG_ERR("Disable b+ before disabling 5V");
-	}
-	if (rc == 0) {
-		adcObj.fiveEnabled = false;
-	}
-	return rc;
-}
+	int rc = 0;
 
-int AdcBt6_BplusEnable(void)
-{
-	int rc = BSP_PinSet(BATT_OUT_ENABLE_PIN, 1);
-	if (rc == 0) {
-		k_sleep(K_MSEC(V_5_ENABLE_DELAY_MS));
-		adcObj.bPlusEnabled = true;
+	k_mutex_lock(&adcObj.railMutex, K_FOREVER);
+	if (adcObj.railUsers == 0) {
+		rc = FiveVoltEnable();
+		if (rc == 0) {
+			rc = BplusEnable();
+		}
 	}
+	adcObj.railUsers += 1;
+	k_mutex_unlock(&adcObj.railMutex);
 	return rc;
 }
 
-int AdcBt6_BplusDisable(void)
+int AdcBt6_RailsRelease(void)
 {
-	int rc = -EINVAL;
-	if (adcObj.fiveEnabled) {
-		rc = BSP_PinSet(BATT_OUT_ENABLE_PIN, 0);
-	} else {
-		LOG_ERR("Disable 5V after disabling b+");
-	}
+	int rc = 0;
 
-	if (rc == 0) {
-		adcObj.bPlusEnabled = false;
+	k_mutex_lock(&adcObj.railMutex, K_FOREVER);
+	if (adcObj.railUsers > 0) {
+		adcObj.railUsers -= 1;
+		if (adcObj.railUsers == 0) {
+			/* B+ goes off before 5V */
+			if (adcObj.bPlusEnabled) {
+				rc = BplusDisable();
+			}
+			if (adcObj.fiveEnabled) {
+				rc = FiveVoltDisable();
+			}
+		}
 	}
+	k_mutex_unlock(&adcObj.railMutex);
 	return rc;
 }
 
@@ -496,24 +697,111 @@ float AdcBt6_ApplyThermistorCalibration(int32_t raw)
 float AdcBt6_ConvertThermToTemperature(size_t channel, int32_t raw)
 {
 	float temperature;
-	float calibrated;
 
 	if (!TemperatureIsSimulated(channel,&temperature)) {
-		calibrated = AdcBt6_ApplyThermistorCalibration(raw);
-		uint16_t coefficientA = ATTR_ID_therm_1_coefficient_a + channel;
-		uint16_t coefficientB = ATTR_ID_therm_1_coefficient_b + channel;
-		uint16_t coefficientC = ATTR_ID_therm_1_coefficient_c + channel;
-		temperature = Steinhart_Hart(
-			       calibrated,
-			       attr_get_float(coefficientA, THERMISTOR_S_H_A),
-			       attr_get_float(coefficientB, THERMISTOR_S_H_B),
-			       attr_get_float(coefficientC, THERMISTOR_S_H_C)) -
-		       attr_get_float(ATTR_ID_sh_offset,
-					     THERMISTOR_S_H_OFFSET);
+		temperature = (float)ThermistorLookup(channel, raw) /
+			      THERM_TABLE_SCALE;
 	}
 	return(temperature);
 }
 
+int32_t AdcBt6_ConvertVoltageMilli(size_t channel, int32_t raw)
+{
+	return ScaleVoltageMilli(channel, raw, 1);
+}
+
+int32_t AdcBt6_ConvertUltrasonicMilli(size_t channel, int32_t raw)
+{
+	float simulated;
+
+	if (UltrasonicIsSimulated(&simulated)) {
+		return ToMilli(simulated);
+	}
+	return ScaleVoltageMilli(channel, raw, ULTRASONIC_MILLI_FACTOR);
+}
+
+int32_t AdcBt6_ConvertPressureMilli(size_t channel, int32_t raw)
+{
+	float simulated;
+
+	if (PressureIsSimulated(&simulated)) {
+		return ToMilli(simulated);
+	}
+	return ScaleVoltageMilli(channel, raw, PRESSURE_MILLI_FACTOR) -
+	       PRESSURE_MILLI_OFFSET;
+}
+
+int32_t AdcBt6_ConvertCurrentMilli(size_t channel, int32_t raw)
+{
+	float simulated;
+
+	if (CurrentIsSimulated(channel, &simulated)) {
+		return ToMilli(simulated);
+	}
+	return DivRoundClosest((int64_t)raw * ANALOG_CURRENT_MILLI_NUM,
+			       ANALOG_CURRENT_MILLI_DEN);
+}
+
+int32_t AdcBt6_ConvertACCurrent20Milli(size_t channel, int32_t raw)
+{
+	float simulated;
+
+	if (CurrentIsSimulated(channel, &simulated)) {
+		return ToMilli(simulated);
+	}
+	return ScaleVoltageMilli(channel, raw, ACCURRENT_20AMP_MILLI_FACTOR);
+}
+
+int32_t AdcBt6_ConvertACCurrent150Milli(size_t channel, int32_t raw)
+{
+	float simulated;
+
+	if (CurrentIsSimulated(channel, &simulated)) {
+		return ToMilli(simulated);
+	}
+	return ScaleVoltageMilli(channel, raw, ACCURRENT_150AMP_MILLI_FACTOR);
+}
+
+int32_t AdcBt6_ConvertACCurrent500Milli(size_t channel, int32_t raw)
+{
+	float simulated;
+
+	if (CurrentIsSimulated(channel, &simulated)) {
+		return ToMilli(simulated);
+	}
+	return ScaleVoltageMilli(channel, raw, ACCURRENT_500AMP_MILLI_FACTOR);
+}
+
+int32_t AdcBt6_ConvertThermToTemperatureMilli(size_t channel, int32_t raw)
+{
+	float simulated;
+
+	if (TemperatureIsSimulated(channel, &simulated)) {
+		return ToMilli(simulated);
+	}
+	return (int32_t)ThermistorLookup(channel, raw) *
+	       (ADC_BT6_MILLI / THERM_TABLE_SCALE);
+}
+
+void AdcBt6_RebuildThermistorTables(void)
+{
+	ThermTables_t *next;
+	size_t i;
+
+	k_mutex_lock(&thermBuildMutex, K_FOREVER);
+	next = (atomic_ptr_get(&thermTablesActive) == &thermTables[0]) ?
+		       &thermTables[1] :
+		       &thermTables[0];
+	atomic_inc(&thermGeneration);
+	for (i = 0; i < NUMBER_OF_ANALOG_INPUTS; i++) {
+		BuildThermistorTable(next->centi[i], i);
+	}
+	atomic_ptr_set(&thermTablesActive, next);
+	k_mutex_unlock(&thermBuildMutex);
+
+	LOG_DBG("Thermistor tables built");
+}
+
 void AdcBt6_ConfigPower(AdcMeasurementType_t type)
 {
 	/* Thermistor enable is active low. */
@@ -543,12 +831,15 @@ void AdcBt6_ConfigPower(AdcMeasurementType_t type)
 	}
 
 	k_busy_wait(POWER_ENABLE_DELAY_US);
+	adcObj.stats.transitions += 1;
+	adcObj.stats.busy_wait_us += POWER_ENABLE_DELAY_US;
 }
 
 void AdcBt6_DisablePower(void)
 {
 	BSP_PinSet(ANALOG_ENABLE_PIN, 0);
 	BSP_PinSet(THERM_ENABLE_PIN, 1);
+	adcObj.stats.transitions += 1;
 }
 
 /* The AINx_SEL lines need to be maintained at all times.
@@ -564,23 +855,22 @@ int AdcBt6_ConfigAinSelects(void)
 		return rc;
 	}
 
-	adcObj.expander.bits.ain_sel = 0;
+	uint8_t ain_sel = 0;
 	size_t i;
 	enum analog_input_1_type config;
 	for (i = 0; i < ANALOG_INPUT_NUMBER_OF_CHANNELS; i++) {
 		config = attr_get_uint32(ATTR_ID_analog_input_1_type + i, 0);
 		if (config == ANALOG_INPUT_1_TYPE_CURRENT_4MA_TO_20MA) {
-			adcObj.expander.bits.ain_sel |= (1 << i);
+			ain_sel |= (1 << i);
 		}
 	}
 
 	/* To measure current the correspoding output must be set to 1 */
-	uint8_t cmd[] = { TCA9538_REG_OUTPUT, adcObj.expander.byte };
-	if (i2c_write(adcObj.i2c, cmd, sizeof(cmd), EXPANDER_ADDRESS) < 0) {
-		LOG_ERR("I2C Failure");
-	} else {
-		rc = 0;
-	}
+	locking_take(LOCKING_ID_adc, K_FOREVER);
+	adcObj.expander.bits.ain_sel = ain_sel;
+	rc = SyncExpander(NULL);
+	locking_give(LOCKING_ID_adc);
+
 	return rc;
 }
 
@@ -637,6 +927,105 @@ static int SampleChannel(int16_t *raw, AnalogChannel_t channel)
 	return rc;
 }
 
+#ifdef CONFIG_ADC_BT6_AC_CURRENT_BURST
+/* Capture CONFIG_ADC_BT6_AC_BURST_SAMPLES samples at a fixed interval and
+ * reduce them to a single RMS value in ADC counts. Oversampling isn't used
+ * because it would stretch each sample across the waveform.
+ */
+static int SampleBurst(int16_t *rms, AnalogChannel_t channel)
+{
+	int rc = -EIO;
+	const struct adc_sequence_options options = {
+		.interval_us = CONFIG_ADC_BT6_AC_BURST_INTERVAL_US,
+		.callback = NULL,
+		.user_data = NULL,
+		.extra_samplings = CONFIG_ADC_BT6_AC_BURST_SAMPLES - 1
+	};
+	const struct adc_sequence sequence = {
+		.options = &options,
+		.channels = BIT(channel),
+		.buffer = burstBuffer,
+		.buffer_size = sizeof(burstBuffer),
+		.resolution = ADC_RESOLUTION,
+		.oversampling = 0,
+		.calibrate = adcObj.calibrate
+	};
+
+	if (adcObj.dev) {
+		rc = ConfigureChannel(channel);
+		if (rc == 0) {
+			if (!ADCChannelIsSimulated(channel, rms)) {
+				rc = adc_read(adcObj.dev, &sequence);
+				if (rc == 0) {
+					*rms = Rms(burstBuffer,
+						   ARRAY_SIZE(burstBuffer));
+				}
+			}
+		}
+		if (rc < 0) {
+			LOG_ERR("Unable to sample ADC burst");
+		} else {
+			adcObj.calibrate = false;
+		}
+	}
+	return rc;
+}
+
+/* The RMS of the AC part of the burst. The sensor output sits on a DC
+ * offset, so the mean of the burst is removed before squaring. Samples aren't
+ * clamped because that would clip the negative half of a signal near 0.
+ */
+static int16_t Rms(int16_t *samples, size_t count)
+{
+#ifdef CONFIG_ADC_BT6_AC_BURST_CMSIS_DSP
+	q15_t mean;
+	q15_t result;
+
+	arm_mean_q15(samples, count, &mean);
+	arm_offset_q15(samples, -mean, samples, count);
+	/* Scale the counts up to the q15 range so the mean square keeps its
+	 * resolution inside arm_rms_q15. The differences from the mean fit in
+	 * ADC_RESOLUTION bits plus the sign.
+	 */
+	arm_shift_q15(samples, 15 - ADC_RESOLUTION, samples, count);
+	arm_rms_q15(samples, count, &result);
+	return (result >> (15 - ADC_RESOLUTION));
+#else
+	size_t i;
+	int64_t sum = 0;
+	int64_t squares = 0;
+	uint32_t variance;
+	uint32_t root = 0;
+	uint32_t bit = BIT(30);
+
+	for (i = 0; i < count; i++) {
+		sum += samples[i];
+		squares += (int32_t)samples[i] * samples[i];
+	}
+	/* n * sum(x^2) - sum(x)^2 is n^2 times the variance. The mean is never
+	 * rounded.
+	 */
+	variance = (uint32_t)((((int64_t)count * squares) - (sum * sum)) /
+			      ((int64_t)count * count));
+
+	/* Integer square root */
+	while (bit > variance) {
+		bit >>= 2;
+	}
+	while (bit != 0) {
+		if (variance >= root + bit) {
+			variance -= root + bit;
+			root = (root >> 1) + bit;
+		} else {
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	return (int16_t)root;
+#endif
+}
+#endif /* CONFIG_ADC_BT6_AC_CURRENT_BURST */
+
 static int ConfigureChannel(AnalogChannel_t channel)
 {
 	if (channel == pcfg->channel_id) {
@@ -644,7 +1033,9 @@ static int ConfigureChannel(AnalogChannel_t channel)
 	}
 
 	pcfg->channel_id = channel;
+#ifdef CONFIG_ADC_CONFIGURABLE_INPUTS
 	pcfg->input_positive = channel;
+#endif
 
 	switch (channel) {
 	case ANALOG_SENSOR_1_CH:
@@ -666,7 +1057,9 @@ static int ConfigureChannel(AnalogChannel_t channel)
 	default:
 		pcfg->gain = ADC_GAIN_DEFAULT;
 		pcfg->reference = ADC_REFERENCE_DEFAULT;
+#ifdef CONFIG_ADC_NRFX_SAADC
 		pcfg->input_positive = NRF_SAADC_INPUT_VDD;
+#endif
 		break;
 	}
 
@@ -703,6 +1096,8 @@ static int InitExpander(void)
 static int ConfigMux(MuxInput_t input)
 {
 	int rc = -EIO;
+	bool written = false;
+
 	if (adcObj.i2c == NULL) {
 		return rc;
 	}
@@ -712,42 +1107,336 @@ static int ConfigMux(MuxInput_t input)
 		return rc;
 	}
 
-	if (adcObj.expander.bits.mux != input) {
-		adcObj.expander.bits.mux = input;
-		uint8_t cmd[] = { TCA9538_REG_OUTPUT, adcObj.expander.byte };
-		rc = i2c_write(adcObj.i2c, cmd, sizeof(cmd), EXPANDER_ADDRESS);
-		if (rc < 0) {
-			LOG_ERR("I2C Failure");
+	adcObj.expander.bits.mux = input;
+	rc = SyncExpander(&written);
+	if (rc == 0 && written) {
+		k_busy_wait(MUX_SWITCH_DELAY_US);
+		adcObj.stats.busy_wait_us += MUX_SWITCH_DELAY_US;
+	}
+	return rc;
+}
+
+/* The output register is shadowed so that mux and AINx_SEL changes share a
+ * single I2C write, and a write that wouldn't change the outputs is skipped.
+ * A failed write leaves the expander out of sync so the next call retries.
+ */
+static int SyncExpander(bool *written)
+{
+	int rc = 0;
+
+	if (written != NULL) {
+		*written = false;
+	}
+
+	if (adcObj.expanderSynced &&
+	    adcObj.expanderWritten.byte == adcObj.expander.byte) {
+		return rc;
+	}
+
+	uint8_t cmd[] = { TCA9538_REG_OUTPUT, adcObj.expander.byte };
+	rc = i2c_write(adcObj.i2c, cmd, sizeof(cmd), EXPANDER_ADDRESS);
+	adcObj.stats.expander_writes += 1;
+	if (rc < 0) {
+		LOG_ERR("I2C Failure");
+		adcObj.expanderSynced = false;
+	} else {
+		adcObj.expanderWritten = adcObj.expander;
+		adcObj.expanderSynced = true;
+		if (written != NULL) {
+			*written = true;
+		}
+	}
+	return rc;
+}
+
+/* The caller must hold the ADC lock */
+static int MeasureLocked(int16_t *raw, MuxInput_t input,
+			 AdcMeasurementType_t type, AdcPwrSequence_t power,
+			 bool burst)
+{
+	int rc = BringUpLocked(input, type, power);
+
+	if (rc == 0) {
+#ifdef CONFIG_ADC_BT6_AC_CURRENT_BURST
+		if (burst) {
+			rc = SampleBurst(raw, GetChannel(type));
 		} else {
-			k_busy_wait(MUX_SWITCH_DELAY_US);
+			rc = SampleChannel(raw, GetChannel(type));
+		}
+#else
+		ARG_UNUSED(burst);
+		rc = SampleChannel(raw, GetChannel(type));
+#endif
+	}
+
+	if (power == ADC_PWR_SEQ_SINGLE || power == ADC_PWR_SEQ_END) {
+		AdcBt6_DisablePower();
+	}
+
+	return rc;
+}
+
+/* Power the circuit and select the input. The caller must hold the ADC lock.
+ * Pressure and ultrasonic rails are enabled after this returns.
+ */
+static int BringUpLocked(MuxInput_t input, AdcMeasurementType_t type,
+			 AdcPwrSequence_t power)
+{
+	if (power == ADC_PWR_SEQ_SINGLE || power == ADC_PWR_SEQ_START) {
+		AdcBt6_ConfigPower(type);
+	}
+
+	if (type == ADC_TYPE_VREF) {
+		return 0;
+	}
+	return ConfigMux(input);
+}
+
+/* Bring up the circuit, mux and rails in that order, then let the sensor
+ * settle without the ADC lock so that other measurements aren't held up.
+ * The power and mux are asserted again for the conversion because another
+ * measurement may have used the circuit while this one was settling.
+ */
+static int MeasureAfterSettle(int16_t *raw, MuxInput_t input,
+			      AdcMeasurementType_t type,
+			      AdcPwrSequence_t power)
+{
+	int rc;
+
+	locking_take(LOCKING_ID_adc, K_FOREVER);
+	rc = BringUpLocked(input, type, power);
+	locking_give(LOCKING_ID_adc);
+
+	AdcBt6_RailsAcquire();
+	if (rc == 0) {
+		k_sleep(K_MSEC(SettleTimeMs(type)));
+	}
+
+	locking_take(LOCKING_ID_adc, K_FOREVER);
+	if (rc == 0) {
+		rc = MeasureLocked(raw, input, type, power, false);
+	} else if (power == ADC_PWR_SEQ_SINGLE || power == ADC_PWR_SEQ_END) {
+		AdcBt6_DisablePower();
+	}
+	locking_give(LOCKING_ID_adc);
+
+	AdcBt6_RailsRelease();
+	return rc;
+}
+
+/* Thermistor and analog measurements use different circuits */
+static bool IsThermistorCircuit(AdcMeasurementType_t type)
+{
+	return (type == ADC_TYPE_THERMISTOR);
+}
+
+/* Returns the mask of inputs in the plan, or a negative error code.
+ * Inputs that need the 5V and B+ rails are only allowed when rails is set.
+ */
+static int ValidatePlan(const AdcBt6ScanPlan_t *plan, bool rails)
+{
+	uint8_t mask;
+	bool therm;
+	size_t i;
+
+	if (plan == NULL) {
+		return -EINVAL;
+	}
+
+	mask = plan->channel_mask & (BIT(NUMBER_OF_ANALOG_INPUTS) - 1);
+	if (mask == 0) {
+		return 0;
+	}
+
+	/* Validate the whole plan before anything is powered */
+	therm = IsThermistorCircuit(plan->type[find_lsb_set(mask) - 1]);
+	for (i = 0; i < NUMBER_OF_ANALOG_INPUTS; i++) {
+		if ((mask & BIT(i)) == 0) {
+			continue;
+		}
+		if (plan->type[i] >= NUMBER_OF_ADC_TYPES ||
+		    plan->type[i] == ADC_TYPE_VREF ||
+		    NeedsRails(plan->type[i]) != rails ||
+		    IsThermistorCircuit(plan->type[i]) != therm) {
+			LOG_ERR("Invalid scan type for input %d", i);
+			return -EINVAL;
+		}
+		if (plan->type[i] == ADC_TYPE_CURRENT &&
+		    !ValidInputForCurrentMeasurement(i)) {
+			LOG_ERR("Invalid input for current measurement");
+			return -EINVAL;
+		}
+	}
+
+	return mask;
+}
+
+/* Measure a validated plan with the circuit powered once.
+ * Must be called with the ADC lock held.
+ */
+static int ScanLocked(const AdcBt6ScanPlan_t *plan, int16_t *results)
+{
+	uint8_t mask = plan->channel_mask & (BIT(NUMBER_OF_ANALOG_INPUTS) - 1);
+	uint8_t remaining = mask;
+	int sampled = 0;
+	bool first = true;
+	AdcPwrSequence_t power;
+	size_t i;
+
+	for (i = 0; i < NUMBER_OF_ANALOG_INPUTS; i++) {
+		if ((mask & BIT(i)) == 0) {
+			continue;
+		}
+		remaining &= ~BIT(i);
+
+		if (first && remaining == 0) {
+			power = ADC_PWR_SEQ_SINGLE;
+		} else if (first) {
+			power = ADC_PWR_SEQ_START;
+		} else if (remaining == 0) {
+			power = ADC_PWR_SEQ_END;
+		} else {
+			power = ADC_PWR_SEQ_CONTINUE;
+		}
+		first = false;
+
+		if (MeasureLocked(&results[i], i, plan->type[i], power,
+				  false) >= 0) {
+			sampled |= BIT(i);
 		}
+	}
+
+	LOG_DBG("Scan 0x%x sampled 0x%x power transitions %u busy wait %u us "
+		"expander writes %u",
+		mask, sampled, adcObj.stats.transitions,
+		adcObj.stats.busy_wait_us, adcObj.stats.expander_writes);
+
+	return sampled;
+}
+
+static bool NeedsRails(AdcMeasurementType_t type)
+{
+	return (type == ADC_TYPE_PRESSURE || type == ADC_TYPE_ULTRASONIC);
+}
+
+static uint32_t SettleTimeMs(AdcMeasurementType_t type)
+{
+	switch (type) {
+	case ADC_TYPE_PRESSURE:
+		return PRESSURE_DELAY_MS;
+	case ADC_TYPE_ULTRASONIC:
+		return ULTRASONIC_DELAY_MS;
+	default:
+		return 0;
+	}
+}
+
+/* 5V must be enabled before B+ and disabled after it. The enables sleep until
+ * the rail is up. Only the rail reference count calls these.
+ */
+static int FiveVoltEnable(void)
+{
+	int rc = -EINVAL;
+	if (!adcObj.bPlusEnabled) {
+		rc = BSP_PinSet(FIVE_VOLT_ENABLE_PIN, 1);
 	} else {
-		rc = 0;
+		LOG_ERR("Enable 5V before enabling b+");
+	}
+
+	if (rc == 0) {
+		k_sleep(K_MSEC(V_5_ENABLE_DELAY_MS));
+		adcObj.fiveEnabled = true;
 	}
 	return rc;
 }
 
-static void UltrasonicOrPressurePowerAndDelayHandler(AdcMeasurementType_t type)
+static int FiveVoltDisable(void)
 {
-	if (type == ADC_TYPE_PRESSURE || type == ADC_TYPE_ULTRASONIC) {
-		AdcBt6_FiveVoltEnable();
-		AdcBt6_BplusEnable();
+	int rc = -EINVAL;
+	if (!adcObj.bPlusEnabled) {
+		rc = BSP_PinSet(FIVE_VOLT_ENABLE_PIN, 0);
+	} else {
+		LOG_ERR("Disable b+ before disabling 5V");
 	}
+	if (rc == 0) {
+		adcObj.fiveEnabled = false;
+	}
+	return rc;
+}
 
-	if (type == ADC_TYPE_PRESSURE) {
-		k_sleep(K_MSEC(PRESSURE_DELAY_MS));
+static int BplusEnable(void)
+{
+	int rc = BSP_PinSet(BATT_OUT_ENABLE_PIN, 1);
+	if (rc == 0) {
+		k_sleep(K_MSEC(V_5_ENABLE_DELAY_MS));
+		adcObj.bPlusEnabled = true;
 	}
+	return rc;
+}
 
-	if (type == ADC_TYPE_ULTRASONIC) {
-		k_sleep(K_MSEC(ULTRASONIC_DELAY_MS));
+static int BplusDisable(void)
+{
+	int rc = -EINVAL;
+	if (adcObj.fiveEnabled) {
+		rc = BSP_PinSet(BATT_OUT_ENABLE_PIN, 0);
+	} else {
+		LOG_ERR("Disable 5V after disabling b+");
 	}
+
+	if (rc == 0) {
+		adcObj.bPlusEnabled = false;
+	}
+	return rc;
 }
 
-static void UltrasonicOrPressureDisablePower(AdcMeasurementType_t type)
+/* The sensors have settled. The ADC lock is only held for the conversions and
+ * the rails are dropped after the last one. When no buffer is available the
+ * work is rescheduled to send the results that were already taken.
+ */
+static void SettleWorkHandler(struct k_work *work)
 {
-	if (type == ADC_TYPE_PRESSURE || type == ADC_TYPE_ULTRASONIC) {
-		AdcBt6_BplusDisable();
-		AdcBt6_FiveVoltDisable();
+	ARG_UNUSED(work);
+	AdcSettle_t *p = &adcObj.settle;
+	AnalogSettledMsg_t *pMsg;
+
+	if (!p->scanned) {
+		memset(p->raw, 0, sizeof(p->raw));
+		locking_take(LOCKING_ID_adc, K_FOREVER);
+		p->status = ScanLocked(&p->plan, p->raw);
+		p->timestamp = k_uptime_get();
+		locking_give(LOCKING_ID_adc);
+
+		AdcBt6_RailsRelease();
+		p->scanned = true;
+		p->sendAttempts = 0;
+	}
+
+	pMsg = (AnalogSettledMsg_t *)BufferPool_Take(sizeof(AnalogSettledMsg_t));
+	if (pMsg == NULL) {
+		p->sendAttempts += 1;
+		if (p->sendAttempts < SETTLE_SEND_ATTEMPTS) {
+			k_work_schedule_for_queue(&adcSettleQueue, &p->work,
+						  K_MSEC(SETTLE_SEND_RETRY_MS));
+			return;
+		}
+		/* The receiver recovers with its own timeout */
+		LOG_ERR("Unable to send settled measurement");
+	} else {
+		pMsg->header.msgCode = FMC_ANALOG_SETTLED;
+		pMsg->header.txId = FWK_ID_RESERVED;
+		pMsg->header.rxId = p->rxId;
+		pMsg->status = p->status;
+		pMsg->plan = p->plan;
+		memcpy(pMsg->raw, p->raw, sizeof(pMsg->raw));
+		pMsg->timestamp = p->timestamp;
+	}
+
+	/* Allow the receiver to start the next measurement */
+	p->scanned = false;
+	atomic_clear(&p->busy);
+
+	if (pMsg != NULL) {
+		FRAMEWORK_MSG_SEND(pMsg);
 	}
 }
 
@@ -774,6 +1463,77 @@ static float Steinhart_Hart(float calibrated, float a, float b, float c)
 	return (result);
 }
 
+/* Evaluate Steinhart-Hart at every table step. This is the only place the
+ * thermistor conversion uses log(). A calibrated reading at either end of
+ * the range is a short (hot) or an open (cold) circuit, where the equation
+ * has no finite result, so those entries saturate.
+ */
+static void BuildThermistorTable(int16_t *centi, size_t channel)
+{
+	float a = attr_get_float(ATTR_ID_therm_1_coefficient_a + channel,
+				 THERMISTOR_S_H_A);
+	float b = attr_get_float(ATTR_ID_therm_1_coefficient_b + channel,
+				 THERMISTOR_S_H_B);
+	float c = attr_get_float(ATTR_ID_therm_1_coefficient_c + channel,
+				 THERMISTOR_S_H_C);
+	float offset = attr_get_float(ATTR_ID_sh_offset, THERMISTOR_S_H_OFFSET);
+	int32_t raw;
+	float calibrated;
+	float t;
+	size_t i;
+
+	for (i = 0; i < THERM_TABLE_SIZE; i++) {
+		raw = MIN(i << THERM_TABLE_SHIFT, THERM_TABLE_MAX_RAW);
+		calibrated = AdcBt6_ApplyThermistorCalibration(raw);
+		if (calibrated <= 0.0f) {
+			t = INT16_MAX;
+		} else if (calibrated >= BIT(ADC_RESOLUTION)) {
+			t = INT16_MIN;
+		} else {
+			t = (Steinhart_Hart(calibrated, a, b, c) - offset) *
+			    THERM_TABLE_SCALE;
+		}
+		if (isnan(t)) {
+			t = INT16_MIN;
+		}
+		t = MAX(MIN(t, INT16_MAX), INT16_MIN);
+		centi[i] = (int16_t)(t + ((t < 0) ? -0.5f : 0.5f));
+	}
+}
+
+/* Linear interpolation between the two table entries around raw */
+static int32_t ThermistorLookup(size_t channel, int32_t raw)
+{
+	const ThermTables_t *p;
+	atomic_val_t generation;
+	int32_t lo;
+	int32_t hi;
+	int32_t frac;
+	size_t i;
+
+	if (channel >= NUMBER_OF_ANALOG_INPUTS) {
+		return 0;
+	}
+
+	raw = MAX(MIN(raw, THERM_TABLE_MAX_RAW), 0);
+	i = raw >> THERM_TABLE_SHIFT;
+	frac = raw & (THERM_TABLE_STEP - 1);
+
+	/* Retry if a rebuild started while the entries were read */
+	do {
+		generation = atomic_get(&thermGeneration);
+		p = atomic_ptr_get(&thermTablesActive);
+		if (p == NULL) {
+			return 0;
+		}
+		lo = p->centi[channel][i];
+		hi = p->centi[channel][i + 1];
+	} while (generation != atomic_get(&thermGeneration));
+
+	lo += ((hi - lo) * frac) / THERM_TABLE_STEP;
+	return MAX(MIN(lo, THERM_TABLE_MAX_CENTI), THERM_TABLE_MIN_CENTI);
+}
+
 static bool ADCChannelIsSimulated(AnalogChannel_t channel,
 				  int16_t *simulated_value)
 {
@@ -807,7 +1567,8 @@ static bool ADCChannelIsSimulated(AnalogChannel_t channel,
 		}
 	}
 
-	if (channel_found) {
+	if (channel_found &&
+	    attr_simulation_maybe_active(enable_map[channel_index])) {
 		/* Check if the channel is being simulated */
 		if (attr_get(enable_map[channel_index],
 				  &simulation_enabled,
@@ -844,7 +1605,8 @@ static bool VoltageIsSimulated(size_t channel, float *simulated_value)
 				      ATTR_ID_voltage_3_simulated_value,
 				      ATTR_ID_voltage_4_simulated_value };
 
-	if (channel < TOTAL_ANALOG_CH) {
+	if (channel < TOTAL_ANALOG_CH &&
+	    attr_simulation_maybe_active(enable_map[channel])) {
 		/* Check if the voltage is being simulated */
 		if (attr_get(enable_map[channel], &simulation_enabled,
 				  sizeof(simulation_enabled)) ==
@@ -876,7 +1638,8 @@ static bool UltrasonicIsSimulated(float *simulated_value)
 	bool is_simulated = false;
 	bool simulation_enabled = false;
 
-	if (attr_get(ATTR_ID_ultrasonic_simulated, &simulation_enabled,
+	if (attr_simulation_maybe_active(ATTR_ID_ultrasonic_simulated) &&
+	    attr_get(ATTR_ID_ultrasonic_simulated, &simulation_enabled,
 		     sizeof(simulation_enabled)) ==
 	    sizeof(simulation_enabled)) {
 		if (simulation_enabled) {
@@ -899,7 +1662,8 @@ static bool PressureIsSimulated(float *simulated_value)
 	bool is_simulated = false;
 	bool simulation_enabled = false;
 
-	if (attr_get(ATTR_ID_pressure_simulated, &simulation_enabled,
+	if (attr_simulation_maybe_active(ATTR_ID_pressure_simulated) &&
+	    attr_get(ATTR_ID_pressure_simulated, &simulation_enabled,
 		     sizeof(simulation_enabled)) ==
 	    sizeof(simulation_enabled)) {
 		if (simulation_enabled) {
@@ -932,7 +1696,8 @@ static bool CurrentIsSimulated(size_t channel, float *simulated_value)
 				      ATTR_ID_current_3_simulated_value,
 				      ATTR_ID_current_4_simulated_value };
 
-	if (channel < TOTAL_ANALOG_CH) {
+	if (channel < TOTAL_ANALOG_CH &&
+	    attr_simulation_maybe_active(enable_map[channel])) {
 		/* Check if the current is being simulated */
 		if (attr_get(enable_map[channel], &simulation_enabled,
 				  sizeof(simulation_enabled)) ==
@@ -958,7 +1723,8 @@ static bool VrefIsSimulated(float *simulated_value)
 	bool is_simulated = false;
 	bool simulation_enabled = false;
 
-	if (attr_get(ATTR_ID_vref_simulated, &simulation_enabled,
+	if (attr_simulation_maybe_active(ATTR_ID_vref_simulated) &&
+	    attr_get(ATTR_ID_vref_simulated, &simulation_enabled,
 			  sizeof(simulation_enabled)) ==
 	    sizeof(simulation_enabled)) {
 		if (simulation_enabled) {
@@ -991,7 +1757,8 @@ static bool TemperatureIsSimulated(size_t channel, float *simulated_value)
 				      ATTR_ID_temperature_3_simulated_value,
 				      ATTR_ID_temperature_4_simulated_value };
 
-	if (channel < TOTAL_ANALOG_CH) {
+	if (channel < TOTAL_ANALOG_CH &&
+	    attr_simulation_maybe_active(enable_map[channel])) {
 		/* Check if the temperature is being simulated */
 		if (attr_get(enable_map[channel], &simulation_enabled,
 				  sizeof(simulation_enabled)) ==
@@ -1017,7 +1784,8 @@ static bool power_volt_is_simulated(float *simulated_value)
 	bool is_simulated = false;
 	bool simulation_enabled = false;
 
-	if (attr_get(ATTR_ID_power_volts_simulated, &simulation_enabled,
+	if (attr_simulation_maybe_active(ATTR_ID_power_volts_simulated) &&
+	    attr_get(ATTR_ID_power_volts_simulated, &simulation_enabled,
 		     sizeof(simulation_enabled)) ==
 	    sizeof(simulation_enabled)) {
 		if (simulation_enabled) {
@@ -1032,3 +1800,29 @@ static bool power_volt_is_simulated(float *simulated_value)
 
 	return (is_simulated);
 }
+
+/* The analog input voltage multiplied by factor, in milli-units. The
+ * multiplication is done before the division so that no precision is lost.
+ */
+static int32_t ScaleVoltageMilli(size_t channel, int32_t raw, int32_t factor)
+{
+	float simulated;
+
+	if (VoltageIsSimulated(channel, &simulated)) {
+		return ToMilli(simulated * factor);
+	}
+	return DivRoundClosest((int64_t)raw * ANALOG_VOLTAGE_MILLI_NUM * factor,
+			       ANALOG_VOLTAGE_MILLI_DEN);
+}
+
+static int32_t DivRoundClosest(int64_t n, int32_t d)
+{
+	return (int32_t)((n >= 0) ? ((n + (d / 2)) / d) : ((n - (d / 2)) / d));
+}
+
+/* Only used for simulated values */
+static int32_t ToMilli(float value)
+{
+	value *= ADC_BT6_MILLI;
+	return (int32_t)((value >= 0) ? (value + 0.5f) : (value - 0.5f));
+}
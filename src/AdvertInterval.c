@@ -0,0 +1,30 @@
+/**
+ * @file AdvertInterval.c
+ * @brief Advertising interval that follows the event traffic
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr.h>
+
+#include "AdvertInterval.h"
+
+/**************************************************************************************************/
+/* Global Function Definitions                                                                    */
+/**************************************************************************************************/
+uint32_t AdvertInterval_Next(uint32_t current, bool busy, const AdvertIntervalConfig_t *cfg)
+{
+	uint32_t interval;
+
+	if (busy) {
+		interval = cfg->fast;
+	} else {
+		interval = (uint32_t)(((uint64_t)current * cfg->growth) / 100);
+	}
+	return MAX(cfg->fast, MIN(interval, cfg->idle));
+}
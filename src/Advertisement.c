@@ -16,6 +16,7 @@ LOG_MODULE_REGISTER(Advertisement, CONFIG_ADVERTISEMENT_LOG_LEVEL);
 #include <bluetooth/bluetooth.h>
 #include <bluetooth/conn.h>
 #include <stdlib.h>
+#include <sys/crc.h>
 
 #include "app_version.h"
 #include "lcz_sensor_adv_format.h"
@@ -26,6 +27,9 @@ LOG_MODULE_REGISTER(Advertisement, CONFIG_ADVERTISEMENT_LOG_LEVEL);
 #include "EventTask.h"
 #include "attr_custom_validator.h"
 #include "Flags.h"
+#if defined(CONFIG_ADVERTISEMENT_EVENT_PACKING)
+#include "EventPack.h"
+#endif
 
 #if defined(CONFIG_LCZ_BLE_CLIENT_DM) && defined(CONFIG_LCZ_SENSOR_ADV_ENC)
 #include "lcz_sensor_adv_enc.h"
@@ -43,6 +47,24 @@ LOG_MODULE_REGISTER(Advertisement, CONFIG_ADVERTISEMENT_LOG_LEVEL);
 #define CODED_PHY_STRING "Coded"
 #define STANDARD_PHY_STRING "1M PHY"
 
+/* The longest interval, 10.24 s, that the legacy advertising commands accept. A set scaled by
+ * the dual PHY ratio is clamped to it.
+ */
+#define ADVERTISING_INTERVAL_LIMIT 0x4000
+
+#if defined(CONFIG_ADVERTISEMENT_EVENT_PACKING)
+#define ADVERTISEMENT_MAX_EVENTS CONFIG_ADVERTISEMENT_PACKED_EVENTS
+#else
+#define ADVERTISEMENT_MAX_EVENTS 1
+#endif
+
+#if defined(CONFIG_ADVERTISEMENT_EVENT_PACKING)
+/* The packed record follows the existing coded PHY record so receivers that
+ * don't know this protocol ID still find the single event they expect.
+ */
+#define PACKED_AD_SIZE EVENT_PACK_SIZE(CONFIG_ADVERTISEMENT_PACKED_EVENTS)
+#endif
+
 /**************************************************************************************************/
 /* Local Data Definitions                                                                         */
 /**************************************************************************************************/
@@ -53,12 +75,49 @@ static LczSensorDMEncrAd_t enc_ad;
 static LczSensorAdEvent_t ad;
 static LczSensorAdExt_t ext;
 static LczSensorRspWithHeader_t rsp;
+#if defined(CONFIG_ADVERTISEMENT_EVENT_PACKING)
+static uint8_t packed[PACKED_AD_SIZE];
+#endif
 #endif
-static struct bt_le_ext_adv *adv1M;
-static struct bt_le_ext_adv *advCoded;
 static SensorMsg_t current;
 static bool codedPhyEnabled = false;
-static bool connected = false;
+/* When advertising on the coded PHY the 1M set also advertises at this
+ * multiple of the advertising interval, 0 to disable.
+ */
+static uint8_t dualPhyRatio;
+#if defined(CONFIG_LCZ_BLE_CLIENT_DM)
+static bool canEncrypt;
+#endif
+
+/* Hash of the data last written to each advertising set */
+typedef struct {
+	uint32_t hash;
+	bool valid;
+} AdvPayload_t;
+
+/* Both sets are created at init and kept for the life of the application.
+ * Switching PHY only stops one set and starts the other.
+ */
+typedef struct {
+	struct bt_le_ext_adv *adv;
+	struct bt_le_adv_param *param;
+	/* Minimum interval last written to the controller */
+	uint32_t interval;
+	AdvPayload_t payload;
+	bool advertising;
+	const char *name;
+} AdvSet_t;
+
+typedef struct {
+	uint32_t commands;
+	uint32_t skipped;
+	uint32_t hourCommands;
+	/* Advertising time counted towards the current hour */
+	int64_t hourMs;
+	int64_t startMs;
+} HciStats_t;
+
+static HciStats_t hciStats;
 
 enum {
 	/**< Number of microseconds in 0.625 milliseconds. */
@@ -102,9 +161,14 @@ static struct bt_data bt_ad[] = {
 	BT_DATA(BT_DATA_MANUFACTURER_DATA, &ad, sizeof(ad)),
 };
 
-static struct bt_data bt_extAd[] = { BT_DATA_BYTES(BT_DATA_FLAGS,
-						   (BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR)),
-				     BT_DATA(BT_DATA_MANUFACTURER_DATA, &ext, sizeof(ext)) };
+static struct bt_data bt_extAd[] = {
+	BT_DATA_BYTES(BT_DATA_FLAGS, (BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR)),
+	BT_DATA(BT_DATA_MANUFACTURER_DATA, &ext, sizeof(ext)),
+#if defined(CONFIG_ADVERTISEMENT_EVENT_PACKING)
+	/* The length follows the number of packed events */
+	BT_DATA(BT_DATA_MANUFACTURER_DATA, packed, EVENT_PACK_HEADER_SIZE),
+#endif
+};
 
 /* When using BT_LE_ADV_OPT_USE_NAME, device name is added to scan response
  * data by controller.
@@ -114,10 +178,17 @@ static struct bt_data bt_rsp[] = {
 };
 #endif
 
+static AdvSet_t set1M = { .param = &bt_param1M, .name = STANDARD_PHY_STRING };
+static AdvSet_t setCoded = { .param = &bt_paramCoded, .name = CODED_PHY_STRING };
+
+/* Stops the other set when a connection is made on one of them */
+static struct k_work stop_work;
+
 /* Work queue item used to update advertisement */
 struct ad_update_work_item_t {
 	struct k_work work;
-	SensorMsg_t sensor_event;
+	SensorMsg_t sensor_event[ADVERTISEMENT_MAX_EVENTS];
+	size_t count;
 } ad_update_work_item;
 
 /**************************************************************************************************/
@@ -125,10 +196,24 @@ struct ad_update_work_item_t {
 /**************************************************************************************************/
 static void CreateAdvertisingParm(void);
 static void AdvConnected(struct bt_conn *conn, uint8_t reason);
-static void AdvDisconnected(struct bt_conn *conn, uint8_t reason);
-static void CreateAdvertisingCodedParam(void);
-static void CreateAdvertising1MParam(void);
+static void AdvSetConnected(struct bt_le_ext_adv *adv, struct bt_le_ext_adv_connected_info *info);
+static void StopWorkHandler(struct k_work *item);
+static int CreateSet(AdvSet_t *set);
+static int StartSet(AdvSet_t *set, uint32_t scale);
+static int StopSet(AdvSet_t *set);
+static int SetData(AdvSet_t *set);
+#if defined(CONFIG_LCZ_BLE_CLIENT_DM)
+static void TryEncrypt(void);
+#endif
 static void QueuedUpdateAdvertisement(struct k_work *item);
+static int SetAdvertisingData(AdvSet_t *set, const struct bt_data *ad, size_t ad_len,
+			      const struct bt_data *sd, size_t sd_len);
+static uint32_t PayloadHash(const struct bt_data *data, size_t len, uint32_t crc);
+static void AdvertisingTime(void);
+static void CountHciCommands(uint32_t count);
+#if defined(CONFIG_ADVERTISEMENT_EVENT_PACKING)
+static void PackEvents(const SensorMsg_t *events, size_t count);
+#endif
 
 /**************************************************************************************************/
 /* Connection callbacks.                                                                          */
@@ -140,7 +225,7 @@ static void QueuedUpdateAdvertisement(struct k_work *item);
 /**************************************************************************************************/
 static struct bt_conn_cb connection_callbacks = {
 	.connected = AdvConnected,
-	.disconnected = AdvDisconnected,
+	.disconnected = NULL,
 	.le_param_req = NULL,
 	.le_param_updated = NULL,
 	.identity_resolved = NULL,
@@ -148,6 +233,10 @@ static struct bt_conn_cb connection_callbacks = {
 	.le_phy_updated = NULL,
 };
 
+static const struct bt_le_ext_adv_cb adv_callbacks = {
+	.connected = AdvSetConnected,
+};
+
 /**************************************************************************************************/
 /* Authorisation callbacks.                                                                       */
 /*                                                                                                */
@@ -251,6 +340,10 @@ int Advertisement_Init(void)
 	ext.rsp.firmwareType = rsp.rsp.firmwareType;
 	ext.rsp.configVersion = rsp.rsp.configVersion;
 	ext.rsp.hardwareVersion = rsp.rsp.hardwareVersion;
+
+#if defined(CONFIG_ADVERTISEMENT_EVENT_PACKING)
+	(void)EventPack_Encode(packed, sizeof(packed), NULL, 0);
+#endif
 #endif
 
 	bt_conn_cb_register(&connection_callbacks);
@@ -261,45 +354,48 @@ int Advertisement_Init(void)
 
 	/* Delayed work item for ad update */
 	k_work_init(&ad_update_work_item.work, QueuedUpdateAdvertisement);
+	k_work_init(&stop_work, StopWorkHandler);
 
 	return r;
 }
 
 int Advertisement_IntervalUpdate(void)
 {
-	int r = 0;
-	uint32_t advertInterval = 0;
+	uint16_t advertInterval = 0;
 
 	attr_get(ATTR_ID_advertising_interval, &advertInterval, sizeof(advertInterval));
 
-	advertInterval = MSEC_TO_UNITS(advertInterval, UNIT_0_625_MS);
+	return Advertisement_IntervalSet(advertInterval);
+}
+
+int Advertisement_IntervalSet(uint32_t milliseconds)
+{
+	int r = 0;
+	uint32_t advertInterval = MSEC_TO_UNITS(milliseconds, UNIT_0_625_MS);
+	uint8_t ratio = 0;
+
+	attr_get(ATTR_ID_advertising_dual_phy_ratio, &ratio, sizeof(ratio));
+
+	/* Only a parameter change needs the advertiser to be restarted */
+	if ((bt_param1M.interval_min == advertInterval) &&
+	    (bt_paramCoded.interval_min == advertInterval) && (dualPhyRatio == ratio)) {
+		return 0;
+	}
+
 	bt_param1M.interval_max = advertInterval + BT_GAP_ADV_FAST_INT_MAX_1;
 	bt_param1M.interval_min = advertInterval;
 
 	bt_paramCoded.interval_max = bt_param1M.interval_max;
 	bt_paramCoded.interval_min = bt_param1M.interval_min;
 
-	if (advertising == true) {
-		r = Advertisement_End();
-		if (r == 0) {
-			if (codedPhyEnabled == true) {
-				r = bt_le_ext_adv_update_param(advCoded, &bt_paramCoded);
-			} else {
-				r = bt_le_ext_adv_update_param(adv1M, &bt_param1M);
-			}
+	dualPhyRatio = ratio;
 
-			LOG_DBG("update interval (%d)", r);
-		}
+	/* The parameters are written to each set when it is started */
+	if (advertising == true) {
+		Advertisement_End();
 		r = Advertisement_Start();
-	} else {
-		if (codedPhyEnabled == true) {
-			r = bt_le_ext_adv_update_param(advCoded, &bt_paramCoded);
-		} else {
-			r = bt_le_ext_adv_update_param(adv1M, &bt_param1M);
-		}
-
-		LOG_DBG("update interval (%d)", r);
 	}
+	LOG_DBG("update interval (%d)", r);
 
 	return r;
 }
@@ -313,15 +409,20 @@ int Advertisement_IntervalDefault(void)
 			 sizeof(advertIntervalDefault));
 
 	advertIntervalDefault = MSEC_TO_UNITS(advertIntervalDefault, UNIT_0_625_MS);
+	if ((bt_param1M.interval_min == advertIntervalDefault) &&
+	    (bt_paramCoded.interval_min == advertIntervalDefault)) {
+		return 0;
+	}
+
 	bt_param1M.interval_max = advertIntervalDefault + BT_GAP_ADV_FAST_INT_MAX_1;
 	bt_param1M.interval_min = advertIntervalDefault;
 
+	bt_paramCoded.interval_max = bt_param1M.interval_max;
+	bt_paramCoded.interval_min = bt_param1M.interval_min;
+
 	if (advertising == true) {
 		r = Advertisement_End();
 	}
-	if (r == 0) {
-		r = bt_le_ext_adv_update_param(adv1M, &bt_param1M);
-	}
 	LOG_DBG("update interval to default(%d)", r);
 
 	return r;
@@ -329,25 +430,49 @@ int Advertisement_IntervalDefault(void)
 
 int Advertisement_Update(SensorMsg_t *sensor_event)
 {
-	ad_update_work_item.sensor_event = *sensor_event;
+	return Advertisement_UpdateEvents(sensor_event, 1);
+}
+
+int Advertisement_UpdateEvents(const SensorMsg_t *events, size_t count)
+{
+	if (count > ADVERTISEMENT_MAX_EVENTS) {
+		LOG_ERR("Too many events for advertisement (%d)", (int)count);
+		return -EINVAL;
+	}
+
+	memcpy(ad_update_work_item.sensor_event, events, count * sizeof(SensorMsg_t));
+	ad_update_work_item.count = count;
 	k_work_submit(&ad_update_work_item.work);
 
 	return 0;
 }
 
+size_t Advertisement_EventCapacity(void)
+{
+	/* Legacy 1M PHY advertisements only have room for one event. While the
+	 * 1M set runs beside the coded set, events are sent one at a time so
+	 * that 1M only gateways don't miss the packed ones.
+	 */
+	return (codedPhyEnabled && (dualPhyRatio == 0)) ? ADVERTISEMENT_MAX_EVENTS : 1;
+}
+
 int Advertisement_End(void)
 {
 	int r = 0;
-	char *phyType;
+	int r1M;
+
 	if (codedPhyEnabled == true) {
-		r = bt_le_ext_adv_stop(advCoded);
-		phyType = CODED_PHY_STRING;
+		r = StopSet(&setCoded);
+		/* The 1M set may also be running at a lower duty cycle */
+		r1M = StopSet(&set1M);
+		if (r1M < 0) {
+			LOG_ERR("Failed to stop %s set beside %s (%d)", set1M.name, setCoded.name,
+				r1M);
+			r = (r < 0) ? r : r1M;
+		}
 	} else {
-		r = bt_le_ext_adv_stop(adv1M);
-		phyType = STANDARD_PHY_STRING;
+		r = StopSet(&set1M);
 	}
-
-	LOG_DBG("Advertising %s end (%d)", phyType, r);
 	advertising = false;
 
 	return r;
@@ -356,20 +481,29 @@ int Advertisement_End(void)
 int Advertisement_Start(void)
 {
 	int r = 0;
-	char *phyType;
+	int r1M;
 
 #ifndef CONFIG_ADVERTISEMENT_DISABLE
 	if (!advertising) {
 		if (codedPhyEnabled == true) {
-			r = bt_le_ext_adv_start(advCoded, NULL);
-			phyType = CODED_PHY_STRING;
+			r = StartSet(&setCoded, 1);
+			/* Reach gateways that only scan the 1M PHY. The coded
+			 * set is already advertising, so a failure here only
+			 * loses the 1M gateways.
+			 */
+			if ((r == 0) && (dualPhyRatio > 0)) {
+				r1M = StartSet(&set1M, dualPhyRatio);
+				if (r1M < 0) {
+					LOG_ERR("Failed to start %s set beside %s (%d)",
+						set1M.name, setCoded.name, r1M);
+				}
+			}
 		} else {
-			r = bt_le_ext_adv_start(adv1M, NULL);
-			phyType = STANDARD_PHY_STRING;
+			r = StartSet(&set1M, 1);
 		}
 
 		advertising = (r == 0);
-		LOG_DBG("Advertising %s start (%d)", phyType, r);
+		hciStats.startMs = k_uptime_get();
 	}
 
 #endif
@@ -379,23 +513,12 @@ int Advertisement_Start(void)
 
 void Advertisement_ExtendedSet(bool status)
 {
-	if ((codedPhyEnabled == true) && (status == false)) {
+	if (codedPhyEnabled != status) {
 		if (advertising == true) {
 			Advertisement_End();
 		}
-		/* Turn off the coded advertisement, enable 1M */
-		bt_le_ext_adv_delete(advCoded);
-		codedPhyEnabled = false;
-		CreateAdvertising1MParam();
-		Advertisement_Start();
-	} else if ((codedPhyEnabled == false) && (status == true)) {
-		if (advertising == true) {
-			Advertisement_End();
-		}
-		/* Turn off the 1M advertisement, enable coded */
-		bt_le_ext_adv_delete(adv1M);
-		codedPhyEnabled = true;
-		CreateAdvertisingCodedParam();
+		/* Both sets are resident, there is nothing to delete or create */
+		codedPhyEnabled = status;
 		Advertisement_Start();
 	} else {
 		/* Nothing to do here already configured */
@@ -427,81 +550,149 @@ void CreateAdvertisingParm(void)
 {
 	uint8_t advertising_phy;
 	attr_get(ATTR_ID_advertising_phy, &advertising_phy, sizeof(advertising_phy));
+	attr_get(ATTR_ID_advertising_dual_phy_ratio, &dualPhyRatio, sizeof(dualPhyRatio));
 
-	if (advertising_phy == ADVERTISING_PHY_1M) {
-		CreateAdvertising1MParam();
-		codedPhyEnabled = false;
-	} else {
-		CreateAdvertisingCodedParam();
-		codedPhyEnabled = true;
-	}
+#if defined(CONFIG_LCZ_BLE_CLIENT_DM)
+	TryEncrypt();
+#endif
+	CreateSet(&set1M);
+	CreateSet(&setCoded);
+	codedPhyEnabled = (advertising_phy != ADVERTISING_PHY_1M);
 }
 
 static void AdvConnected(struct bt_conn *conn, uint8_t reason)
 {
+	/* The controller stops a connectable advertiser on connection */
+	AdvertisingTime();
 	advertising = false;
-	connected = true;
 }
 
-static void AdvDisconnected(struct bt_conn *conn, uint8_t reason)
+static void AdvSetConnected(struct bt_le_ext_adv *adv, struct bt_le_ext_adv_connected_info *info)
 {
-	connected = false;
+	if (adv == setCoded.adv) {
+		setCoded.advertising = false;
+	} else if (adv == set1M.adv) {
+		set1M.advertising = false;
+	}
+
+	/* Only one connection is accepted */
+	if (setCoded.advertising || set1M.advertising) {
+		k_work_submit(&stop_work);
+	}
 }
 
-void CreateAdvertisingCodedParam(void)
+static void StopWorkHandler(struct k_work *item)
 {
-	int err = 0;
-#if defined(CONFIG_LCZ_BLE_CLIENT_DM)
-	bool canEncrypt = false;
-#endif
+	(void)StopSet(&setCoded);
+	(void)StopSet(&set1M);
+}
+
+static int CreateSet(AdvSet_t *set)
+{
+	int r = bt_le_ext_adv_create(set->param, &adv_callbacks, &set->adv);
 
-	err = bt_le_ext_adv_create(&bt_paramCoded, NULL, &advCoded);
-	if (err) {
-		LOG_WRN("Failed to create advertiser set (%d)\n", err);
+	CountHciCommands(1);
+	if (r) {
+		LOG_WRN("Failed to create %s advertiser set (%d)", set->name, r);
 	}
+	set->interval = set->param->interval_min;
+	set->payload.valid = false;
+	return r;
+}
 
-#if defined(CONFIG_LCZ_BLE_CLIENT_DM)
-#if defined(CONFIG_LCZ_SENSOR_ADV_ENC)
-	/* If we can encrypt (and haven't already), try to do it */
-	canEncrypt = lcz_sensor_adv_can_encrypt();
-	if (canEncrypt && enc_ad.mic == 0) {
-		err = lcz_sensor_adv_encrypt(&enc_ad);
-		if (err < 0) {
-			LOG_ERR("CreateAdvertisingCodedParam: encrypt failed: %d", err);
-			canEncrypt = false;
-		}
+/* The set is started with its interval multiplied by scale */
+static int StartSet(AdvSet_t *set, uint32_t scale)
+{
+	struct bt_le_adv_param param = *set->param;
+	int r = 0;
+
+	if (set->advertising) {
+		return 0;
 	}
-#endif
-	if (canEncrypt) {
-		err = bt_le_ext_adv_set_data(advCoded, bt_enc_ad, ARRAY_SIZE(bt_enc_ad), NULL, 0);
-	} else {
-		err = bt_le_ext_adv_set_data(advCoded, bt_unenc_ad, ARRAY_SIZE(bt_unenc_ad), NULL,
-					     0);
+
+	param.interval_min = MIN(param.interval_min * scale, ADVERTISING_INTERVAL_LIMIT);
+	param.interval_max = MIN(param.interval_max * scale, ADVERTISING_INTERVAL_LIMIT);
+	if (param.interval_min != set->interval) {
+		r = bt_le_ext_adv_update_param(set->adv, &param);
+		CountHciCommands(1);
+		LOG_DBG("update %s interval (%d)", set->name, r);
+		if (r < 0) {
+			/* Don't advertise with parameters that weren't asked for */
+			LOG_ERR("Failed to update %s interval (%d)", set->name, r);
+			return r;
+		}
+		set->interval = param.interval_min;
 	}
-#else
-	err = bt_le_ext_adv_set_data(advCoded, bt_extAd, ARRAY_SIZE(bt_extAd), NULL, 0);
-#endif
-	if (err) {
-		LOG_WRN("Failed to set advertising data (%d)\n", err);
+
+	/* Updates are only written to the sets that are enabled */
+	r = SetData(set);
+	if (r < 0) {
+		LOG_WRN("Failed to set %s advertising data (%d)", set->name, r);
 	}
+
+	r = bt_le_ext_adv_start(set->adv, NULL);
+	CountHciCommands(1);
+	set->advertising = (r == 0);
+	LOG_DBG("Advertising %s start (%d)", set->name, r);
+
+	return r;
 }
 
-void CreateAdvertising1MParam(void)
+static int StopSet(AdvSet_t *set)
 {
-	int err = 0;
-	err = bt_le_ext_adv_create(&bt_param1M, NULL, &adv1M);
-	if (err) {
-		LOG_WRN("Failed to create advertiser set (%d)\n", err);
+	int r = 0;
+
+	if (set->advertising) {
+		r = bt_le_ext_adv_stop(set->adv);
+		CountHciCommands(1);
+		LOG_DBG("Advertising %s end (%d)", set->name, r);
 	}
+	set->advertising = false;
+
+	return r;
+}
+
+static int SetData(AdvSet_t *set)
+{
 #if defined(CONFIG_LCZ_BLE_CLIENT_DM)
-	err = bt_le_ext_adv_set_data(adv1M, bt_unenc_ad, ARRAY_SIZE(bt_unenc_ad), NULL, 0);
+	if (set == &setCoded && canEncrypt) {
+		return SetAdvertisingData(set, bt_enc_ad, ARRAY_SIZE(bt_enc_ad), NULL, 0);
+	}
+
+	/* The protocol ID depends on the PHY of the set */
+	if (set == &setCoded) {
+		unenc_ad.protocolId = BTXXX_DM_CODED_PHY_AD_PROTOCOL_ID;
+	} else {
+		unenc_ad.protocolId = BTXXX_DM_1M_PHY_AD_PROTOCOL_ID;
+	}
+	return SetAdvertisingData(set, bt_unenc_ad, ARRAY_SIZE(bt_unenc_ad), NULL, 0);
 #else
-	err = bt_le_ext_adv_set_data(adv1M, bt_ad, ARRAY_SIZE(bt_ad), bt_rsp, ARRAY_SIZE(bt_rsp));
+	if (set == &setCoded) {
+		return SetAdvertisingData(set, bt_extAd, ARRAY_SIZE(bt_extAd), NULL, 0);
+	}
+	return SetAdvertisingData(set, bt_ad, ARRAY_SIZE(bt_ad), bt_rsp, ARRAY_SIZE(bt_rsp));
 #endif
-	if (err) {
-		LOG_WRN("Failed to set advertising data (%d)\n", err);
+}
+
+#if defined(CONFIG_LCZ_BLE_CLIENT_DM)
+/* If we can encrypt (and haven't already), try to do it */
+static void TryEncrypt(void)
+{
+	canEncrypt = false;
+#if defined(CONFIG_LCZ_SENSOR_ADV_ENC)
+	int r;
+
+	canEncrypt = lcz_sensor_adv_can_encrypt();
+	if (canEncrypt && enc_ad.mic == 0) {
+		r = lcz_sensor_adv_encrypt(&enc_ad);
+		if (r < 0) {
+			LOG_ERR("TryEncrypt: encrypt failed: %d", r);
+			canEncrypt = false;
+		}
 	}
+#endif
 }
+#endif
 
 void QueuedUpdateAdvertisement(struct k_work *item)
 {
@@ -510,22 +701,13 @@ void QueuedUpdateAdvertisement(struct k_work *item)
 
 	uint16_t networkId = 0;
 	int r = 0;
-#if defined(CONFIG_LCZ_BLE_CLIENT_DM)
-	bool canEncrypt = false;
-#else
+#if !defined(CONFIG_LCZ_BLE_CLIENT_DM)
 	uint8_t configVersion = 0;
 #endif
 
 	attr_get(ATTR_ID_network_id, &networkId, sizeof(networkId));
 
 #if defined(CONFIG_LCZ_BLE_CLIENT_DM)
-	/* Update the protocol ID based on the PHY that we're using */
-	if (codedPhyEnabled == true) {
-		unenc_ad.protocolId = BTXXX_DM_CODED_PHY_AD_PROTOCOL_ID;
-	} else {
-		unenc_ad.protocolId = BTXXX_DM_1M_PHY_AD_PROTOCOL_ID;
-	}
-
 	/* Update network ID and flags */
 	unenc_ad.networkId = networkId;
 	unenc_ad.flags = Flags_Get();
@@ -533,35 +715,30 @@ void QueuedUpdateAdvertisement(struct k_work *item)
 	enc_ad.flags = Flags_Get();
 
 	/* If a new event is available, put it into the advertisement */
-	if (ad_update->sensor_event.event.type != SENSOR_EVENT_RESERVED) {
-		enc_ad.recordType = ad_update->sensor_event.event.type;
-		enc_ad.id = ad_update->sensor_event.id;
-		enc_ad.epoch = ad_update->sensor_event.event.timestamp;
-		enc_ad.data = ad_update->sensor_event.event.data;
+	if (ad_update->count > 0 &&
+	    ad_update->sensor_event[0].event.type != SENSOR_EVENT_RESERVED) {
+		enc_ad.recordType = ad_update->sensor_event[0].event.type;
+		enc_ad.id = ad_update->sensor_event[0].id;
+		enc_ad.epoch = ad_update->sensor_event[0].event.timestamp;
+		enc_ad.data = ad_update->sensor_event[0].event.data;
 		enc_ad.mic = 0;
 	}
 
-#if defined(CONFIG_LCZ_SENSOR_ADV_ENC)
-	/* If we can encrypt (and haven't already), try to do it */
-	canEncrypt = lcz_sensor_adv_can_encrypt();
-	if (canEncrypt && enc_ad.mic == 0) {
-		r = lcz_sensor_adv_encrypt(&enc_ad);
-		if (r < 0) {
-			LOG_ERR("QueuedUpdateAdvertisement: encrypt failed: %d", r);
-			canEncrypt = false;
-		}
-	}
-#endif
+	TryEncrypt();
 #else
 	ad.networkId = networkId;
 	ad.flags = Flags_Get();
 
 	/* If no event was available, keep the last */
-	if (ad_update->sensor_event.event.type != SENSOR_EVENT_RESERVED) {
-		ad.recordType = ad_update->sensor_event.event.type;
-		ad.id = ad_update->sensor_event.id;
-		ad.epoch = ad_update->sensor_event.event.timestamp;
-		ad.data = ad_update->sensor_event.event.data;
+	if (ad_update->count > 0 &&
+	    ad_update->sensor_event[0].event.type != SENSOR_EVENT_RESERVED) {
+		ad.recordType = ad_update->sensor_event[0].event.type;
+		ad.id = ad_update->sensor_event[0].id;
+		ad.epoch = ad_update->sensor_event[0].event.timestamp;
+		ad.data = ad_update->sensor_event[0].event.data;
+#if defined(CONFIG_ADVERTISEMENT_EVENT_PACKING)
+		PackEvents(ad_update->sensor_event, ad_update->count);
+#endif
 	}
 
 	attr_get(ATTR_ID_config_version, &configVersion, sizeof(configVersion));
@@ -579,43 +756,98 @@ void QueuedUpdateAdvertisement(struct k_work *item)
 	ext.rsp.configVersion = rsp.rsp.configVersion;
 #endif
 
-	/* Don't stop advertising if in a connection. We still want
-	 * the advert content to be as up to date as possible when
-	 * advertising restarts, so still update the content. But we
-	 * want to avoid the stack issuing any errors by stopping a
-	 * a non-advertising device.
+	/* The data of an advertising set can be changed while it is running
+	 * or while it is stopped by a connection. Advertising isn't restarted
+	 * so that the advertising schedule isn't reset by each update.
 	 */
-	if (!connected) {
-		Advertisement_End();
-	}
-
-#if defined(CONFIG_LCZ_BLE_CLIENT_DM)
-	if (codedPhyEnabled == true && canEncrypt == true) {
-		r = bt_le_ext_adv_set_data(advCoded, bt_enc_ad, ARRAY_SIZE(bt_enc_ad), NULL, 0);
-	} else if (codedPhyEnabled == true) {
-		r = bt_le_ext_adv_set_data(advCoded, bt_unenc_ad, ARRAY_SIZE(bt_unenc_ad), NULL, 0);
-	} else {
-		r = bt_le_ext_adv_set_data(adv1M, bt_unenc_ad, ARRAY_SIZE(bt_unenc_ad), NULL, 0);
-	}
-#else
 	if (codedPhyEnabled == true) {
-		r = bt_le_ext_adv_set_data(advCoded, bt_extAd, ARRAY_SIZE(bt_extAd), NULL, 0);
+		r = SetData(&setCoded);
+		if (set1M.advertising && r >= 0) {
+			r = SetData(&set1M);
+		}
 	} else {
-		r = bt_le_ext_adv_set_data(adv1M, bt_ad, ARRAY_SIZE(bt_ad), bt_rsp,
-					   ARRAY_SIZE(bt_rsp));
+		r = SetData(&set1M);
 	}
-#endif
 	LOG_DBG("update advertising data (%d)", r);
 	if (r < 0) {
 		LOG_ERR("Failed to update advertising data (%d)", r);
 	}
+}
 
-	/* Don't start advertising if in a connection. The advert content
-	 * has been updated, but if we're in a connection we'll get an
-	 * error code being issued due to starting advertising in a
-	 * connection.
-	 */
-	if (!connected) {
-		Advertisement_Start();
+/* Writes the data to the set unless it matches what was last written */
+static int SetAdvertisingData(AdvSet_t *set, const struct bt_data *ad, size_t ad_len,
+			      const struct bt_data *sd, size_t sd_len)
+{
+	AdvPayload_t *payload = &set->payload;
+	uint32_t hash = PayloadHash(sd, sd_len, PayloadHash(ad, ad_len, 0));
+	int r;
+
+	if (payload->valid && (payload->hash == hash)) {
+		hciStats.skipped += 1;
+		(void)attr_set_uint32(ATTR_ID_advert_updates_skipped, hciStats.skipped);
+		return 0;
+	}
+
+	r = bt_le_ext_adv_set_data(set->adv, ad, ad_len, sd, sd_len);
+	/* Scan response data is a separate command */
+	CountHciCommands((sd_len > 0) ? 2 : 1);
+
+	payload->hash = hash;
+	payload->valid = (r == 0);
+	return r;
+}
+
+static uint32_t PayloadHash(const struct bt_data *data, size_t len, uint32_t crc)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		crc = crc32_ieee_update(crc, &data[i].type, sizeof(data[i].type));
+		crc = crc32_ieee_update(crc, &data[i].data_len, sizeof(data[i].data_len));
+		crc = crc32_ieee_update(crc, data[i].data, data[i].data_len);
+	}
+	return crc;
+}
+
+static void AdvertisingTime(void)
+{
+	int64_t now = k_uptime_get();
+
+	if (advertising) {
+		hciStats.hourMs += now - hciStats.startMs;
+		hciStats.startMs = now;
+	}
+}
+
+/* The per hour count is scaled by the time spent advertising so that time
+ * in shelf mode or in a connection doesn't lower it.
+ */
+static void CountHciCommands(uint32_t count)
+{
+	const int64_t hour = MIN_PER_HOUR * SEC_PER_MIN * MSEC_PER_SEC;
+
+	hciStats.commands += count;
+	hciStats.hourCommands += count;
+
+	AdvertisingTime();
+	if (hciStats.hourMs >= hour) {
+		(void)attr_set_uint32(ATTR_ID_advert_hci_commands_per_hour,
+				      (uint32_t)((hciStats.hourCommands * hour) / hciStats.hourMs));
+		hciStats.hourCommands = 0;
+		hciStats.hourMs = 0;
+	}
+	(void)attr_set_uint32(ATTR_ID_advert_hci_commands, hciStats.commands);
+}
+
+#if defined(CONFIG_ADVERTISEMENT_EVENT_PACKING)
+static void PackEvents(const SensorMsg_t *events, size_t count)
+{
+	int r = EventPack_Encode(packed, sizeof(packed), events, count);
+
+	if (r < 0) {
+		LOG_ERR("Failed to pack events (%d)", r);
+		return;
 	}
+	bt_extAd[ARRAY_SIZE(bt_extAd) - 1].data_len = (uint8_t)r;
 }
+#endif
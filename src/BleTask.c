@@ -31,11 +31,19 @@ LOG_MODULE_REGISTER(BleTask, CONFIG_LOG_LEVEL_BLE_TASK);
 #include "FrameworkIncludes.h"
 #include "lcz_bluetooth.h"
 #include "Advertisement.h"
+#include "AdvertInterval.h"
+#include "PendingEvents.h"
 #include "attr.h"
 #include "BleTask.h"
 #include "EventTask.h"
 #include "attr_custom_validator.h"
 #include "Flags.h"
+#if defined(CONFIG_PERIODIC_ADVERT)
+#include "PeriodicAdvert.h"
+#endif
+#if defined(CONFIG_EVENT_STREAM)
+#include "EventStream.h"
+#endif
 
 #if defined(CONFIG_LCZ_LWM2M_TRANSPORT_BLE_PERIPHERAL)
 #include "lcz_lwm2m_client.h"
@@ -76,6 +84,10 @@ typedef struct BleTaskTag {
 	bool activeModeStatus;
 	bool codedPHYBroadcast;
 	bool conn_from_le_coded;
+	/* Interval chosen by the adaptive controller, 0 when not started */
+	uint32_t advertIntervalMs;
+	/* Uptime of the last alarm event, 0 if there hasn't been one */
+	atomic_t lastAlarmMs;
 } BleTaskObj_t;
 
 /* The Advertising Duration must always be this times greater than the
@@ -83,8 +95,29 @@ typedef struct BleTaskTag {
  */
 #define BLE_TASK_ADV_DUR_SCALE 4
 
-/* This is the size of the queue used to store events locally */
-#define BLE_TASK_ADVERT_QUEUE_SIZE 32
+/* Events drained from the pending store for each advertising duration */
+#if defined(CONFIG_ADVERTISEMENT_EVENT_PACKING)
+#define BLE_TASK_MAX_ADVERT_EVENTS CONFIG_ADVERTISEMENT_PACKED_EVENTS
+#else
+#define BLE_TASK_MAX_ADVERT_EVENTS 1
+#endif
+
+/* These are advertised before any periodic readings */
+#define BLE_TASK_ALARM_EVENTS                                                  \
+	(EVENT_FILTER_FLAGS_TAMPER_SWITCH_EVENT_BITMASK |                      \
+	 EVENT_FILTER_FLAGS_BATTERY_BAD_EVENT_BITMASK |                        \
+	 EVENT_FILTER_FLAGS_DIGITAL_IN1_EVENT_BITMASK |                        \
+	 EVENT_FILTER_FLAGS_DIGITAL_IN2_EVENT_BITMASK)
+
+typedef struct AdvertPending {
+	PendingEvents_t events;
+	/* Copies of the link and active mode state for BleTask_PostEvent,
+	 * which runs on the producer's thread.
+	 */
+	bool connected;
+	bool activeMode;
+	struct k_spinlock lock;
+} AdvertPending_t;
 
 /******************************************************************************/
 /* Local Function Prototypes                                                  */
@@ -106,10 +139,12 @@ static DispatchResult_t BleSensorUpdateMsgHandler(FwkMsgReceiver_t *pMsgRxer,
 						  FwkMsg_t *pMsg);
 static DispatchResult_t SeverConnectionHandler(FwkMsgReceiver_t *pMsgRxer,
 					       FwkMsg_t *pMsg);
-static DispatchResult_t BleSensorEventMsgHandler(FwkMsgReceiver_t *pMsgRxer,
-						 FwkMsg_t *pMsg);
 static DispatchResult_t BleEnterActiveModeMsgHandler(FwkMsgReceiver_t *pMsgRxer,
 						     FwkMsg_t *pMsg);
+static DispatchResult_t BleEnterShelfModeMsgHandler(FwkMsgReceiver_t *pMsgRxer,
+						    FwkMsg_t *pMsg);
+static DispatchResult_t BleConnectedMsgHandler(FwkMsgReceiver_t *pMsgRxer,
+					       FwkMsg_t *pMsg);
 
 static int BluetoothInit(void);
 static int UpdateName(void);
@@ -120,6 +155,10 @@ static void StartDisconnectTimer(void);
 static void ResetAppDisconnectParam(void);
 static void RequestDisconnect(struct bt_conn *ConnectionHandle);
 static uint32_t GetAdvertisingDuration(void);
+static bool AdaptiveAdvertising(void);
+static bool AlarmIsFresh(void);
+static int UpdateAdvertisingInterval(void);
+static void AdaptAdvertisingInterval(bool busy);
 #if defined(CONFIG_LCZ_LWM2M_TRANSPORT_BLE_PERIPHERAL)
 void lwm2m_data_ready_cb(bool data_ready);
 static void lwm2m_client_connected_event(struct lwm2m_ctx *client, int lwm2m_client_index,
@@ -134,6 +173,11 @@ static void EnterActiveModeTimerCallbackIsr(struct k_timer *timer_id);
 static void upgrade_advert_phy_timer_callback_isr(struct k_timer *timer_id);
 static void AppDisconnectCallbackIsr(struct k_timer *timer_id);
 
+static int TakePendingEvent(SensorMsg_t *sensor_event);
+static void PurgePendingEvents(void);
+static void SetPostConnected(bool connected);
+static void SetPostActiveMode(bool activeMode);
+
 static void le_param_updated(struct bt_conn *conn, uint16_t interval,
 			     uint16_t latency, uint16_t timeout);
 static bool le_param_req(struct bt_conn *conn, struct bt_le_conn_param *param);
@@ -172,12 +216,10 @@ static struct fs_mount_t settings_mnt = {
 /* clang-format on */
 #endif
 
-/* This is the local queue used to store an immediate log of events for
- * for advertisements. When full, additional events are still logged to
- * to the file system but discarded from inclusion in advertisements.
+/* Events waiting to be advertised. The footprint is fixed and a stale
+ * reading never delays a newer one.
  */
-K_MSGQ_DEFINE(ble_task_advert_queue, sizeof(SensorMsg_t),
-	      BLE_TASK_ADVERT_QUEUE_SIZE, FWK_QUEUE_ALIGNMENT);
+static AdvertPending_t advertPending;
 
 /* Used to register for callbacks for connection events from the LwM2M
  * service.
@@ -198,9 +240,10 @@ static FwkMsgHandler_t *BleTaskMsgDispatcher(FwkMsgCode_t MsgCode)
 	case FMC_BLE_END_ADVERTISING:     return EndAdvertisingMsgHandler;
 	case FMC_ATTR_CHANGED:            return BleAttrChangedMsgHandler;
 	case FMC_BLE_END_CONNECTION:      return SeverConnectionHandler;
-	case FMC_SENSOR_EVENT:            return BleSensorEventMsgHandler;
 	case FMC_SENSOR_UPDATE:           return BleSensorUpdateMsgHandler;
 	case FMC_ENTER_ACTIVE_MODE:       return BleEnterActiveModeMsgHandler;
+	case FMC_ENTER_SHELF_MODE:        return BleEnterShelfModeMsgHandler;
+	case FMC_BLE_CONNECTED:           return BleConnectedMsgHandler;
 	default:                          return NULL;
 	}
 	/* clang-format on */
@@ -221,6 +264,8 @@ void BleTask_Initialize(void)
 	bto.durationTimeMs = 0;
 	bto.activeModeStatus = false;
 	bto.codedPHYBroadcast = false;
+	bto.advertIntervalMs = 0;
+	atomic_set(&bto.lastAlarmMs, 0);
 	Framework_RegisterTask(&bto.msgTask);
 
 	bto.msgTask.pTid =
@@ -237,6 +282,62 @@ bool ble_is_connected(void)
 	return (bto.conn != NULL ? true : false);
 }
 
+int BleTask_PostEvent(const SensorMsg_t *sensor_event)
+{
+	uint32_t bit = EventTask_FilterBit(sensor_event->event.type);
+	k_spinlock_key_t key;
+	bool connected;
+	bool activeMode;
+	bool idle = false;
+	bool replaced = false;
+
+	/* Only store events when in active mode */
+	key = k_spin_lock(&advertPending.lock);
+	connected = advertPending.connected;
+	activeMode = advertPending.activeMode;
+	if (!connected && activeMode && bit != 0) {
+		idle = (advertPending.events.pending == 0);
+		replaced = PendingEvents_Put(&advertPending.events,
+					     sensor_event, bit);
+	}
+	k_spin_unlock(&advertPending.lock, key);
+
+	if (connected) {
+#if defined(CONFIG_EVENT_STREAM)
+		/* A connected client can subscribe to the event stream */
+		return EventStream_Post(sensor_event);
+#else
+		return -EPERM;
+#endif
+	}
+	if (!activeMode) {
+		return -EPERM;
+	}
+	if (bit == 0) {
+		return -EINVAL;
+	}
+
+	if ((bit & BLE_TASK_ALARM_EVENTS) != 0) {
+		atomic_set(&bto.lastAlarmMs, k_uptime_get_32());
+	}
+
+	if (replaced) {
+		LOG_DBG("Replaced unsent event type %d",
+			sensor_event->event.type);
+	} else {
+		LOG_DBG("Added Event to advert queue!");
+	}
+
+	/* The duration timer drains events that are already pending.
+	 * Only the first event of a burst needs to update the advertisement.
+	 */
+	if (idle) {
+		FRAMEWORK_MSG_CREATE_AND_SEND(FWK_ID_BLE_TASK, FWK_ID_BLE_TASK,
+					      FMC_SENSOR_UPDATE);
+	}
+	return 0;
+}
+
 bool ble_conn_last_was_le_coded(void)
 {
 	return bto.conn_from_le_coded;
@@ -312,7 +413,11 @@ static int BluetoothInit(void)
 			LOG_ERR("Init advertisement error: %d", r);
 			break;
 		}
-		r = Advertisement_IntervalUpdate();
+#if defined(CONFIG_PERIODIC_ADVERT)
+		/* Not fatal, the sample train is optional */
+		(void)PeriodicAdvert_Init();
+#endif
+		r = UpdateAdvertisingInterval();
 		if (r != 0) {
 			LOG_ERR("Advertisment Interval error: %d", r);
 			break;
@@ -358,6 +463,7 @@ static void BleTaskThread(void *pArg1, void *pArg2, void *pArg3)
 		      sizeof(bto.activeModeStatus));
 
 	Flags_Set(FLAG_ACTIVE_MODE, bto.activeModeStatus);
+	SetPostActiveMode(bto.activeModeStatus);
 
 	attr_get(ATTR_ID_advertising_phy, &bto.codedPHYBroadcast,
 		      sizeof(bto.codedPHYBroadcast));
@@ -387,6 +493,12 @@ static void BleTaskThread(void *pArg1, void *pArg2, void *pArg3)
 		Advertisement_Start();
 	}
 
+#if defined(CONFIG_PERIODIC_ADVERT)
+	if (bto.activeModeStatus) {
+		PeriodicAdvert_Start();
+	}
+#endif
+
 	while (true) {
 		Framework_MsgReceiver(&pObj->msgTask.rxer);
 	}
@@ -404,6 +516,12 @@ static DispatchResult_t StartAdvertisingMsgHandler(FwkMsgReceiver_t *pMsgRxer,
 	/* If in Active mode make sure we enable the broadcast PHY */
 	if (bto.activeModeStatus) {
 		Advertisement_ExtendedSet(bto.codedPHYBroadcast);
+#if defined(CONFIG_PERIODIC_ADVERT)
+		/* The train is stopped while a central is connected */
+		if (bto.conn == NULL) {
+			PeriodicAdvert_Start();
+		}
+#endif
 		/* Restart the duration timer */
 		if (bto.durationTimeMs > 0) {
 			k_timer_start(&durationTimer,
@@ -416,7 +534,7 @@ static DispatchResult_t StartAdvertisingMsgHandler(FwkMsgReceiver_t *pMsgRxer,
 		k_timer_start(&bootAdvertTimer,
 			      K_SECONDS(BOOTUP_ADVERTISMENT_TIME_S), K_NO_WAIT);
 	}
-	Advertisement_IntervalUpdate();
+	UpdateAdvertisingInterval();
 	Advertisement_Start();
 
 	return DISPATCH_OK;
@@ -451,7 +569,15 @@ static DispatchResult_t BleAttrChangedMsgHandler(FwkMsgReceiver_t *pMsgRxer,
 			updateData = true;
 			break;
 		case ATTR_ID_advertising_interval:
-			Advertisement_IntervalUpdate();
+		case ATTR_ID_advertising_dual_phy_ratio:
+			UpdateAdvertisingInterval();
+			break;
+		case ATTR_ID_advertising_adaptive:
+		case ATTR_ID_advertising_interval_fast:
+		case ATTR_ID_advertising_interval_idle:
+			/* Restart the controller from the idle interval */
+			bto.advertIntervalMs = 0;
+			UpdateAdvertisingInterval();
 			break;
 		case ATTR_ID_tx_power:
 			TransmitPower();
@@ -489,7 +615,9 @@ static DispatchResult_t BleAttrChangedMsgHandler(FwkMsgReceiver_t *pMsgRxer,
 static DispatchResult_t BleSensorUpdateMsgHandler(FwkMsgReceiver_t *pMsgRxer,
 						  FwkMsg_t *pMsg)
 {
-	SensorMsg_t sensor_event;
+	SensorMsg_t sensor_event[BLE_TASK_MAX_ADVERT_EVENTS];
+	size_t capacity;
+	size_t count = 0;
 	bool restart_duration_timer = false;
 
 	if (bto.activeModeStatus) {
@@ -497,16 +625,23 @@ static DispatchResult_t BleSensorUpdateMsgHandler(FwkMsgReceiver_t *pMsgRxer,
 		volatile uint32_t timerLeft =
 			k_timer_remaining_get(&durationTimer);
 		if (timerLeft == 0) {
-			/* Any events available? */
-			if (k_msgq_num_used_get(&ble_task_advert_queue)) {
-				/* Read the next */
-				k_msgq_get(&ble_task_advert_queue,
-					   &sensor_event, K_FOREVER);
+			/* Take as many events as the advertisement can carry */
+			capacity = MIN(Advertisement_EventCapacity(),
+				       ARRAY_SIZE(sensor_event));
+			while (count < capacity &&
+			       TakePendingEvent(&sensor_event[count]) == 0) {
+				count++;
+			}
+			if (count > 0) {
 				/* Update the advertisement */
-				Advertisement_Update(&sensor_event);
+				Advertisement_UpdateEvents(sensor_event, count);
 			}
+			AdaptAdvertisingInterval((count > 0) || AlarmIsFresh());
 			/* Restart the duration timer */
 			restart_duration_timer = true;
+		} else if (AlarmIsFresh()) {
+			/* Don't wait for the duration to end to speed up */
+			AdaptAdvertisingInterval(true);
 		}
 	}
 	if (restart_duration_timer) {
@@ -527,36 +662,6 @@ static DispatchResult_t SeverConnectionHandler(FwkMsgReceiver_t *pMsgRxer,
 	return DISPATCH_OK;
 }
 
-static DispatchResult_t BleSensorEventMsgHandler(FwkMsgReceiver_t *pMsgRxer,
-						 FwkMsg_t *pMsg)
-{
-	SensorMsg_t local_event;
-	EventLogMsg_t *pEventMsg = (EventLogMsg_t *)pMsg;
-
-	/* Only store events when in active mode and not in a connection */
-	if ((bto.activeModeStatus) && (bto.conn == NULL)) {
-		/* If there's space, add this event to our local advert queue */
-		if (k_msgq_num_free_get(&ble_task_advert_queue)) {
-			/* Store event details */
-			local_event.event.timestamp = pEventMsg->timeStamp;
-			local_event.event.type = pEventMsg->eventType;
-			local_event.event.data = pEventMsg->eventData;
-			local_event.id = pEventMsg->id;
-			/* Set event details in the advert queue */
-			k_msgq_put(&ble_task_advert_queue, &local_event,
-				   K_NO_WAIT);
-			/* And update the advertisement */
-			FRAMEWORK_MSG_CREATE_AND_SEND(FWK_ID_BLE_TASK,
-						      FWK_ID_BLE_TASK,
-						      FMC_SENSOR_UPDATE);
-			LOG_DBG("Added Event to advert queue!");
-		} else {
-			LOG_DBG("Advert queue is full!");
-		}
-	}
-	return DISPATCH_OK;
-}
-
 static DispatchResult_t BleEnterActiveModeMsgHandler(FwkMsgReceiver_t *pMsgRxer,
 						     FwkMsg_t *pMsg)
 {
@@ -564,10 +669,14 @@ static DispatchResult_t BleEnterActiveModeMsgHandler(FwkMsgReceiver_t *pMsgRxer,
 	 * attribute operations, but repeatedly by local user interfaces.
 	 */
 	bto.activeModeStatus = true;
+	SetPostActiveMode(true);
 	/* Is a connection active? If so, advertisement changes are also
 	 * handled in the disconnect callback.
 	 */
 	if (bto.conn == NULL) {
+#if defined(CONFIG_PERIODIC_ADVERT)
+		PeriodicAdvert_Start();
+#endif
 		/* No, so we can go ahead and start advertising in
 		 * 1M. First make sure the boot up timer isn't running
 		 */
@@ -590,9 +699,76 @@ static DispatchResult_t BleEnterActiveModeMsgHandler(FwkMsgReceiver_t *pMsgRxer,
 	return DISPATCH_OK;
 }
 
+static DispatchResult_t BleEnterShelfModeMsgHandler(FwkMsgReceiver_t *pMsgRxer,
+						    FwkMsg_t *pMsg)
+{
+	UNUSED_PARAMETER(pMsg);
+	UNUSED_PARAMETER(pMsgRxer);
+
+	/* The sensor task resets the device to finish entering shelf mode.
+	 * Stop broadcasting events until then.
+	 */
+	bto.activeModeStatus = false;
+	SetPostActiveMode(false);
+	PurgePendingEvents();
+#if defined(CONFIG_PERIODIC_ADVERT)
+	PeriodicAdvert_Stop();
+#endif
+	return DISPATCH_OK;
+}
+
+static DispatchResult_t BleConnectedMsgHandler(FwkMsgReceiver_t *pMsgRxer,
+					       FwkMsg_t *pMsg)
+{
+	UNUSED_PARAMETER(pMsg);
+	UNUSED_PARAMETER(pMsgRxer);
+
+#if defined(CONFIG_PERIODIC_ADVERT)
+	/* Nothing to do if the link has already gone */
+	if (bto.conn != NULL) {
+		PeriodicAdvert_Stop();
+	}
+#endif
+	return DISPATCH_OK;
+}
+
 /******************************************************************************/
 /* Local Function Definitions                                                 */
 /******************************************************************************/
+static int TakePendingEvent(SensorMsg_t *sensor_event)
+{
+	k_spinlock_key_t key = k_spin_lock(&advertPending.lock);
+	int r = PendingEvents_Take(&advertPending.events,
+				   BLE_TASK_ALARM_EVENTS, sensor_event);
+
+	k_spin_unlock(&advertPending.lock, key);
+	return r;
+}
+
+static void PurgePendingEvents(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&advertPending.lock);
+
+	PendingEvents_Purge(&advertPending.events);
+	k_spin_unlock(&advertPending.lock, key);
+}
+
+static void SetPostConnected(bool connected)
+{
+	k_spinlock_key_t key = k_spin_lock(&advertPending.lock);
+
+	advertPending.connected = connected;
+	k_spin_unlock(&advertPending.lock, key);
+}
+
+static void SetPostActiveMode(bool activeMode)
+{
+	k_spinlock_key_t key = k_spin_lock(&advertPending.lock);
+
+	advertPending.activeMode = activeMode;
+	k_spin_unlock(&advertPending.lock, key);
+}
+
 static void ConnectedCallback(struct bt_conn *conn, uint8_t r)
 {
 	char addr[BT_ADDR_LE_STR_LEN];
@@ -606,6 +782,7 @@ static void ConnectedCallback(struct bt_conn *conn, uint8_t r)
 	} else {
 		LOG_INF("Connected: %s", addr);
 		bto.conn = bt_conn_ref(conn);
+		SetPostConnected(true);
 
 		/* Fetch PHY so we know what to advertise in if a firmware
 		 * update takes places to re-allow connectivity
@@ -633,6 +810,14 @@ static void ConnectedCallback(struct bt_conn *conn, uint8_t r)
 		/* Pause the duration timer if it is running */
 		bto.durationTimeMs = k_timer_remaining_get(&durationTimer);
 		k_timer_stop(&durationTimer);
+
+#if defined(CONFIG_PERIODIC_ADVERT)
+		/* Leave the radio to the connection. The train is restarted
+		 * by the disconnect.
+		 */
+		FRAMEWORK_MSG_CREATE_AND_SEND(FWK_ID_BLE_TASK, FWK_ID_BLE_TASK,
+					      FMC_BLE_CONNECTED);
+#endif
 	}
 }
 
@@ -644,13 +829,14 @@ static void DisconnectedCallback(struct bt_conn *conn, uint8_t reason)
 	LOG_INF("Disconnected: %s reason: %s", addr,
 		lbt_get_hci_err_string(reason));
 
-	/* Purge the advertising event queue so out of
+	/* Purge the pending advertising events so out of
 	 * date events are not broadcast.
 	 */
-	k_msgq_purge(&ble_task_advert_queue);
+	PurgePendingEvents();
 
 	bt_conn_unref(bto.conn);
 	bto.conn = NULL;
+	SetPostConnected(false);
 
 	/* Disconnect detected stop force disconnect */
 	k_timer_stop(&mobileAppDisconnectTimer);
@@ -782,6 +968,11 @@ static uint32_t GetAdvertisingDuration(void)
 				  sizeof(advertising_interval)) ==
 		    sizeof(advertising_interval)) {
 			get_failed = false;
+			/* The adaptive interval replaces the configured one */
+			if (AdaptiveAdvertising() &&
+			    (bto.advertIntervalMs > 0)) {
+				advertising_interval = bto.advertIntervalMs;
+			}
 			/* If the Duration is less than BLE_TASK_ADV_DUR_SCALE
 			 * times the Interval, clamp it to that value.
 			 */
@@ -799,6 +990,77 @@ static uint32_t GetAdvertisingDuration(void)
 	return ((uint32_t)(advertising_duration));
 }
 
+static bool AdaptiveAdvertising(void)
+{
+	bool adaptive = false;
+
+	attr_get(ATTR_ID_advertising_adaptive, &adaptive, sizeof(adaptive));
+	return (adaptive && bto.activeModeStatus);
+}
+
+static bool AlarmIsFresh(void)
+{
+	uint32_t last = (uint32_t)atomic_get(&bto.lastAlarmMs);
+	uint16_t hold = 0;
+
+	attr_get(ATTR_ID_advertising_alarm_hold, &hold, sizeof(hold));
+	return ((last != 0) &&
+		((k_uptime_get_32() - last) < (hold * MSEC_PER_SEC)));
+}
+
+/* The adaptive interval replaces advertising_interval when it is enabled */
+static int UpdateAdvertisingInterval(void)
+{
+	uint16_t idle = 0;
+
+	if (!AdaptiveAdvertising()) {
+		return Advertisement_IntervalUpdate();
+	}
+
+	if (bto.advertIntervalMs == 0) {
+		attr_get(ATTR_ID_advertising_interval_idle, &idle,
+			 sizeof(idle));
+		bto.advertIntervalMs = idle;
+	}
+	attr_set_uint32(ATTR_ID_advertising_interval_active,
+			bto.advertIntervalMs);
+	return Advertisement_IntervalSet(bto.advertIntervalMs);
+}
+
+/* Advertise at the fast interval while there is something new to say and
+ * back off towards the idle interval, once per advertising duration, when
+ * there isn't. The growth attribute is the next interval as a percentage
+ * of the previous one, so 200 doubles it.
+ */
+static void AdaptAdvertisingInterval(bool busy)
+{
+	uint16_t fast = 0;
+	uint16_t idle = 0;
+	uint16_t growth = 0;
+	AdvertIntervalConfig_t cfg;
+	uint32_t interval;
+
+	if (!AdaptiveAdvertising()) {
+		return;
+	}
+
+	attr_get(ATTR_ID_advertising_interval_fast, &fast, sizeof(fast));
+	attr_get(ATTR_ID_advertising_interval_idle, &idle, sizeof(idle));
+	attr_get(ATTR_ID_advertising_interval_growth, &growth, sizeof(growth));
+	cfg.fast = fast;
+	cfg.idle = idle;
+	cfg.growth = growth;
+
+	interval = AdvertInterval_Next(bto.advertIntervalMs, busy, &cfg);
+
+	if (interval != bto.advertIntervalMs) {
+		LOG_DBG("Adaptive advertising interval %u ms", interval);
+		bto.advertIntervalMs = interval;
+		attr_set_uint32(ATTR_ID_advertising_interval_active, interval);
+		(void)Advertisement_IntervalSet(interval);
+	}
+}
+
 #if defined(CONFIG_LCZ_LWM2M_TRANSPORT_BLE_PERIPHERAL)
 void lwm2m_data_ready_cb(bool data_ready)
 {
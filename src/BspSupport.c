@@ -26,6 +26,7 @@ LOG_MODULE_REGISTER(BspSupport, CONFIG_BSP_LOG_LEVEL);
 #include "BspSupport.h"
 #include "attr.h"
 #include "attr_table.h"
+#include "attr_custom_validator.h"
 #include "BleTask.h"
 
 /******************************************************************************/
@@ -453,6 +454,7 @@ static void SendDigitalInputStatus(uint16_t pin, uint8_t status)
 		pMsgSend->header.rxId = FWK_ID_SENSOR_TASK;
 		pMsgSend->status = status;
 		pMsgSend->pin = pin;
+		pMsgSend->timestamp = k_uptime_get();
 		FRAMEWORK_MSG_SEND(pMsgSend);
 	}
 }
@@ -635,7 +637,8 @@ static bool MagSwitchIsSimulated(int *simulated_value)
 	/* First check we can read back the simulation enabled state and
 	 * that it's enabled.
 	 */
-	if (attr_get(ATTR_ID_mag_switch_simulated, &simulation_enabled,
+	if (attr_simulation_maybe_active(ATTR_ID_mag_switch_simulated) &&
+	    attr_get(ATTR_ID_mag_switch_simulated, &simulation_enabled,
 		     sizeof(simulation_enabled)) ==
 	    sizeof(simulation_enabled)) {
 		if (simulation_enabled) {
@@ -669,7 +672,8 @@ static bool TamperSwitchIsSimulated(int *simulated_value)
 	/* First check we can read back the simulation enabled state and
 	 * that it's enabled.
 	 */
-	if (attr_get(ATTR_ID_tamper_switch_simulated, &simulation_enabled,
+	if (attr_simulation_maybe_active(ATTR_ID_tamper_switch_simulated) &&
+	    attr_get(ATTR_ID_tamper_switch_simulated, &simulation_enabled,
 		     sizeof(simulation_enabled)) ==
 	    sizeof(simulation_enabled)) {
 		if (simulation_enabled) {
@@ -697,7 +701,8 @@ static bool DigitalInput1IsSimulated(int *simulated_value)
 	/* First check we can read back the simulation enabled state and
 	 * that it's enabled.
 	 */
-	if (attr_get(ATTR_ID_digital_input_1_simulated, &simulation_enabled,
+	if (attr_simulation_maybe_active(ATTR_ID_digital_input_1_simulated) &&
+	    attr_get(ATTR_ID_digital_input_1_simulated, &simulation_enabled,
 		     sizeof(simulation_enabled)) ==
 	    sizeof(simulation_enabled)) {
 		if (simulation_enabled) {
@@ -722,7 +727,8 @@ static bool DigitalInput2IsSimulated(int *simulated_value)
 	bool simulation_enabled = false;
 	bool simulated_input_state;
 
-	if (attr_get(ATTR_ID_digital_input_2_simulated, &simulation_enabled,
+	if (attr_simulation_maybe_active(ATTR_ID_digital_input_2_simulated) &&
+	    attr_get(ATTR_ID_digital_input_2_simulated, &simulation_enabled,
 		     sizeof(simulation_enabled)) ==
 	    sizeof(simulation_enabled)) {
 		if (simulation_enabled) {
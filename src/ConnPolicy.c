@@ -0,0 +1,402 @@
+/**
+ * @file ConnPolicy.c
+ * @brief Connection parameters that follow mcumgr image and file traffic
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(ConnPolicy, CONFIG_CONN_POLICY_LOG_LEVEL);
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr.h>
+#include <bluetooth/bluetooth.h>
+#include <bluetooth/conn.h>
+#include <bluetooth/gatt.h>
+#include <bluetooth/hci.h>
+#include <bluetooth/uuid.h>
+
+#include "attr.h"
+#include "ConnPolicy.h"
+
+/**************************************************************************************************/
+/* Local Constant, Macro and Type Definitions                                                     */
+/**************************************************************************************************/
+typedef struct {
+	bt_addr_le_t addr[CONFIG_CONN_POLICY_BLACKLIST_SIZE];
+	size_t count;
+	/* Entry replaced when the list is full */
+	size_t next;
+} Blacklist_t;
+
+typedef struct {
+	struct bt_conn *conn;
+	bool coded;
+	bool bulk;
+	/* A data length update has been requested and not completed */
+	bool dlePending;
+	uint32_t startMs;
+	uint32_t lastMs;
+	uint32_t bytes;
+	Blacklist_t blacklist;
+	struct k_spinlock lock;
+} ConnPolicy_t;
+
+/**************************************************************************************************/
+/* Local Function Prototypes                                                                      */
+/**************************************************************************************************/
+static void PolicyConnected(struct bt_conn *conn, uint8_t err);
+static void PolicyDisconnected(struct bt_conn *conn, uint8_t reason);
+static void PolicyParamUpdated(struct bt_conn *conn, uint16_t interval, uint16_t latency,
+			       uint16_t timeout);
+static void PolicyPhyUpdated(struct bt_conn *conn, struct bt_conn_le_phy_info *param);
+static void PolicyDataLenUpdated(struct bt_conn *conn, struct bt_conn_le_data_len_info *info);
+static void BulkWorkHandler(struct k_work *item);
+static void IdleWorkHandler(struct k_work *item);
+static struct bt_conn *GetConn(void);
+static bool SmpSubscribed(struct bt_conn *conn);
+static void RequestDataLength(struct bt_conn *conn);
+static bool DataLengthAllowed(struct bt_conn *conn);
+static bool Blacklisted(const bt_addr_le_t *addr);
+static void BlacklistAdd(const bt_addr_le_t *addr);
+
+/**************************************************************************************************/
+/* Local Data Definitions                                                                         */
+/**************************************************************************************************/
+static const struct bt_le_conn_param bulk_param =
+	BT_LE_CONN_PARAM_INIT(CONFIG_CONN_POLICY_BULK_INTERVAL_MIN,
+			      CONFIG_CONN_POLICY_BULK_INTERVAL_MAX, 0, CONFIG_CONN_POLICY_TIMEOUT);
+
+static const struct bt_le_conn_param idle_param =
+	BT_LE_CONN_PARAM_INIT(CONFIG_CONN_POLICY_IDLE_INTERVAL_MIN,
+			      CONFIG_CONN_POLICY_IDLE_INTERVAL_MAX, CONFIG_CONN_POLICY_IDLE_LATENCY,
+			      CONFIG_CONN_POLICY_TIMEOUT);
+
+/* Characteristic of the mcumgr Bluetooth transport */
+static struct bt_uuid_128 smp_char_uuid = BT_UUID_INIT_128(
+	BT_UUID_128_ENCODE(0xda2e7828, 0xfbce, 0x4e01, 0xae9e, 0x261174997c48));
+
+static ConnPolicy_t policy;
+
+static K_WORK_DEFINE(bulk_work, BulkWorkHandler);
+static K_WORK_DELAYABLE_DEFINE(idle_work, IdleWorkHandler);
+
+/* NOTE these have to reside in RAM due to there being a next pointer in the
+ * structure for appending further list entries.
+ */
+static struct bt_conn_cb policy_connection_callbacks = {
+	.connected = PolicyConnected,
+	.disconnected = PolicyDisconnected,
+	.le_param_updated = PolicyParamUpdated,
+	.le_phy_updated = PolicyPhyUpdated,
+	.le_data_len_updated = PolicyDataLenUpdated,
+};
+
+/**************************************************************************************************/
+/* Global Function Definitions                                                                    */
+/**************************************************************************************************/
+void ConnPolicy_Activity(size_t bytes)
+{
+	struct bt_conn *conn = GetConn();
+	uint32_t now = k_uptime_get_32();
+	bool start = false;
+	k_spinlock_key_t key;
+	bool smp;
+
+	/* Traffic over the shell transport doesn't change anything. The link
+	 * only carries SMP when the client has subscribed to the responses.
+	 */
+	if (conn == NULL) {
+		return;
+	}
+	smp = SmpSubscribed(conn);
+	bt_conn_unref(conn);
+	if (!smp) {
+		return;
+	}
+
+	key = k_spin_lock(&policy.lock);
+	if (policy.conn == NULL) {
+		k_spin_unlock(&policy.lock, key);
+		return;
+	}
+
+	if (!policy.bulk) {
+		policy.bulk = true;
+		policy.startMs = now;
+		policy.bytes = 0;
+		start = true;
+	}
+	policy.bytes += bytes;
+	policy.lastMs = now;
+	k_spin_unlock(&policy.lock, key);
+
+	if (start) {
+		k_work_submit(&bulk_work);
+	}
+	k_work_reschedule(&idle_work, K_MSEC(CONFIG_CONN_POLICY_IDLE_MS));
+}
+
+/**************************************************************************************************/
+/* Local Function Definitions                                                                     */
+/**************************************************************************************************/
+static int ConnPolicyInit(const struct device *device)
+{
+	ARG_UNUSED(device);
+
+	bt_conn_cb_register(&policy_connection_callbacks);
+	return 0;
+}
+
+SYS_INIT(ConnPolicyInit, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
+
+static void PolicyConnected(struct bt_conn *conn, uint8_t err)
+{
+	struct bt_conn_info info;
+	k_spinlock_key_t key;
+
+	if (err != 0) {
+		return;
+	}
+
+	key = k_spin_lock(&policy.lock);
+	if (policy.conn == NULL) {
+		policy.conn = bt_conn_ref(conn);
+		policy.coded = ((bt_conn_get_info(conn, &info) == 0) &&
+				(info.le.phy->tx_phy == BT_GAP_LE_PHY_CODED));
+		policy.bulk = false;
+		policy.dlePending = false;
+	}
+	k_spin_unlock(&policy.lock, key);
+}
+
+static void PolicyDisconnected(struct bt_conn *conn, uint8_t reason)
+{
+	k_spinlock_key_t key = k_spin_lock(&policy.lock);
+	bool lost;
+
+	if (conn != policy.conn) {
+		k_spin_unlock(&policy.lock, key);
+		return;
+	}
+
+	/* Peers affected by Bug #19725 drop the link instead of answering the
+	 * data length update.
+	 */
+	lost = policy.dlePending && (reason != BT_HCI_ERR_REMOTE_USER_TERM_CONN) &&
+	       (reason != BT_HCI_ERR_LOCALHOST_TERM_CONN);
+	policy.dlePending = false;
+	policy.bulk = false;
+	policy.conn = NULL;
+	k_spin_unlock(&policy.lock, key);
+
+	if (lost) {
+		LOG_WRN("Link lost during data length update");
+		BlacklistAdd(bt_conn_get_dst(conn));
+	}
+
+	(void)k_work_cancel_delayable(&idle_work);
+	bt_conn_unref(conn);
+}
+
+static void PolicyParamUpdated(struct bt_conn *conn, uint16_t interval, uint16_t latency,
+			       uint16_t timeout)
+{
+	LOG_DBG("Interval %u.%02u ms latency %u timeout %u ms", (interval * 5) / 4,
+		((interval * 5) % 4) * 25, latency, timeout * 10);
+}
+
+static void PolicyPhyUpdated(struct bt_conn *conn, struct bt_conn_le_phy_info *param)
+{
+	k_spinlock_key_t key = k_spin_lock(&policy.lock);
+
+	if (conn == policy.conn) {
+		policy.coded = (param->tx_phy == BT_GAP_LE_PHY_CODED);
+	}
+	k_spin_unlock(&policy.lock, key);
+
+	LOG_DBG("PHY tx %u rx %u", param->tx_phy, param->rx_phy);
+}
+
+static void PolicyDataLenUpdated(struct bt_conn *conn, struct bt_conn_le_data_len_info *info)
+{
+	k_spinlock_key_t key = k_spin_lock(&policy.lock);
+
+	if (conn == policy.conn) {
+		policy.dlePending = false;
+	}
+	k_spin_unlock(&policy.lock, key);
+
+	LOG_DBG("Data length tx %u rx %u", info->tx_max_len, info->rx_max_len);
+}
+
+static void BulkWorkHandler(struct k_work *item)
+{
+	struct bt_conn *conn = GetConn();
+	int r;
+
+	if (conn == NULL) {
+		return;
+	}
+
+	r = bt_conn_le_param_update(conn, &bulk_param);
+	if (r < 0) {
+		LOG_ERR("Failed to request transfer connection parameters (%d)", r);
+	}
+
+	/* Changing from the coded PHY would lose the range the link needs */
+	if (!policy.coded) {
+		r = bt_conn_le_phy_update(conn, BT_CONN_LE_PHY_PARAM_2M);
+		if (r < 0) {
+			LOG_ERR("Failed to request 2M PHY (%d)", r);
+		}
+	}
+
+	RequestDataLength(conn);
+	bt_conn_unref(conn);
+}
+
+static void IdleWorkHandler(struct k_work *item)
+{
+	k_spinlock_key_t key = k_spin_lock(&policy.lock);
+	uint32_t elapsed = policy.lastMs - policy.startMs;
+	uint32_t bytes = policy.bytes;
+	struct bt_conn *conn = NULL;
+	int r;
+
+	if (policy.conn != NULL) {
+		conn = bt_conn_ref(policy.conn);
+	}
+	policy.bulk = false;
+	k_spin_unlock(&policy.lock, key);
+
+	/* The first chunk starts the clock, so a single chunk has no rate */
+	if ((bytes > 0) && (elapsed > 0)) {
+		(void)attr_set_uint32(ATTR_ID_conn_policy_throughput,
+				      (uint32_t)(((uint64_t)bytes * MSEC_PER_SEC) / elapsed));
+	}
+
+	if (conn == NULL) {
+		return;
+	}
+
+	r = bt_conn_le_param_update(conn, &idle_param);
+	if (r < 0) {
+		LOG_ERR("Failed to request idle connection parameters (%d)", r);
+	}
+	bt_conn_unref(conn);
+}
+
+static struct bt_conn *GetConn(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&policy.lock);
+	struct bt_conn *conn = NULL;
+
+	if (policy.conn != NULL) {
+		conn = bt_conn_ref(policy.conn);
+	}
+	k_spin_unlock(&policy.lock, key);
+
+	return conn;
+}
+
+static bool SmpSubscribed(struct bt_conn *conn)
+{
+	static const struct bt_gatt_attr *smp_attr;
+
+	if (smp_attr == NULL) {
+		smp_attr = bt_gatt_find_by_uuid(NULL, 0, &smp_char_uuid.uuid);
+	}
+	return (smp_attr != NULL) && bt_gatt_is_subscribed(conn, smp_attr, BT_GATT_CCC_NOTIFY);
+}
+
+static void RequestDataLength(struct bt_conn *conn)
+{
+	k_spinlock_key_t key;
+	int r;
+
+	if (!DataLengthAllowed(conn)) {
+		return;
+	}
+
+	key = k_spin_lock(&policy.lock);
+	policy.dlePending = true;
+	k_spin_unlock(&policy.lock, key);
+
+	r = bt_conn_le_data_len_update(conn, BT_LE_DATA_LEN_PARAM_MAX);
+	if (r < 0) {
+		LOG_ERR("Failed to request maximum data length (%d)", r);
+		key = k_spin_lock(&policy.lock);
+		policy.dlePending = false;
+		k_spin_unlock(&policy.lock, key);
+		BlacklistAdd(bt_conn_get_dst(conn));
+	}
+}
+
+/* Data length updates are only requested from peers that have reported a link
+ * layer version of 4.2 or later.
+ */
+static bool DataLengthAllowed(struct bt_conn *conn)
+{
+	struct bt_conn_remote_info info;
+	int r;
+
+	if (Blacklisted(bt_conn_get_dst(conn))) {
+		return false;
+	}
+
+	r = bt_conn_get_remote_info(conn, &info);
+	if (r < 0) {
+		LOG_DBG("Remote version not available (%d)", r);
+		return false;
+	}
+
+	if (info.version < BT_HCI_VERSION_4_2) {
+		BlacklistAdd(bt_conn_get_dst(conn));
+		return false;
+	}
+	return true;
+}
+
+static bool Blacklisted(const bt_addr_le_t *addr)
+{
+	k_spinlock_key_t key = k_spin_lock(&policy.lock);
+	bool found = false;
+	size_t i;
+
+	for (i = 0; i < policy.blacklist.count; i++) {
+		if (bt_addr_le_cmp(addr, &policy.blacklist.addr[i]) == 0) {
+			found = true;
+			break;
+		}
+	}
+	k_spin_unlock(&policy.lock, key);
+
+	return found;
+}
+
+static void BlacklistAdd(const bt_addr_le_t *addr)
+{
+	char str[BT_ADDR_LE_STR_LEN];
+	k_spinlock_key_t key;
+	uint32_t count;
+
+	if (Blacklisted(addr)) {
+		return;
+	}
+
+	key = k_spin_lock(&policy.lock);
+	bt_addr_le_copy(&policy.blacklist.addr[policy.blacklist.next], addr);
+	policy.blacklist.next = (policy.blacklist.next + 1) % CONFIG_CONN_POLICY_BLACKLIST_SIZE;
+	policy.blacklist.count = MIN(policy.blacklist.count + 1, CONFIG_CONN_POLICY_BLACKLIST_SIZE);
+	count = policy.blacklist.count;
+	k_spin_unlock(&policy.lock, key);
+
+	bt_addr_le_to_str(addr, str, sizeof(str));
+	LOG_WRN("Data length updates disabled for %s", str);
+	(void)attr_set_uint32(ATTR_ID_conn_policy_dle_blacklisted, count);
+}
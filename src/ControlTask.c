@@ -45,6 +45,10 @@ LOG_MODULE_REGISTER(ControlTask, CONFIG_CONTROL_TASK_LOG_LEVEL);
 #include "FileAccess.h"
 #endif
 
+#ifdef CONFIG_CONN_POLICY
+#include "ConnPolicy.h"
+#endif
+
 /******************************************************************************/
 // Local Constant, Macro and Type Definitions
 /******************************************************************************/
@@ -398,6 +402,14 @@ static DispatchResult_t SoftwareResetMsgHandler(FwkMsgReceiver_t *pMsgRxer, FwkM
 
 static void mcumgr_mgmt_callback(uint8_t opcode, uint16_t group, uint8_t id, void *arg)
 {
+#if defined(CONFIG_CONN_POLICY)
+	/* Image and file commands move bulk data over the connection */
+	if (opcode == MGMT_EVT_OP_CMD_RECV &&
+	    (group == MGMT_GROUP_ID_IMAGE || group == MGMT_GROUP_ID_FS)) {
+		ConnPolicy_Activity(0);
+	}
+#endif
+
 	/* We are only interested in the firmware upload complete event, skip
 	 * all others
 	 */
@@ -428,6 +440,11 @@ static int upload_start_check(const struct img_mgmt_upload_req req,
 	bool downgrade_blocked = false;
 	const struct image_header *hdr = (struct image_header *)req.img_data.value;
 
+#if defined(CONFIG_CONN_POLICY)
+	/* Only image chunks give the amount of data for the throughput */
+	ConnPolicy_Activity(req.img_data.len);
+#endif
+
 	/* Only check the first chunk */
 	if (req.off == 0) {
 #if defined(CONFIG_MINIMUM_FIRMWARE_VERSION_FOTA_CHECK)
@@ -0,0 +1,62 @@
+/**
+ * @file EventPack.c
+ * @brief Several sensor events packed into one advertising record
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr.h>
+#include <sys/byteorder.h>
+
+#include "lcz_sensor_adv_format.h"
+#include "EventPack.h"
+
+/**************************************************************************************************/
+/* Global Function Definitions                                                                    */
+/**************************************************************************************************/
+int EventPack_Encode(uint8_t *buf, size_t size, const SensorMsg_t *events, size_t count)
+{
+	uint32_t newest = 0;
+	uint32_t delta;
+	uint8_t *p = buf;
+	size_t i;
+
+	if (count > UINT8_MAX) {
+		return -EINVAL;
+	}
+	if (size < EVENT_PACK_SIZE(count)) {
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < count; i++) {
+		newest = MAX(newest, events[i].event.timestamp);
+	}
+
+	sys_put_le16(LAIRD_CONNECTIVITY_MANUFACTURER_SPECIFIC_COMPANY_ID1, p);
+	p += sizeof(uint16_t);
+	sys_put_le16(EVENT_PACK_PROTOCOL_ID, p);
+	p += sizeof(uint16_t);
+	*p++ = EVENT_PACK_VERSION;
+	*p++ = (uint8_t)count;
+	sys_put_le32(newest, p);
+	p += sizeof(uint32_t);
+
+	for (i = 0; i < count; i++) {
+		delta = newest - events[i].event.timestamp;
+
+		*p++ = (uint8_t)events[i].event.type;
+		sys_put_le16((uint16_t)MIN(delta, UINT16_MAX), p);
+		p += sizeof(uint16_t);
+		sys_put_le16((uint16_t)events[i].id, p);
+		p += sizeof(uint16_t);
+		sys_put_le32(events[i].event.data.u32, p);
+		p += sizeof(uint32_t);
+	}
+
+	return (int)(p - buf);
+}
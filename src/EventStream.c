@@ -0,0 +1,350 @@
+/**
+ * @file EventStream.c
+ * @brief GATT service that streams sensor events to a connected client
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(EventStream, CONFIG_EVENT_STREAM_LOG_LEVEL);
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr.h>
+#include <bluetooth/bluetooth.h>
+#include <bluetooth/conn.h>
+#include <bluetooth/gatt.h>
+#include <bluetooth/uuid.h>
+#include <sys/byteorder.h>
+#include <string.h>
+
+#include "attr.h"
+#include "EventStream.h"
+
+/**************************************************************************************************/
+/* Local Constant, Macro and Type Definitions                                                     */
+/**************************************************************************************************/
+/* The ATT notification header is an opcode and a handle */
+#define ATT_NOTIFY_HEADER_SIZE 3
+#define EVENT_STREAM_MAX_PAYLOAD (CONFIG_BT_L2CAP_TX_MTU - ATT_NOTIFY_HEADER_SIZE)
+
+typedef struct {
+	SensorMsg_t event;
+	/* Uptime when the event was queued, for the latency measurement */
+	uint32_t queuedMs;
+} StreamEntry_t;
+
+/* A packet that has been taken from the queue but not yet sent */
+typedef struct {
+	uint8_t data[EVENT_STREAM_MAX_PAYLOAD];
+	size_t len;
+	size_t records;
+	/* Queue time of the first record */
+	uint32_t oldest;
+} StreamPacket_t;
+
+typedef struct {
+	/* Written by the connection callbacks, read with a reference taken
+	 * under the lock.
+	 */
+	struct bt_conn *conn;
+	struct k_spinlock lock;
+	bool notify;
+	/* Only used by the send work. A packet that couldn't get a TX buffer is
+	 * kept here and sent again.
+	 */
+	StreamPacket_t packet;
+	atomic_t inFlight;
+	atomic_t notifications;
+	atomic_t dropped;
+	atomic_t latency;
+} EventStream_t;
+
+/**************************************************************************************************/
+/* Local Function Prototypes                                                                      */
+/**************************************************************************************************/
+static void StreamConnected(struct bt_conn *conn, uint8_t err);
+static void StreamDisconnected(struct bt_conn *conn, uint8_t reason);
+static void CccChanged(const struct bt_gatt_attr *attr, uint16_t value);
+static void NotifySent(struct bt_conn *conn, void *user_data);
+static void SendWorkHandler(struct k_work *item);
+static void BuildPacket(size_t max);
+static int SendPacket(struct bt_conn *conn);
+static void DropPacket(void);
+static size_t EncodeRecord(uint8_t *buf, const SensorMsg_t *event);
+static struct bt_conn *StreamConnRef(void);
+static size_t RecordsPerPacket(struct bt_conn *conn);
+static void UpdateStats(void);
+
+/**************************************************************************************************/
+/* Local Data Definitions                                                                         */
+/**************************************************************************************************/
+static struct bt_uuid_128 event_stream_uuid = BT_UUID_INIT_128(
+	BT_UUID_128_ENCODE(0x6a1e0001, 0x4f8b, 0x4c5b, 0x9a2e, 0x3b7d5f0c9e21));
+static struct bt_uuid_128 event_stream_data_uuid = BT_UUID_INIT_128(
+	BT_UUID_128_ENCODE(0x6a1e0002, 0x4f8b, 0x4c5b, 0x9a2e, 0x3b7d5f0c9e21));
+
+BT_GATT_SERVICE_DEFINE(event_stream_svc, BT_GATT_PRIMARY_SERVICE(&event_stream_uuid),
+		       BT_GATT_CHARACTERISTIC(&event_stream_data_uuid.uuid, BT_GATT_CHRC_NOTIFY,
+					      BT_GATT_PERM_NONE, NULL, NULL, NULL),
+		       BT_GATT_CCC(CccChanged, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE_ENCRYPT), );
+
+K_MSGQ_DEFINE(event_stream_queue, sizeof(StreamEntry_t), CONFIG_EVENT_STREAM_QUEUE_DEPTH, 4);
+
+static EventStream_t stream;
+
+static K_WORK_DELAYABLE_DEFINE(send_work, SendWorkHandler);
+
+/* NOTE these have to reside in RAM due to there being a next pointer in the
+ * structure for appending further list entries.
+ */
+static struct bt_conn_cb stream_connection_callbacks = {
+	.connected = StreamConnected,
+	.disconnected = StreamDisconnected,
+};
+
+/**************************************************************************************************/
+/* Global Function Definitions                                                                    */
+/**************************************************************************************************/
+int EventStream_Post(const SensorMsg_t *sensor_event)
+{
+	StreamEntry_t entry;
+	struct bt_conn *conn;
+	size_t max;
+
+	if (!stream.notify) {
+		return -EPERM;
+	}
+
+	entry.event = *sensor_event;
+	entry.queuedMs = k_uptime_get_32();
+	if (k_msgq_put(&event_stream_queue, &entry, K_NO_WAIT) != 0) {
+		atomic_inc(&stream.dropped);
+		return -ENOMEM;
+	}
+
+	conn = StreamConnRef();
+	max = RecordsPerPacket(conn);
+	if (conn != NULL) {
+		bt_conn_unref(conn);
+	}
+
+	/* Send straight away once a packet is full, otherwise wait for more */
+	if (k_msgq_num_used_get(&event_stream_queue) >= max) {
+		k_work_reschedule(&send_work, K_NO_WAIT);
+	} else {
+		k_work_schedule(&send_work, K_MSEC(CONFIG_EVENT_STREAM_BATCH_MS));
+	}
+	return 0;
+}
+
+/**************************************************************************************************/
+/* Local Function Definitions                                                                     */
+/**************************************************************************************************/
+static int EventStreamInit(const struct device *device)
+{
+	ARG_UNUSED(device);
+
+	bt_conn_cb_register(&stream_connection_callbacks);
+	return 0;
+}
+
+SYS_INIT(EventStreamInit, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
+
+static void StreamConnected(struct bt_conn *conn, uint8_t err)
+{
+	k_spinlock_key_t key;
+
+	if (err == 0) {
+		key = k_spin_lock(&stream.lock);
+		if (stream.conn == NULL) {
+			stream.conn = bt_conn_ref(conn);
+		}
+		k_spin_unlock(&stream.lock, key);
+	}
+}
+
+static void StreamDisconnected(struct bt_conn *conn, uint8_t reason)
+{
+	k_spinlock_key_t key = k_spin_lock(&stream.lock);
+	struct bt_conn *old = NULL;
+
+	if (conn == stream.conn) {
+		old = stream.conn;
+		stream.conn = NULL;
+	}
+	k_spin_unlock(&stream.lock, key);
+
+	if (old != NULL) {
+		stream.notify = false;
+		/* The send work and EventStream_Post() hold their own reference
+		 * while they use the link.
+		 */
+		bt_conn_unref(old);
+		/* Sent callbacks aren't called for a link that has gone */
+		atomic_set(&stream.inFlight, 0);
+		k_work_reschedule(&send_work, K_NO_WAIT);
+	}
+}
+
+static void CccChanged(const struct bt_gatt_attr *attr, uint16_t value)
+{
+	stream.notify = (value == BT_GATT_CCC_NOTIFY);
+	LOG_DBG("Event stream notifications %s", stream.notify ? "enabled" : "disabled");
+}
+
+/* Runs when the stack has sent the notification. This is the flow control,
+ * so that the next packet is built from the events available at that time.
+ */
+static void NotifySent(struct bt_conn *conn, void *user_data)
+{
+	atomic_dec(&stream.inFlight);
+	atomic_inc(&stream.notifications);
+	atomic_set(&stream.latency, k_uptime_get_32() - POINTER_TO_UINT(user_data));
+
+	k_work_reschedule(&send_work, K_NO_WAIT);
+}
+
+static void SendWorkHandler(struct k_work *item)
+{
+	struct bt_conn *conn = StreamConnRef();
+	size_t max = RecordsPerPacket(conn);
+	StreamEntry_t oldest;
+	uint32_t waited;
+
+	if ((conn == NULL) || !stream.notify) {
+		DropPacket();
+		k_msgq_purge(&event_stream_queue);
+		UpdateStats();
+		if (conn != NULL) {
+			bt_conn_unref(conn);
+		}
+		return;
+	}
+
+	while (atomic_get(&stream.inFlight) < CONFIG_EVENT_STREAM_MAX_IN_FLIGHT) {
+		if (stream.packet.records == 0) {
+			if (k_msgq_peek(&event_stream_queue, &oldest) != 0) {
+				break;
+			}
+			/* A partial packet waits for the batch time to fill */
+			waited = k_uptime_get_32() - oldest.queuedMs;
+			if ((k_msgq_num_used_get(&event_stream_queue) < max) &&
+			    (waited < CONFIG_EVENT_STREAM_BATCH_MS)) {
+				k_work_schedule(&send_work,
+						K_MSEC(CONFIG_EVENT_STREAM_BATCH_MS - waited));
+				break;
+			}
+			BuildPacket(max);
+		}
+		if (SendPacket(conn) < 0) {
+			break;
+		}
+	}
+	UpdateStats();
+	bt_conn_unref(conn);
+}
+
+static void BuildPacket(size_t max)
+{
+	StreamPacket_t *packet = &stream.packet;
+	StreamEntry_t entry;
+
+	packet->len = 0;
+	packet->records = 0;
+	while ((packet->records < max) &&
+	       (k_msgq_get(&event_stream_queue, &entry, K_NO_WAIT) == 0)) {
+		if (packet->records == 0) {
+			packet->oldest = entry.queuedMs;
+		}
+		packet->len += EncodeRecord(&packet->data[packet->len], &entry.event);
+		packet->records += 1;
+	}
+}
+
+static int SendPacket(struct bt_conn *conn)
+{
+	StreamPacket_t *packet = &stream.packet;
+	struct bt_gatt_notify_params params;
+	int r;
+
+	memset(&params, 0, sizeof(params));
+	params.attr = &event_stream_svc.attrs[1];
+	params.data = packet->data;
+	params.len = packet->len;
+	params.func = NotifySent;
+	params.user_data = UINT_TO_POINTER(packet->oldest);
+
+	atomic_inc(&stream.inFlight);
+	r = bt_gatt_notify_cb(conn, &params);
+	if (r == -ENOMEM) {
+		/* No TX buffer. The packet is kept and sent again when a
+		 * notification has been sent, or after the batch time if none
+		 * are in flight.
+		 */
+		if (atomic_dec(&stream.inFlight) == 1) {
+			k_work_schedule(&send_work, K_MSEC(CONFIG_EVENT_STREAM_BATCH_MS));
+		}
+		LOG_DBG("No buffer for %d events", (int)packet->records);
+	} else if (r < 0) {
+		atomic_dec(&stream.inFlight);
+		LOG_ERR("Failed to notify %d events (%d)", (int)packet->records, r);
+		DropPacket();
+	} else {
+		packet->records = 0;
+		packet->len = 0;
+	}
+	return r;
+}
+
+static void DropPacket(void)
+{
+	atomic_add(&stream.dropped, stream.packet.records);
+	stream.packet.records = 0;
+	stream.packet.len = 0;
+}
+
+static size_t EncodeRecord(uint8_t *buf, const SensorMsg_t *event)
+{
+	buf[0] = (uint8_t)event->event.type;
+	sys_put_le32(event->id, &buf[1]);
+	sys_put_le32(event->event.timestamp, &buf[5]);
+	sys_put_le32(event->event.data.u32, &buf[9]);
+
+	return EVENT_STREAM_RECORD_SIZE;
+}
+
+/* The caller must unref the connection */
+static struct bt_conn *StreamConnRef(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&stream.lock);
+	struct bt_conn *conn = NULL;
+
+	if (stream.conn != NULL) {
+		conn = bt_conn_ref(stream.conn);
+	}
+	k_spin_unlock(&stream.lock, key);
+
+	return conn;
+}
+
+static size_t RecordsPerPacket(struct bt_conn *conn)
+{
+	size_t payload = EVENT_STREAM_MAX_PAYLOAD;
+
+	if (conn != NULL) {
+		payload = MIN(payload, bt_gatt_get_mtu(conn) - ATT_NOTIFY_HEADER_SIZE);
+	}
+	return MAX(payload / EVENT_STREAM_RECORD_SIZE, 1);
+}
+
+static void UpdateStats(void)
+{
+	(void)attr_set_uint32(ATTR_ID_event_stream_notifications,
+			      (uint32_t)atomic_get(&stream.notifications));
+	(void)attr_set_uint32(ATTR_ID_event_stream_dropped, (uint32_t)atomic_get(&stream.dropped));
+	(void)attr_set_uint32(ATTR_ID_event_stream_latency, (uint32_t)atomic_get(&stream.latency));
+}
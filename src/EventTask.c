@@ -16,15 +16,20 @@ LOG_MODULE_REGISTER(EventTask, CONFIG_EVENT_TASK_LOG_LEVEL);
 /**************************************************************************************************/
 #include <zephyr.h>
 #include <device.h>
+#include <string.h>
 
 #include "FrameworkIncludes.h"
 #include "EventTask.h"
 #include "attr.h"
 #include "Advertisement.h"
+#include "BleTask.h"
 #include "lcz_sensor_event.h"
 #include "lcz_event_manager.h"
 #include "attr_table.h"
 #include "lcz_qrtc.h"
+#if defined(CONFIG_PERIODIC_ADVERT)
+#include "PeriodicAdvert.h"
+#endif
 
 /**************************************************************************************************/
 /* Local Constant, Macro and Type Definitions                                                     */
@@ -41,8 +46,53 @@ LOG_MODULE_REGISTER(EventTask, CONFIG_EVENT_TASK_LOG_LEVEL);
 #define EVENT_TASK_QUEUE_DEPTH 32
 #endif
 
+/* Filter bit for each event type. Types that aren't listed are never sent. */
+static const uint32_t EVENT_FILTER_BIT[] = {
+	[SENSOR_EVENT_TEMPERATURE_1] = EVENT_FILTER_FLAGS_TEMPERATURE_1_EVENT_BITMASK,
+	[SENSOR_EVENT_TEMPERATURE_2] = EVENT_FILTER_FLAGS_TEMPERATURE_2_EVENT_BITMASK,
+	[SENSOR_EVENT_TEMPERATURE_3] = EVENT_FILTER_FLAGS_TEMPERATURE_3_EVENT_BITMASK,
+	[SENSOR_EVENT_TEMPERATURE_4] = EVENT_FILTER_FLAGS_TEMPERATURE_4_EVENT_BITMASK,
+	[SENSOR_EVENT_VOLTAGE_1] = EVENT_FILTER_FLAGS_VOLTAGE_1_EVENT_BITMASK,
+	[SENSOR_EVENT_VOLTAGE_2] = EVENT_FILTER_FLAGS_VOLTAGE_2_EVENT_BITMASK,
+	[SENSOR_EVENT_VOLTAGE_3] = EVENT_FILTER_FLAGS_VOLTAGE_3_EVENT_BITMASK,
+	[SENSOR_EVENT_VOLTAGE_4] = EVENT_FILTER_FLAGS_VOLTAGE_4_EVENT_BITMASK,
+	[SENSOR_EVENT_CURRENT_1] = EVENT_FILTER_FLAGS_CURRENT_1_EVENT_BITMASK,
+	[SENSOR_EVENT_CURRENT_2] = EVENT_FILTER_FLAGS_CURRENT_2_EVENT_BITMASK,
+	[SENSOR_EVENT_CURRENT_3] = EVENT_FILTER_FLAGS_CURRENT_3_EVENT_BITMASK,
+	[SENSOR_EVENT_CURRENT_4] = EVENT_FILTER_FLAGS_CURRENT_4_EVENT_BITMASK,
+	[SENSOR_EVENT_ULTRASONIC_1] = EVENT_FILTER_FLAGS_ULTRASONIC_EVENT_BITMASK,
+	[SENSOR_EVENT_PRESSURE_1] = EVENT_FILTER_FLAGS_PRESSURE_1_EVENT_BITMASK,
+	[SENSOR_EVENT_PRESSURE_2] = EVENT_FILTER_FLAGS_PRESSURE_2_EVENT_BITMASK,
+	[SENSOR_EVENT_TAMPER] = EVENT_FILTER_FLAGS_TAMPER_SWITCH_EVENT_BITMASK,
+	[SENSOR_EVENT_MAGNET] = EVENT_FILTER_FLAGS_MAGNET_SENSE_EVENT_BITMASK,
+	[SENSOR_EVENT_BATTERY_GOOD] = EVENT_FILTER_FLAGS_BATTERY_GOOD_EVENT_BITMASK,
+	[SENSOR_EVENT_BATTERY_BAD] = EVENT_FILTER_FLAGS_BATTERY_BAD_EVENT_BITMASK,
+	[SENSOR_EVENT_DIGITAL_IN1] = EVENT_FILTER_FLAGS_DIGITAL_IN1_EVENT_BITMASK,
+	[SENSOR_EVENT_DIGITAL_IN2] = EVENT_FILTER_FLAGS_DIGITAL_IN2_EVENT_BITMASK
+};
+
+#define NUMBER_OF_FILTERED_EVENTS ARRAY_SIZE(EVENT_FILTER_BIT)
+
+/* The latest event over the limit is held until its window ends */
+typedef struct EventRate {
+	int64_t windowStart;
+	uint32_t count;
+	bool pending;
+	SensorEventData_t data;
+	uint32_t seconds;
+	uint16_t ms;
+} EventRate_t;
+
 typedef struct EventTaskTag {
 	FwkMsgTask_t msgTask;
+	/* Cached event_filter_flags, events are posted from other threads */
+	atomic_t filterFlags;
+	uint32_t rateLimit;
+	uint32_t rateWindowMs;
+	uint32_t rateDropped;
+	EventRate_t rate[NUMBER_OF_FILTERED_EVENTS];
+	struct k_spinlock rateLock;
+	struct k_work_delayable rateWork;
 } EventTaskObj_t;
 
 /**************************************************************************************************/
@@ -55,16 +105,31 @@ K_THREAD_STACK_DEFINE(eventTaskStack, EVENT_TASK_STACK_DEPTH);
 K_MSGQ_DEFINE(eventTaskQueue, FWK_QUEUE_ENTRY_SIZE, EVENT_TASK_QUEUE_DEPTH, FWK_QUEUE_ALIGNMENT);
 
 /* Rolling id used to identify new events */
-static uint32_t event_task_event_id = 0;
+static atomic_t event_task_event_id = ATOMIC_INIT(0);
+
+/* Offset from uptime to qrtc time in milliseconds. The qrtc only counts whole
+ * seconds so each reading gives a lower bound of the offset. The largest bound
+ * seen converges on the real offset.
+ */
+static int64_t qrtc_offset_ms;
+static bool qrtc_offset_valid;
+static struct k_spinlock qrtc_offset_lock;
 
 /**************************************************************************************************/
 /* Local Function Prototypes                                                                      */
 /**************************************************************************************************/
 
 static void EventTaskThread(void *, void *, void *);
-static DispatchResult_t EventLogTimeStampMsgHandler(FwkMsgReceiver_t *pMsgRxer, FwkMsg_t *pMsg);
-static void SendEventDataAdvert(SensorMsg_t *sensor_event);
+static void UpdateQrtcOffset(void);
+static void EventTimeStamp(int64_t sampleTime, uint32_t *seconds, uint16_t *ms);
 static bool eventFilter(SensorEventType_t eventType);
+static bool eventRateLimited(SensorEventType_t eventType, SensorEventData_t data,
+			     uint32_t seconds, uint16_t ms);
+static void RateWorkHandler(struct k_work *work);
+static int SendEvent(SensorEventType_t type, SensorEventData_t data, uint32_t seconds,
+		     uint16_t ms);
+static void LoadEventFilter(void);
+static DispatchResult_t EventAttrChangedMsgHandler(FwkMsgReceiver_t *pMsgRxer, FwkMsg_t *pMsg);
 
 /**************************************************************************************************/
 /* Framework Message Dispatcher                                                                   */
@@ -74,7 +139,7 @@ static FwkMsgHandler_t *EventTaskMsgDispatcher(FwkMsgCode_t MsgCode)
 	/* clang-format off */
 	switch (MsgCode) {
 	case FMC_INVALID:             return Framework_UnknownMsgHandler;
-	case FMC_EVENT_TRIGGER:       return EventLogTimeStampMsgHandler;
+	case FMC_ATTR_CHANGED:        return EventAttrChangedMsgHandler;
 	default:                      return NULL;
 	}
 	/* clang-format on */
@@ -92,6 +157,11 @@ void EventTask_Initialize(void)
 	eventTaskObject.msgTask.timerPeriodTicks = K_MSEC(0); /* One shot */
 	eventTaskObject.msgTask.rxer.pQueue = &eventTaskQueue;
 
+	k_work_init_delayable(&eventTaskObject.rateWork, RateWorkHandler);
+
+	/* Events can be posted before this task runs */
+	LoadEventFilter();
+
 	Framework_RegisterTask(&eventTaskObject.msgTask);
 
 	eventTaskObject.msgTask.pTid =
@@ -114,161 +184,233 @@ static void EventTaskThread(void *pArg1, void *pArg2, void *pArg3)
 	}
 }
 
-static DispatchResult_t EventLogTimeStampMsgHandler(FwkMsgReceiver_t *pMsgRxer, FwkMsg_t *pMsg)
+static DispatchResult_t EventAttrChangedMsgHandler(FwkMsgReceiver_t *pMsgRxer, FwkMsg_t *pMsg)
 {
 	ARG_UNUSED(pMsgRxer);
-	SensorMsg_t eventData;
+	attr_changed_msg_t *pAttrMsg = (attr_changed_msg_t *)pMsg;
+	size_t i;
+
+	for (i = 0; i < pAttrMsg->count; i++) {
+		switch (pAttrMsg->list[i]) {
+		case ATTR_ID_event_filter_flags:
+		case ATTR_ID_event_rate_limit:
+		case ATTR_ID_event_rate_window:
+			LoadEventFilter();
+			return DISPATCH_OK;
+		default:
+			/* Don't care about this attribute. This is a broadcast. */
+			break;
+		}
+	}
+	return DISPATCH_OK;
+}
+
+int EventTask_Post(SensorEventType_t type, SensorEventData_t data, int64_t sampleTime)
+{
+	uint32_t seconds;
+	uint16_t ms;
 
-	EventLogMsg_t *pEventMsg = (EventLogMsg_t *)pMsg;
+	/* Check if the event flag is active */
+	if (!eventFilter(type)) {
+		return -EPERM;
+	}
 
-	eventData.event.type = pEventMsg->eventType;
-	eventData.event.data = pEventMsg->eventData;
-	eventData.event.timestamp = lcz_qrtc_get_epoch();
+	EventTimeStamp(sampleTime, &seconds, &ms);
 
-	SendEventDataAdvert(&eventData);
-	return DISPATCH_OK;
+#if defined(CONFIG_PERIODIC_ADVERT)
+	/* The periodic train has room for every sample, so it isn't rate limited */
+	PeriodicAdvert_AddSample(type, data, seconds, ms);
+#endif
+
+	if (eventRateLimited(type, data, seconds, ms)) {
+		return -EPERM;
+	}
+
+	return SendEvent(type, data, seconds, ms);
 }
 
-static void SendEventDataAdvert(SensorMsg_t *sensor_event)
+static int SendEvent(SensorEventType_t type, SensorEventData_t data, uint32_t seconds,
+		     uint16_t ms)
 {
-	bool activeEvent = false;
-	/*Check if the event flag is active */
-	activeEvent = eventFilter(sensor_event->event.type);
-
-	if (activeEvent == true) {
-		/* Now post the event to the BLE Task */
-		EventLogMsg_t *pMsgSend = (EventLogMsg_t *)BufferPool_Take(sizeof(EventLogMsg_t));
-
-		if (pMsgSend != NULL) {
-			pMsgSend->header.msgCode = FMC_SENSOR_EVENT;
-			pMsgSend->header.txId = FWK_ID_SENSOR_TASK;
-			pMsgSend->header.rxId = FWK_ID_BLE_TASK;
-			pMsgSend->eventType = sensor_event->event.type;
-			pMsgSend->eventData = sensor_event->event.data;
-			pMsgSend->id = event_task_event_id++;
-			pMsgSend->timeStamp = sensor_event->event.timestamp;
-			FRAMEWORK_MSG_SEND(pMsgSend);
-		}
+	SensorMsg_t sensor_event;
+
+	sensor_event.event.type = type;
+	sensor_event.event.data = data;
+	sensor_event.event.timestamp = seconds;
+	sensor_event.id = (uint32_t)atomic_inc(&event_task_event_id);
+
+	LOG_DBG("Event %u type %d at %u.%03u", sensor_event.id, type, seconds, ms);
+
+	return BleTask_PostEvent(&sensor_event);
+}
+
+/* Must be called with qrtc_offset_lock held */
+static void UpdateQrtcOffset(void)
+{
+	/* Read the qrtc first so that the bound is never too large */
+	int64_t epoch_ms = (int64_t)lcz_qrtc_get_epoch() * MSEC_PER_SEC;
+	int64_t offset = epoch_ms - k_uptime_get();
+
+	/* An offset a second or more above the new bound means that the qrtc
+	 * was set backwards.
+	 */
+	if (!qrtc_offset_valid || offset > qrtc_offset_ms ||
+	    (offset + MSEC_PER_SEC) <= qrtc_offset_ms) {
+		qrtc_offset_ms = offset;
+		qrtc_offset_valid = true;
+	}
+}
+
+/* Convert the uptime when the data was acquired to qrtc time. Events from
+ * producers that don't capture a time are stamped now.
+ */
+static void EventTimeStamp(int64_t sampleTime, uint32_t *seconds, uint16_t *ms)
+{
+	k_spinlock_key_t key;
+	int64_t stamp;
+
+	if (sampleTime == 0) {
+		sampleTime = k_uptime_get();
+	}
+
+	key = k_spin_lock(&qrtc_offset_lock);
+	UpdateQrtcOffset();
+	stamp = MAX(qrtc_offset_ms + sampleTime, 0);
+	k_spin_unlock(&qrtc_offset_lock, key);
+
+	*seconds = (uint32_t)(stamp / MSEC_PER_SEC);
+	*ms = (uint16_t)(stamp % MSEC_PER_SEC);
+}
+
+static void LoadEventFilter(void)
+{
+	k_spinlock_key_t key;
+	size_t i;
+
+	atomic_set(&eventTaskObject.filterFlags, attr_get_uint32(ATTR_ID_event_filter_flags, 0));
+
+	key = k_spin_lock(&eventTaskObject.rateLock);
+	eventTaskObject.rateLimit = attr_get_uint32(ATTR_ID_event_rate_limit, 0);
+	eventTaskObject.rateWindowMs =
+		attr_get_uint32(ATTR_ID_event_rate_window, 1) * MSEC_PER_SEC;
+	/* Held events are kept and sent now that their windows have ended */
+	for (i = 0; i < NUMBER_OF_FILTERED_EVENTS; i++) {
+		eventTaskObject.rate[i].windowStart = 0;
+		eventTaskObject.rate[i].count = 0;
+	}
+	k_spin_unlock(&eventTaskObject.rateLock, key);
+
+	(void)k_work_reschedule(&eventTaskObject.rateWork, K_NO_WAIT);
+}
+
+uint32_t EventTask_FilterBit(SensorEventType_t type)
+{
+	if ((size_t)type >= NUMBER_OF_FILTERED_EVENTS) {
+		return 0;
 	}
+	return EVENT_FILTER_BIT[type];
 }
 
 static bool eventFilter(SensorEventType_t eventType)
 {
-	bool filterStatus = false;
-	uint32_t event_filter_flags;
+	return ((atomic_get(&eventTaskObject.filterFlags) & EventTask_FilterBit(eventType)) != 0);
+}
 
-	attr_get(ATTR_ID_event_filter_flags, &event_filter_flags, sizeof(event_filter_flags));
+/* Each event type may be sent at most rateLimit times in a window. This stops
+ * a chattering input from filling the advertisement queue. The latest event
+ * over the limit is held and sent when the window ends, so the last state of
+ * an input is never lost. The events it replaces are counted as dropped.
+ */
+static bool eventRateLimited(SensorEventType_t eventType, SensorEventData_t data,
+			     uint32_t seconds, uint16_t ms)
+{
+	EventRate_t *rate = &eventTaskObject.rate[eventType];
+	int64_t now = k_uptime_get();
+	k_spinlock_key_t key;
+	bool limited = false;
+	bool replaced = false;
+	int64_t windowEnd = 0;
+	uint32_t dropped = 0;
 
-	switch (eventType) {
-	case SENSOR_EVENT_TEMPERATURE_1:
-		if (event_filter_flags & EVENT_FILTER_FLAGS_TEMPERATURE_1_EVENT_BITMASK) {
-			filterStatus = true;
-		}
-		break;
-	case SENSOR_EVENT_TEMPERATURE_2:
-		if (event_filter_flags & EVENT_FILTER_FLAGS_TEMPERATURE_2_EVENT_BITMASK) {
-			filterStatus = true;
-		}
-		break;
-	case SENSOR_EVENT_TEMPERATURE_3:
-		if (event_filter_flags & EVENT_FILTER_FLAGS_TEMPERATURE_3_EVENT_BITMASK) {
-			filterStatus = true;
-		}
-		break;
-	case SENSOR_EVENT_TEMPERATURE_4:
-		if (event_filter_flags & EVENT_FILTER_FLAGS_TEMPERATURE_4_EVENT_BITMASK) {
-			filterStatus = true;
-		}
-		break;
-	case SENSOR_EVENT_VOLTAGE_1:
-		if (event_filter_flags & EVENT_FILTER_FLAGS_VOLTAGE_1_EVENT_BITMASK) {
-			filterStatus = true;
-		}
-		break;
-	case SENSOR_EVENT_VOLTAGE_2:
-		if (event_filter_flags & EVENT_FILTER_FLAGS_VOLTAGE_2_EVENT_BITMASK) {
-			filterStatus = true;
-		}
-		break;
-	case SENSOR_EVENT_VOLTAGE_3:
-		if (event_filter_flags & EVENT_FILTER_FLAGS_VOLTAGE_3_EVENT_BITMASK) {
-			filterStatus = true;
-		}
-		break;
-	case SENSOR_EVENT_VOLTAGE_4:
-		if (event_filter_flags & EVENT_FILTER_FLAGS_VOLTAGE_4_EVENT_BITMASK) {
-			filterStatus = true;
-		}
-		break;
-	case SENSOR_EVENT_CURRENT_1:
-		if (event_filter_flags & EVENT_FILTER_FLAGS_CURRENT_1_EVENT_BITMASK) {
-			filterStatus = true;
-		}
-		break;
-	case SENSOR_EVENT_CURRENT_2:
-		if (event_filter_flags & EVENT_FILTER_FLAGS_CURRENT_2_EVENT_BITMASK) {
-			filterStatus = true;
+	key = k_spin_lock(&eventTaskObject.rateLock);
+	if (eventTaskObject.rateLimit != 0) {
+		if ((rate->count == 0) ||
+		    ((now - rate->windowStart) >= eventTaskObject.rateWindowMs)) {
+			rate->windowStart = now;
+			rate->count = 0;
+			/* This event is newer than the one being held */
+			replaced = rate->pending;
+			rate->pending = false;
 		}
-		break;
-	case SENSOR_EVENT_CURRENT_3:
-		if (event_filter_flags & EVENT_FILTER_FLAGS_CURRENT_3_EVENT_BITMASK) {
-			filterStatus = true;
+		if (rate->count < eventTaskObject.rateLimit) {
+			rate->count += 1;
+		} else {
+			limited = true;
+			replaced = rate->pending;
+			rate->pending = true;
+			rate->data = data;
+			rate->seconds = seconds;
+			rate->ms = ms;
+			windowEnd = rate->windowStart + eventTaskObject.rateWindowMs;
 		}
-		break;
-	case SENSOR_EVENT_CURRENT_4:
-		if (event_filter_flags & EVENT_FILTER_FLAGS_CURRENT_4_EVENT_BITMASK) {
-			filterStatus = true;
+		if (replaced) {
+			eventTaskObject.rateDropped += 1;
+			dropped = eventTaskObject.rateDropped;
 		}
-		break;
-	case SENSOR_EVENT_ULTRASONIC_1:
-		if (event_filter_flags & EVENT_FILTER_FLAGS_ULTRASONIC_EVENT_BITMASK) {
-			filterStatus = true;
-		}
-		break;
-	case SENSOR_EVENT_PRESSURE_1:
-		if (event_filter_flags & EVENT_FILTER_FLAGS_PRESSURE_1_EVENT_BITMASK) {
-			filterStatus = true;
-		}
-		break;
-	case SENSOR_EVENT_PRESSURE_2:
-		if (event_filter_flags & EVENT_FILTER_FLAGS_PRESSURE_2_EVENT_BITMASK) {
-			filterStatus = true;
-		}
-		break;
-	case SENSOR_EVENT_TAMPER:
-		if (event_filter_flags & EVENT_FILTER_FLAGS_TAMPER_SWITCH_EVENT_BITMASK) {
-			filterStatus = true;
-		}
-		break;
-	case SENSOR_EVENT_MAGNET:
-		if (event_filter_flags & EVENT_FILTER_FLAGS_MAGNET_SENSE_EVENT_BITMASK) {
-			filterStatus = true;
-		}
-		break;
-	case SENSOR_EVENT_BATTERY_GOOD:
-		if (event_filter_flags & EVENT_FILTER_FLAGS_BATTERY_GOOD_EVENT_BITMASK) {
-			filterStatus = true;
-		}
-		break;
-	case SENSOR_EVENT_BATTERY_BAD:
-		if (event_filter_flags & EVENT_FILTER_FLAGS_BATTERY_BAD_EVENT_BITMASK) {
-			filterStatus = true;
-		}
-		break;
-	case SENSOR_EVENT_DIGITAL_IN1:
-		if (event_filter_flags & EVENT_FILTER_FLAGS_DIGITAL_IN1_EVENT_BITMASK) {
-			filterStatus = true;
+	}
+	k_spin_unlock(&eventTaskObject.rateLock, key);
+
+	if (limited) {
+		LOG_DBG("Event type %d rate limited", eventType);
+		/* Windows all have the same length, so a scheduled flush is never
+		 * later than this one.
+		 */
+		(void)k_work_schedule(&eventTaskObject.rateWork, K_MSEC(MAX(windowEnd - now, 0)));
+	}
+	if (replaced) {
+		(void)attr_set_uint32(ATTR_ID_event_rate_dropped, dropped);
+	}
+	return limited;
+}
+
+/* Send the held events whose windows have ended. Sending one starts a new
+ * window, so it counts towards the limit of that window.
+ */
+static void RateWorkHandler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+	EventRate_t *rate;
+	EventRate_t held;
+	int64_t now = k_uptime_get();
+	int64_t next = INT64_MAX;
+	int64_t windowEnd;
+	k_spinlock_key_t key;
+	size_t i;
+
+	for (i = 0; i < NUMBER_OF_FILTERED_EVENTS; i++) {
+		rate = &eventTaskObject.rate[i];
+		held.pending = false;
+
+		key = k_spin_lock(&eventTaskObject.rateLock);
+		if (rate->pending) {
+			windowEnd = rate->windowStart + eventTaskObject.rateWindowMs;
+			if ((eventTaskObject.rateLimit == 0) || (windowEnd <= now)) {
+				held = *rate;
+				rate->pending = false;
+				rate->windowStart = now;
+				rate->count = 1;
+			} else {
+				next = MIN(next, windowEnd);
+			}
 		}
-		break;
-	case SENSOR_EVENT_DIGITAL_IN2:
-		if (event_filter_flags & EVENT_FILTER_FLAGS_DIGITAL_IN2_EVENT_BITMASK) {
-			filterStatus = true;
+		k_spin_unlock(&eventTaskObject.rateLock, key);
+
+		if (held.pending) {
+			(void)SendEvent((SensorEventType_t)i, held.data, held.seconds, held.ms);
 		}
-		break;
-	default:
-		filterStatus = false;
-		break;
 	}
 
-	return filterStatus;
-}
\ No newline at end of file
+	if (next != INT64_MAX) {
+		(void)k_work_reschedule(&eventTaskObject.rateWork, K_MSEC(next - now));
+	}
+}
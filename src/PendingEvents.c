@@ -0,0 +1,72 @@
+/**
+ * @file PendingEvents.c
+ * @brief Events waiting to be advertised, one slot per event type
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr.h>
+
+#include "PendingEvents.h"
+
+/**************************************************************************************************/
+/* Local Function Prototypes                                                                      */
+/**************************************************************************************************/
+static int PickSlot(uint32_t mask, uint8_t *cursor);
+
+/**************************************************************************************************/
+/* Global Function Definitions                                                                    */
+/**************************************************************************************************/
+bool PendingEvents_Put(PendingEvents_t *store, const SensorMsg_t *event, uint32_t bit)
+{
+	bool replaced = ((store->pending & bit) != 0);
+
+	store->slot[find_lsb_set(bit) - 1] = *event;
+	store->pending |= bit;
+	return replaced;
+}
+
+int PendingEvents_Take(PendingEvents_t *store, uint32_t alarms, SensorMsg_t *event)
+{
+	int slot;
+
+	if ((store->pending & alarms) != 0) {
+		slot = PickSlot(store->pending & alarms, &store->alarmCursor);
+	} else {
+		slot = PickSlot(store->pending, &store->telemetryCursor);
+	}
+
+	if (slot >= 0) {
+		*event = store->slot[slot];
+		store->pending &= ~BIT(slot);
+	}
+	return (slot >= 0) ? 0 : -ENOENT;
+}
+
+void PendingEvents_Purge(PendingEvents_t *store)
+{
+	store->pending = 0;
+}
+
+/**************************************************************************************************/
+/* Local Function Definitions                                                                     */
+/**************************************************************************************************/
+/* The first slot of the mask at or after the cursor, wrapping around */
+static int PickSlot(uint32_t mask, uint8_t *cursor)
+{
+	uint32_t ahead = mask & ~(BIT(*cursor) - 1);
+	int slot;
+
+	if (mask == 0) {
+		return -ENOENT;
+	}
+
+	slot = find_lsb_set((ahead != 0) ? ahead : mask) - 1;
+	*cursor = (slot + 1) % PENDING_EVENTS_SLOTS;
+	return slot;
+}
@@ -0,0 +1,195 @@
+/**
+ * @file PeriodicAdvert.c
+ * @brief Periodic advertising train carrying a rolling window of samples
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(PeriodicAdvert, CONFIG_PERIODIC_ADVERT_LOG_LEVEL);
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr.h>
+#include <bluetooth/bluetooth.h>
+
+#include "PeriodicAdvert.h"
+
+/**************************************************************************************************/
+/* Local Constant, Macro and Type Definitions                                                     */
+/**************************************************************************************************/
+/* Periodic advertising intervals are in units of 1.25 milliseconds */
+#define PERIODIC_INTERVAL ((CONFIG_PERIODIC_ADVERT_INTERVAL_MS * 4) / 5)
+
+#if defined(CONFIG_PERIODIC_ADVERT_CODED)
+#define PERIODIC_ADV_OPTIONS (BT_LE_ADV_OPT_EXT_ADV | BT_LE_ADV_OPT_CODED)
+#else
+#define PERIODIC_ADV_OPTIONS BT_LE_ADV_OPT_EXT_ADV
+#endif
+
+typedef struct {
+	PeriodicSample_t sample[CONFIG_PERIODIC_ADVERT_WINDOW];
+	/* Position of the next sample written */
+	size_t head;
+	size_t count;
+	struct k_spinlock lock;
+} SampleWindow_t;
+
+/**************************************************************************************************/
+/* Local Data Definitions                                                                         */
+/**************************************************************************************************/
+/* Periodic advertising needs a set that is neither connectable nor scannable */
+static const struct bt_le_adv_param periodic_adv_param = BT_LE_ADV_PARAM_INIT(
+	PERIODIC_ADV_OPTIONS, BT_GAP_ADV_SLOW_INT_MIN, BT_GAP_ADV_SLOW_INT_MAX, NULL);
+
+static const struct bt_le_per_adv_param periodic_param = {
+	.interval_min = PERIODIC_INTERVAL,
+	.interval_max = PERIODIC_INTERVAL,
+	.options = BT_LE_PER_ADV_OPT_NONE,
+};
+
+static struct bt_le_ext_adv *adv;
+static SampleWindow_t window;
+static uint8_t frame[PERIODIC_FRAME_SIZE(CONFIG_PERIODIC_ADVERT_WINDOW)];
+static uint8_t frameSequence;
+static bool started;
+
+static struct bt_data periodic_ad[] = {
+	BT_DATA(BT_DATA_MANUFACTURER_DATA, frame, 0),
+};
+
+static struct k_work_delayable update_work;
+
+/**************************************************************************************************/
+/* Local Function Prototypes                                                                      */
+/**************************************************************************************************/
+static void UpdateWorkHandler(struct k_work *item);
+static size_t CopyWindow(PeriodicSample_t *samples);
+
+/**************************************************************************************************/
+/* Global Function Definitions                                                                    */
+/**************************************************************************************************/
+int PeriodicAdvert_Init(void)
+{
+	int r;
+
+	k_work_init_delayable(&update_work, UpdateWorkHandler);
+
+	r = bt_le_ext_adv_create(&periodic_adv_param, NULL, &adv);
+	if (r < 0) {
+		LOG_ERR("Failed to create periodic advertiser set (%d)", r);
+		return r;
+	}
+
+	r = bt_le_per_adv_set_param(adv, &periodic_param);
+	if (r < 0) {
+		LOG_ERR("Failed to set periodic advertising parameters (%d)", r);
+	}
+	return r;
+}
+
+int PeriodicAdvert_Start(void)
+{
+	int r;
+
+	if (started) {
+		return 0;
+	}
+	if (adv == NULL) {
+		return -ENODEV;
+	}
+
+	r = bt_le_per_adv_start(adv);
+	if (r == 0) {
+		/* The extended advertisement carries the sync info */
+		r = bt_le_ext_adv_start(adv, BT_LE_EXT_ADV_START_DEFAULT);
+	}
+	started = (r == 0);
+	LOG_DBG("Periodic advertising start (%d)", r);
+
+	if (started) {
+		k_work_schedule(&update_work, K_NO_WAIT);
+	}
+	return r;
+}
+
+int PeriodicAdvert_Stop(void)
+{
+	int r = 0;
+
+	if (started) {
+		k_work_cancel_delayable(&update_work);
+		r = bt_le_per_adv_stop(adv);
+		(void)bt_le_ext_adv_stop(adv);
+		started = false;
+		LOG_DBG("Periodic advertising end (%d)", r);
+	}
+	return r;
+}
+
+void PeriodicAdvert_AddSample(SensorEventType_t type, SensorEventData_t data, uint32_t epoch,
+			      uint16_t ms)
+{
+	k_spinlock_key_t key = k_spin_lock(&window.lock);
+	PeriodicSample_t *sample = &window.sample[window.head];
+
+	sample->type = type;
+	sample->data = data;
+	sample->epoch = epoch;
+	sample->ms = ms;
+	window.head = (window.head + 1) % CONFIG_PERIODIC_ADVERT_WINDOW;
+	window.count = MIN(window.count + 1, CONFIG_PERIODIC_ADVERT_WINDOW);
+	k_spin_unlock(&window.lock, key);
+
+	/* Samples that arrive within an interval share one data update */
+	if (started) {
+		k_work_schedule(&update_work, K_MSEC(CONFIG_PERIODIC_ADVERT_INTERVAL_MS));
+	}
+}
+
+/**************************************************************************************************/
+/* Local Function Definitions                                                                     */
+/**************************************************************************************************/
+static void UpdateWorkHandler(struct k_work *item)
+{
+	PeriodicSample_t samples[CONFIG_PERIODIC_ADVERT_WINDOW];
+	size_t count = CopyWindow(samples);
+	int r;
+
+	if (count == 0) {
+		return;
+	}
+
+	r = PeriodicFrame_Encode(frame, sizeof(frame), samples, count, frameSequence);
+	if (r < 0) {
+		LOG_ERR("Failed to encode periodic frame (%d)", r);
+		return;
+	}
+	frameSequence += 1;
+
+	periodic_ad[0].data_len = (uint8_t)r;
+	r = bt_le_per_adv_set_data(adv, periodic_ad, ARRAY_SIZE(periodic_ad));
+	if (r < 0) {
+		LOG_ERR("Failed to update periodic advertising data (%d)", r);
+	}
+}
+
+/* Copies the window oldest first */
+static size_t CopyWindow(PeriodicSample_t *samples)
+{
+	k_spinlock_key_t key = k_spin_lock(&window.lock);
+	size_t first = (window.head + CONFIG_PERIODIC_ADVERT_WINDOW - window.count) %
+		       CONFIG_PERIODIC_ADVERT_WINDOW;
+	size_t count = window.count;
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		samples[i] = window.sample[(first + i) % CONFIG_PERIODIC_ADVERT_WINDOW];
+	}
+	k_spin_unlock(&window.lock, key);
+
+	return count;
+}
@@ -0,0 +1,64 @@
+/**
+ * @file PeriodicFrame.c
+ * @brief Rolling window of samples encoded for the periodic advertising train
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr.h>
+#include <sys/byteorder.h>
+
+#include "lcz_sensor_adv_format.h"
+#include "PeriodicFrame.h"
+
+/**************************************************************************************************/
+/* Global Function Definitions                                                                    */
+/**************************************************************************************************/
+int PeriodicFrame_Encode(uint8_t *buf, size_t size, const PeriodicSample_t *samples, size_t count,
+			 uint8_t sequence)
+{
+	const PeriodicSample_t *newest;
+	int64_t newestMs;
+	int64_t age;
+	uint8_t *p = buf;
+	size_t i;
+
+	if ((count == 0) || (count > UINT8_MAX)) {
+		return -EINVAL;
+	}
+	if (size < PERIODIC_FRAME_SIZE(count)) {
+		return -ENOMEM;
+	}
+	newest = &samples[count - 1];
+
+	sys_put_le16(LAIRD_CONNECTIVITY_MANUFACTURER_SPECIFIC_COMPANY_ID1, p);
+	p += sizeof(uint16_t);
+	sys_put_le16(PERIODIC_FRAME_PROTOCOL_ID, p);
+	p += sizeof(uint16_t);
+	*p++ = PERIODIC_FRAME_VERSION;
+	*p++ = sequence;
+	*p++ = (uint8_t)count;
+	sys_put_le32(newest->epoch, p);
+	p += sizeof(uint32_t);
+	sys_put_le16(newest->ms, p);
+	p += sizeof(uint16_t);
+
+	newestMs = ((int64_t)newest->epoch * MSEC_PER_SEC) + newest->ms;
+	for (i = 0; i < count; i++) {
+		age = newestMs - (((int64_t)samples[i].epoch * MSEC_PER_SEC) + samples[i].ms);
+		age = MAX(0, MIN(age / PERIODIC_FRAME_AGE_UNIT_MS, UINT16_MAX));
+
+		*p++ = (uint8_t)samples[i].type;
+		sys_put_le16((uint16_t)age, p);
+		p += sizeof(uint16_t);
+		sys_put_le32(samples[i].data.u32, p);
+		p += sizeof(uint32_t);
+	}
+
+	return (int)(p - buf);
+}
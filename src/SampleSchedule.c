@@ -0,0 +1,76 @@
+/**
+ * @file SampleSchedule.c
+ * @brief Deadline arithmetic for the sensor readings that share a timer
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr.h>
+
+#include "SampleSchedule.h"
+
+/**************************************************************************************************/
+/* Global Function Definitions                                                                    */
+/**************************************************************************************************/
+int64_t SampleSchedule_Deadline(int64_t anchor, int64_t now, int64_t epochMs, int64_t period,
+				uint32_t *missed)
+{
+	int64_t deadline;
+	int64_t skipped = 0;
+
+	if (anchor == 0) {
+		/* Line the first reading up with a multiple of the period in real time */
+		deadline = now + period - (epochMs % period);
+	} else {
+		deadline = anchor + period;
+		if (deadline <= now) {
+			/* Skip the deadlines that were missed */
+			skipped = ((now - deadline) / period) + 1;
+			deadline += skipped * period;
+		}
+	}
+
+	*missed = (uint32_t)skipped;
+	return deadline;
+}
+
+int64_t SampleSchedule_Earliest(const int64_t *deadline, size_t count)
+{
+	int64_t next = 0;
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		if (deadline[i] != 0 && (next == 0 || deadline[i] < next)) {
+			next = deadline[i];
+		}
+	}
+	return next;
+}
+
+uint32_t SampleSchedule_Due(const int64_t *deadline, size_t count, int64_t window)
+{
+	uint32_t due = 0;
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		if (deadline[i] != 0 && deadline[i] <= window) {
+			due |= BIT(i);
+		}
+	}
+	return due;
+}
+
+uint32_t SampleSchedule_PerHour(uint32_t count, int64_t elapsed)
+{
+	const int64_t hour = MIN_PER_HOUR * SEC_PER_MIN * MSEC_PER_SEC;
+
+	if (elapsed <= 0) {
+		return 0;
+	}
+	return (uint32_t)(((int64_t)count * hour) / elapsed);
+}
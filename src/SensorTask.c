@@ -35,6 +35,10 @@ LOG_MODULE_REGISTER(Sensor, CONFIG_SENSOR_TASK_LOG_LEVEL);
 #include "lcz_sensor_event.h"
 #include "lcz_event_manager.h"
 #include "Flags.h"
+#include "EventTask.h"
+#include "lcz_qrtc.h"
+#include "SampleSchedule.h"
+#include "AdaptiveInterval.h"
 
 /* LWM2M telemetry additions */
 #ifdef CONFIG_LCZ_LWM2M_CLIENT
@@ -85,6 +89,30 @@ LOG_MODULE_REGISTER(Sensor, CONFIG_SENSOR_TASK_LOG_LEVEL);
 /* 0x0F is all the thermisters enabled*/
 #define ALL_THERMISTORS (0x0F)
 
+/* Longer than the longest settle time plus the time AdcBt6 retries sending
+ * the results. The analog schedule is restarted if they never arrive.
+ */
+#define ANALOG_SETTLE_TIMEOUT_MS 2000
+
+/* Attribute layer calls made by the sampling paths are counted so that the
+ * cost of a scan can be seen in the log.
+ */
+#define COUNT_ATTR(call) (atomic_inc(&sensorTaskObject.attrCalls), (call))
+
+/* Readings are carried in integer milli-units of the attribute value
+ * through the deadband, adaptive and event comparisons. With the integer
+ * conversions selected a float is only produced for the attribute, LwM2M
+ * and event values.
+ */
+#ifdef CONFIG_ADC_BT6_FIXED_POINT
+#define ADC_CONVERT_MILLI(_fn, _channel, _raw, _scale)                         \
+	(AdcBt6_##_fn##Milli(_channel, _raw) * (_scale))
+#else
+#define ADC_CONVERT_MILLI(_fn, _channel, _raw, _scale)                         \
+	ToMilli(AdcBt6_##_fn(_channel, _raw) * (_scale))
+#endif
+#define MILLI_TO_FLOAT(_milli) ((float)(_milli) / ADC_BT6_MILLI)
+
 #if DT_NODE_HAS_STATUS(DT_NODELABEL(spi1), okay)
 #define SPI_DEV_NAME DT_LABEL(DT_NODELABEL(spi1))
 #else
@@ -98,12 +126,78 @@ typedef enum {
 	BOTH_EDGE_ALARM
 } digitalAlarm_t;
 
+BUILD_ASSERT(TOTAL_THERM_CH <= ADAPTIVE_INTERVAL_CHANNELS &&
+		     TOTAL_ANALOG_CH <= ADAPTIVE_INTERVAL_CHANNELS,
+	     "Adaptive state is too small");
+
+/* Snapshot of the attributes used when sampling. It is only ever replaced
+ * as a whole.
+ */
+typedef struct sensor_config {
+	bool active_mode;
+	bool input_config_changed;
+	uint8_t thermistor_config;
+	uint8_t analog_input_type[TOTAL_ANALOG_CH];
+	uint32_t power_sense_interval;
+	uint32_t temperature_sense_interval;
+	uint32_t analog_sense_interval;
+	/* Bands in milli-units, percentages in thousandths of a percent */
+	int32_t temperature_deadband[TOTAL_THERM_CH];
+	int32_t temperature_deadband_percent[TOTAL_THERM_CH];
+	int32_t analog_deadband[TOTAL_ANALOG_CH];
+	int32_t analog_deadband_percent[TOTAL_ANALOG_CH];
+	uint32_t deadband_heartbeat;
+	AdaptiveConfig_t temperature_adaptive;
+	AdaptiveConfig_t analog_adaptive;
+	AdaptiveConfig_t power_adaptive;
+} sensor_config_t;
+
+/* Measurements that share the sample timer */
+typedef enum sample_group {
+	SAMPLE_POWER = 0,
+	SAMPLE_TEMPERATURE,
+	SAMPLE_ANALOG,
+	NUMBER_OF_SAMPLE_GROUPS
+} sample_group_t;
+
+typedef struct sample_schedule {
+	/* Uptime (ms) when each group is due, 0 when it isn't scheduled */
+	int64_t deadline[NUMBER_OF_SAMPLE_GROUPS];
+	/* Deadline of the last reading, the next one is a whole number of
+	 * intervals later. 0 restarts the grid from the qrtc.
+	 */
+	int64_t anchor[NUMBER_OF_SAMPLE_GROUPS];
+	uint32_t jitterMax[NUMBER_OF_SAMPLE_GROUPS];
+	uint32_t overruns[NUMBER_OF_SAMPLE_GROUPS];
+	uint32_t wakeups;
+	uint32_t hourWakeups;
+	int64_t hourStart;
+} sample_schedule_t;
+
+/* The last value sent as an event for a channel */
+typedef struct report_state {
+	bool valid;
+	int32_t value;
+	int64_t timestamp;
+} report_state_t;
+
 typedef struct SensorTaskTag {
 	FwkMsgTask_t msgTask;
 	uint8_t digitalIn1Enabled;
 	uint8_t digitalIn2Enabled;
 	digitalAlarm_t input1Alarm;
 	digitalAlarm_t input2Alarm;
+	uint32_t configRebuilds;
+	/* Attribute layer calls since the last scan was logged */
+	atomic_t attrCalls;
+	/* Pressure and ultrasonic inputs are warming up */
+	bool analogSettling;
+	report_state_t temperatureReport[TOTAL_THERM_CH];
+	report_state_t analogReport[TOTAL_ANALOG_CH];
+	AdaptiveState_t temperatureAdaptive;
+	AdaptiveState_t analogAdaptive;
+	AdaptiveState_t powerAdaptive;
+	sample_schedule_t schedule;
 } SensorTaskObj_t;
 
 #ifdef LWM2M_TELEMETRY_SUPPORT_ENABLED
@@ -114,9 +208,35 @@ typedef struct SensorTaskTag {
 /* Local Data Definitions                                                     */
 /******************************************************************************/
 static SensorTaskObj_t sensorTaskObject;
-static struct k_timer powerTimer;
-static struct k_timer temperatureReadTimer;
-static struct k_timer analogReadTimer;
+
+/* Timing statistics for each sample group */
+static const struct {
+	attr_id_t lateness;
+	attr_id_t jitterMax;
+	attr_id_t overruns;
+} SAMPLE_STATS_ID[NUMBER_OF_SAMPLE_GROUPS] = {
+	[SAMPLE_POWER] = { ATTR_ID_power_sample_lateness,
+			   ATTR_ID_power_sample_jitter_max,
+			   ATTR_ID_power_sample_overruns },
+	[SAMPLE_TEMPERATURE] = { ATTR_ID_temperature_sample_lateness,
+				 ATTR_ID_temperature_sample_jitter_max,
+				 ATTR_ID_temperature_sample_overruns },
+	[SAMPLE_ANALOG] = { ATTR_ID_analog_sample_lateness,
+			    ATTR_ID_analog_sample_jitter_max,
+			    ATTR_ID_analog_sample_overruns }
+};
+
+/* Only SensorTask rebuilds the snapshot, so the task reads it in place
+ * through pSensorConfig. The attr_prepare_* callbacks run on other threads
+ * and take a copy with SensorConfigGet. The lock is only held to copy it.
+ */
+static sensor_config_t sensorConfig;
+static const sensor_config_t *const pSensorConfig = &sensorConfig;
+static struct k_spinlock sensorConfigLock;
+
+/* One timer wakes the task for all of the periodic measurements */
+static struct k_timer sampleTimer;
+static struct k_timer analogSettleTimer;
 
 K_THREAD_STACK_DEFINE(sensorTaskStack, SENSOR_TASK_STACK_DEPTH);
 
@@ -143,6 +263,12 @@ static DispatchResult_t MeasureTemperatureMsgHandler(FwkMsgReceiver_t *pMsgRxer,
 						     FwkMsg_t *pMsg);
 static DispatchResult_t AnalogReadMsgHandler(FwkMsgReceiver_t *pMsgRxer,
 					     FwkMsg_t *pMsg);
+static DispatchResult_t AnalogSettledMsgHandler(FwkMsgReceiver_t *pMsgRxer,
+						FwkMsg_t *pMsg);
+static DispatchResult_t AnalogTimeoutMsgHandler(FwkMsgReceiver_t *pMsgRxer,
+						FwkMsg_t *pMsg);
+static DispatchResult_t SampleDueMsgHandler(FwkMsgReceiver_t *pMsgRxer,
+					    FwkMsg_t *pMsg);
 static DispatchResult_t EnterActiveModeMsgHandler(FwkMsgReceiver_t *pMsgRxer,
 						  FwkMsg_t *pMsg);
 static DispatchResult_t EnterShelfModeMsgHandler(FwkMsgReceiver_t *pMsgRxer,
@@ -151,6 +277,12 @@ static DispatchResult_t ClearInputConfigChangedMsgHandler(FwkMsgReceiver_t *pMsg
 						 FwkMsg_t *pMsg);
 
 static void LoadSensorConfiguration(void);
+static void RebuildSensorConfig(void);
+static void SensorConfigGet(sensor_config_t *cfg);
+static void LogAttrCalls(void);
+static bool InAttrRange(attr_id_t id, attr_id_t first, size_t count);
+static bool IsSensorConfigAttr(attr_id_t id);
+static bool ChangesInputConfig(attr_id_t id);
 static void ClearInputConfigChangedFlag(void);
 static void SensorConfigChange(bool bootup);
 static void SensorOutput1Control(void);
@@ -171,14 +303,42 @@ static void InitializeIntervalTimers(void);
 static void StartAnalogInterval(void);
 static void StartTemperatureInterval(void);
 static void StartPowerInterval(void);
+static void ScheduleSample(sample_group_t group, uint32_t interval);
+static void CancelSample(sample_group_t group);
+static bool SampleScheduled(sample_group_t group);
+static void ArmSampleTimer(void);
+static void CountWakeup(int64_t now);
+static void RecordLateness(sample_group_t group, int64_t now);
+static void RestartSampleGrid(void);
+static void ReadPower(void);
+static void ReadTemperatures(void);
+static void ReadAnalogInputs(void);
 static void DisableAnalogReadings(void);
 static void DisableThermistorReadings(void);
 
+static AdcMeasurementType_t AnalogAdcType(enum analog_input_1_type config);
 static int MeasureAnalogInput(size_t channel, AdcPwrSequence_t power,
-			      float *result);
+			      int32_t *result, int64_t *sampleTime);
+static int ConvertAnalogInput(size_t channel,
+			      enum analog_input_1_type config, int16_t raw,
+			      int32_t *result);
 static int MeasureThermistor(size_t channel, AdcPwrSequence_t power,
-			     float *result);
-static void SendEvent(SensorEventType_t type, SensorEventData_t data);
+			     int32_t *result);
+static void SendEvent(SensorEventType_t type, SensorEventData_t data,
+		      int64_t sampleTime);
+static bool OutsideDeadband(report_state_t *state, int32_t value,
+			    int32_t band, int32_t percent);
+static void SendTemperatureEvent(size_t channel, int32_t temperature,
+				 int64_t sampleTime);
+static void SendAnalogEvent(size_t channel, int32_t value,
+			    int64_t sampleTime);
+static void AdaptiveSample(AdaptiveState_t *state, size_t channel,
+			   int32_t value, int32_t threshold);
+static int MeasurePower(float *volts);
+static int32_t ToMilli(float value);
+static uint32_t ConfigUint32(attr_id_t id, uint32_t alt);
+static bool ConfigBool(attr_id_t id);
+static int32_t ConfigMilli(attr_id_t id);
 static SensorEventType_t AnalogConfigType(size_t channel);
 
 /* LWM2M telemetry update */
@@ -188,9 +348,8 @@ static int update_lwm2m_fill_level(int index, float fill_level);
 static int update_lwm2m_current(int index, float current);
 static int update_lwm2m_battery(lcz_lwm2m_client_device_battery_status_t status, float voltage);
 
-static void powerTimerCallbackIsr(struct k_timer *timer_id);
-static void temperatureReadTimerCallbackIsr(struct k_timer *timer_id);
-static void analogReadTimerCallbackIsr(struct k_timer *timer_id);
+static void sampleTimerCallbackIsr(struct k_timer *timer_id);
+static void analogSettleTimerCallbackIsr(struct k_timer *timer_id);
 
 /******************************************************************************/
 /* Framework Message Dispatcher                                               */
@@ -207,6 +366,9 @@ static FwkMsgHandler_t *SensorTaskMsgDispatcher(FwkMsgCode_t MsgCode)
 	case FMC_READ_POWER:          return ReadPowerMsgHandler;
 	case FMC_TEMPERATURE_MEASURE: return MeasureTemperatureMsgHandler;
 	case FMC_ANALOG_MEASURE:      return AnalogReadMsgHandler;
+	case FMC_ANALOG_SETTLED:      return AnalogSettledMsgHandler;
+	case FMC_ANALOG_SETTLE_TIMEOUT: return AnalogTimeoutMsgHandler;
+	case FMC_SAMPLE_DUE:          return SampleDueMsgHandler;
 	case FMC_ENTER_ACTIVE_MODE:   return EnterActiveModeMsgHandler;
 	case FMC_ENTER_SHELF_MODE:    return EnterShelfModeMsgHandler;
 	case FMC_CLEAR_INPUT_CONFIG_CHANGED: return ClearInputConfigChangedMsgHandler;
@@ -335,27 +497,37 @@ void SensorTask_Initialize(void)
 }
 
 int attr_prepare_power_voltage(void)
+{
+	float volts;
+
+	return MeasurePower(&volts);
+}
+
+static int MeasurePower(float *result)
 {
 	int16_t raw = 0;
 	float volts = 0;
 	SensorEventData_t eventAlarm;
 	int r = AdcBt6_read_power_volts(&raw, &volts);
+	int64_t sampleTime = k_uptime_get();
 	#ifdef CONFIG_LCZ_LWM2M_CLIENT
 	static lcz_lwm2m_client_device_battery_status_t battery_status;
 	#endif
 
 	if (r >= 0) {
-		r = attr_set_signed32(ATTR_ID_power_voltage, volts);
+		r = COUNT_ATTR(attr_set_signed32(ATTR_ID_power_voltage, volts));
 		if (volts > POWER_BAD_VOLTAGE) {
 			eventAlarm.f = volts;
-			SendEvent(SENSOR_EVENT_BATTERY_GOOD, eventAlarm);
+			SendEvent(SENSOR_EVENT_BATTERY_GOOD, eventAlarm,
+				  sampleTime);
 			Flags_Set(FLAG_LOW_BATTERY_ALARM, 0);
 			#ifdef CONFIG_LCZ_LWM2M_CLIENT
 			battery_status = LCZ_LWM2M_CLIENT_DEV_BATT_STAT_NORMAL;
 			#endif
 		} else {
 			eventAlarm.f = volts;
-			SendEvent(SENSOR_EVENT_BATTERY_BAD, eventAlarm);
+			SendEvent(SENSOR_EVENT_BATTERY_BAD, eventAlarm,
+				  sampleTime);
 			Flags_Set(FLAG_LOW_BATTERY_ALARM, 1);
 			#ifdef CONFIG_LCZ_LWM2M_CLIENT
 			battery_status = LCZ_LWM2M_CLIENT_DEV_BATT_STAT_LOW;
@@ -366,58 +538,59 @@ int attr_prepare_power_voltage(void)
 		(void)update_lwm2m_battery(battery_status, volts);
 		#endif
 	}
+	*result = volts;
 	return r;
 }
 
 int attr_prepare_analog_input_1(void)
 {
-	float dummyResult;
+	int32_t dummyResult;
 	return MeasureAnalogInput(ANALOG_CH_1, ADC_PWR_SEQ_SINGLE,
-				  &dummyResult);
+				  &dummyResult, NULL);
 }
 
 int attr_prepare_analog_input_2(void)
 {
-	float dummyResult;
+	int32_t dummyResult;
 	return MeasureAnalogInput(ANALOG_CH_2, ADC_PWR_SEQ_SINGLE,
-				  &dummyResult);
+				  &dummyResult, NULL);
 }
 
 int attr_prepare_analog_input_3(void)
 {
-	float dummyResult;
+	int32_t dummyResult;
 	return MeasureAnalogInput(ANALOG_CH_3, ADC_PWR_SEQ_SINGLE,
-				  &dummyResult);
+				  &dummyResult, NULL);
 }
 
 int attr_prepare_analog_input_4(void)
 {
-	float dummyResult;
+	int32_t dummyResult;
 	return MeasureAnalogInput(ANALOG_CH_4, ADC_PWR_SEQ_SINGLE,
-				  &dummyResult);
+				  &dummyResult, NULL);
 }
 
 int attr_prepare_temperature_result_1(void)
 {
-	float dummyResult;
+	int32_t dummyResult;
 	return MeasureThermistor(THERM_CH_1, ADC_PWR_SEQ_SINGLE, &dummyResult);
 }
 
 int attr_prepare_temperature_result_2(void)
 {
-	float dummyResult;
+	int32_t dummyResult;
 	return MeasureThermistor(THERM_CH_2, ADC_PWR_SEQ_SINGLE, &dummyResult);
 }
 
 int attr_prepare_temperature_result_3(void)
 {
-	float dummyResult;
+	int32_t dummyResult;
 	return MeasureThermistor(THERM_CH_3, ADC_PWR_SEQ_SINGLE, &dummyResult);
 }
 
 int attr_prepare_temperature_result_4(void)
 {
-	float dummyResult;
+	int32_t dummyResult;
 	return MeasureThermistor(THERM_CH_4, ADC_PWR_SEQ_SINGLE, &dummyResult);
 }
 
@@ -453,6 +626,8 @@ static void SensorTaskThread(void *pArg1, void *pArg2, void *pArg3)
 	SensorTaskObj_t *pObj = (SensorTaskObj_t *)pArg1;
 	int r;
 
+	RebuildSensorConfig();
+
 	r = AdcBt6_Init();
 	if (r < 0) {
 		LOG_ERR("BT6 ADC module init error: %d", r);
@@ -482,24 +657,46 @@ SensorTaskAttributeChangedMsgHandler(FwkMsgReceiver_t *pMsgRxer, FwkMsg_t *pMsg)
 {
 	attr_changed_msg_t *pAttrMsg = (attr_changed_msg_t *)pMsg;
 	size_t i;
+	size_t analogIndex;
 	bool updateAnalogInterval = false;
-	uint8_t activeMode = 0;
+	bool rebuildThermistors = false;
 	bool input_config_changed = false;
+	bool rebuild = false;
+
+	for (i = 0; i < pAttrMsg->count; i++) {
+		rebuild |= IsSensorConfigAttr(pAttrMsg->list[i]);
+		input_config_changed |= ChangesInputConfig(pAttrMsg->list[i]);
+	}
+
+	/* Apart from start-up and the input_config_changed flag owned by
+	 * this task, this is the only place the snapshot is rebuilt. It is
+	 * rebuilt once, before the handlers below use it.
+	 */
+	if (input_config_changed) {
+		(void)attr_set_bool(ATTR_ID_input_config_changed, true);
+	}
+	if (rebuild || input_config_changed) {
+		RebuildSensorConfig();
+	}
 
 	for (i = 0; i < pAttrMsg->count; i++) {
 		switch (pAttrMsg->list[i]) {
 		case ATTR_ID_power_sense_interval:
+			/* The reading restarts the grid */
+			CancelSample(SAMPLE_POWER);
 			FRAMEWORK_MSG_CREATE_AND_SEND(FWK_ID_SENSOR_TASK,
 						      FWK_ID_SENSOR_TASK,
 						      FMC_READ_POWER);
 			break;
 
 		case ATTR_ID_temperature_sense_interval:
+			CancelSample(SAMPLE_TEMPERATURE);
 			FRAMEWORK_MSG_CREATE_AND_SEND(FWK_ID_SENSOR_TASK,
 						      FWK_ID_SENSOR_TASK,
 						      FMC_TEMPERATURE_MEASURE);
 			break;
 		case ATTR_ID_analog_sense_interval:
+			CancelSample(SAMPLE_ANALOG);
 			FRAMEWORK_MSG_CREATE_AND_SEND(FWK_ID_SENSOR_TASK,
 						      FWK_ID_SENSOR_TASK,
 						      FMC_ANALOG_MEASURE);
@@ -508,28 +705,46 @@ SensorTaskAttributeChangedMsgHandler(FwkMsgReceiver_t *pMsgRxer, FwkMsg_t *pMsg)
 		case ATTR_ID_digital_input_2_config:
 			FRAMEWORK_MSG_SEND_TO_SELF(FWK_ID_SENSOR_TASK,
 						   FMC_DIGITAL_IN_CONFIG);
-			input_config_changed = true;
 			break;
 		case ATTR_ID_thermistor_config:
 			StartTemperatureInterval();
-			input_config_changed = true;
+			break;
+		case ATTR_ID_sh_offset:
+		case ATTR_ID_therm_1_coefficient_a:
+		case ATTR_ID_therm_2_coefficient_a:
+		case ATTR_ID_therm_3_coefficient_a:
+		case ATTR_ID_therm_4_coefficient_a:
+		case ATTR_ID_therm_1_coefficient_b:
+		case ATTR_ID_therm_2_coefficient_b:
+		case ATTR_ID_therm_3_coefficient_b:
+		case ATTR_ID_therm_4_coefficient_b:
+		case ATTR_ID_therm_1_coefficient_c:
+		case ATTR_ID_therm_2_coefficient_c:
+		case ATTR_ID_therm_3_coefficient_c:
+		case ATTR_ID_therm_4_coefficient_c:
+			rebuildThermistors = true;
 			break;
 		case ATTR_ID_analog_input_1_type:
 		case ATTR_ID_analog_input_2_type:
 		case ATTR_ID_analog_input_3_type:
 		case ATTR_ID_analog_input_4_type:
+			/* The next reading is in different units */
+			analogIndex = pAttrMsg->list[i] -
+				      ATTR_ID_analog_input_1_type;
+			sensorTaskObject.analogReport[analogIndex].valid = false;
+			sensorTaskObject.analogAdaptive.valid &=
+				~BIT(analogIndex);
 			updateAnalogInterval = true;
-			input_config_changed = true;
 			break;
 		case ATTR_ID_config_type:
 			SensorConfigChange(false);
-			input_config_changed = true;
 			break;
 
 		case ATTR_ID_qrtc_last_set:
 			printRTCTime();
 			/* RTC was set by external device */
 			Flags_Set(FLAG_TIME_WAS_SET, 1);
+			RestartSampleGrid();
 			break;
 
 		case ATTR_ID_digital_output_1_state:
@@ -545,24 +760,31 @@ SensorTaskAttributeChangedMsgHandler(FwkMsgReceiver_t *pMsgRxer, FwkMsg_t *pMsg)
 			 * true, and so always routed to the Enter Active
 			 * handler.
 			 */
-			attr_get(ATTR_ID_active_mode, &activeMode,
-				      sizeof(activeMode));
 			FRAMEWORK_MSG_CREATE_AND_SEND(
 				FWK_ID_SENSOR_TASK, FWK_ID_SENSOR_TASK,
-				(!activeMode ? FMC_ENTER_SHELF_MODE :
-						     FMC_ENTER_ACTIVE_MODE));
+				(!pSensorConfig->active_mode ?
+					 FMC_ENTER_SHELF_MODE :
+					 FMC_ENTER_ACTIVE_MODE));
 			break;
 		default:
 			/* Don't do anything - this is a broadcast */
 			break;
 		}
 	}
+	if (rebuildThermistors) {
+		/* Built here rather than on the next conversion, which holds
+		 * the ADC lock.
+		 */
+		AdcBt6_RebuildThermistorTables();
+	}
 	if (updateAnalogInterval == true) {
+		/* Setup the AIN SEL pins on the multiplexer for the Analog pin config */
+		if (AdcBt6_ConfigAinSelects() != 0) {
+			/* Shouldn't get into this failure state */
+			LOG_ERR("AIN SEL Pin Failure");
+		}
 		StartAnalogInterval();
 	}
-	if (input_config_changed == true) {
-		(void)attr_set_bool(ATTR_ID_input_config_changed, true);
-	}
 
 	return DISPATCH_OK;
 }
@@ -585,7 +807,8 @@ SensorTaskDigitalInAlarmMsgHandler(FwkMsgReceiver_t *pMsgRxer, FwkMsg_t *pMsg)
 	}
 
 	eventAlarm.u32 = digitalAlarm;
-	SendEvent(SENSOR_EVENT_DIGITAL_ALARM, eventAlarm);
+	SendEvent(SENSOR_EVENT_DIGITAL_ALARM, eventAlarm,
+		  pSensorMsg->timestamp);
 
 	return DISPATCH_OK;
 }
@@ -652,8 +875,7 @@ static DispatchResult_t ReadPowerMsgHandler(FwkMsgReceiver_t *pMsgRxer,
 {
 	ARG_UNUSED(pMsg);
 	ARG_UNUSED(pMsgRxer);
-	attr_prepare_power_voltage();
-	StartPowerInterval();
+	ReadPower();
 
 	return DISPATCH_OK;
 }
@@ -663,19 +885,7 @@ static DispatchResult_t MeasureTemperatureMsgHandler(FwkMsgReceiver_t *pMsgRxer,
 {
 	ARG_UNUSED(pMsg);
 	ARG_UNUSED(pMsgRxer);
-	size_t index = 0;
-	int r;
-	float temperature;
-
-	for (index = 0; index < TOTAL_THERM_CH; index++) {
-		r = MeasureThermistor(index, ADC_PWR_SEQ_SINGLE, &temperature);
-		if (r == 0) {
-			SendEvent((SensorEventType_t)(SENSOR_EVENT_TEMPERATURE_1 + index),
-				(SensorEventData_t)temperature);
-			(void)update_lwm2m_temperature(index, temperature);
-		}
-	}
-	StartTemperatureInterval();
+	ReadTemperatures();
 
 	return DISPATCH_OK;
 }
@@ -685,17 +895,124 @@ static DispatchResult_t AnalogReadMsgHandler(FwkMsgReceiver_t *pMsgRxer,
 {
 	ARG_UNUSED(pMsg);
 	ARG_UNUSED(pMsgRxer);
-	size_t index = 0;
+	ReadAnalogInputs();
+
+	return DISPATCH_OK;
+}
+
+static DispatchResult_t AnalogSettledMsgHandler(FwkMsgReceiver_t *pMsgRxer,
+						FwkMsg_t *pMsg)
+{
+	ARG_UNUSED(pMsgRxer);
+	AnalogSettledMsg_t *pSettledMsg = (AnalogSettledMsg_t *)pMsg;
+	const sensor_config_t *cfg = pSensorConfig;
+	enum analog_input_1_type config;
+	int32_t analogValue;
+	size_t index;
 	int r;
-	float analogValue;
 
-	for (index = 0; index < TOTAL_ANALOG_CH; index++) {
-		r = MeasureAnalogInput(index, ADC_PWR_SEQ_SINGLE, &analogValue);
-		if (r == 0) {
-			SendEvent(AnalogConfigType(index), (SensorEventData_t)analogValue);
+	/* The results arrived after the timeout restarted the schedule */
+	if (!sensorTaskObject.analogSettling) {
+		LOG_WRN("Discarding late powered analog inputs");
+		return DISPATCH_OK;
+	}
+	k_timer_stop(&analogSettleTimer);
+	sensorTaskObject.analogSettling = false;
+
+	if (pSettledMsg->status < 0) {
+		LOG_ERR("Powered analog inputs failed: %d", pSettledMsg->status);
+	} else {
+		for (index = 0; index < TOTAL_ANALOG_CH; index++) {
+			if ((pSettledMsg->status & BIT(index)) == 0) {
+				continue;
+			}
+			/* The input may have been reconfigured while the
+			 * sensor was settling.
+			 */
+			config = cfg->analog_input_type[index];
+			if (AnalogAdcType(config) !=
+			    pSettledMsg->plan.type[index]) {
+				LOG_DBG("Analog input %d changed while settling",
+					index + 1);
+				continue;
+			}
+			r = ConvertAnalogInput(index, config,
+					       pSettledMsg->raw[index],
+					       &analogValue);
+			if (r == 0) {
+				SendAnalogEvent(index, analogValue,
+						pSettledMsg->timestamp);
+				AdaptiveSample(
+					&sensorTaskObject.analogAdaptive, index,
+					analogValue,
+					cfg->analog_adaptive.slope_threshold);
+			}
 		}
 	}
+
+	AdaptiveInterval_Update(&sensorTaskObject.analogAdaptive,
+				&cfg->analog_adaptive);
 	StartAnalogInterval();
+	LogAttrCalls();
+
+	return DISPATCH_OK;
+}
+
+static DispatchResult_t AnalogTimeoutMsgHandler(FwkMsgReceiver_t *pMsgRxer,
+						FwkMsg_t *pMsg)
+{
+	ARG_UNUSED(pMsgRxer);
+	ARG_UNUSED(pMsg);
+
+	if (sensorTaskObject.analogSettling) {
+		LOG_ERR("Powered analog inputs timed out");
+		sensorTaskObject.analogSettling = false;
+		AdaptiveInterval_Update(&sensorTaskObject.analogAdaptive,
+					&pSensorConfig->analog_adaptive);
+		StartAnalogInterval();
+	}
+
+	return DISPATCH_OK;
+}
+
+static DispatchResult_t SampleDueMsgHandler(FwkMsgReceiver_t *pMsgRxer,
+					    FwkMsg_t *pMsg)
+{
+	ARG_UNUSED(pMsg);
+	ARG_UNUSED(pMsgRxer);
+	sample_schedule_t *schedule = &sensorTaskObject.schedule;
+	int64_t now = k_uptime_get();
+	int64_t window = now + CONFIG_SENSOR_TASK_WAKEUP_SLACK_MS;
+	uint32_t due;
+	size_t i;
+
+	CountWakeup(now);
+
+	/* Everything that is due within the slack window is taken now so
+	 * that the next wakeup isn't a few seconds away.
+	 */
+	due = SampleSchedule_Due(schedule->deadline, NUMBER_OF_SAMPLE_GROUPS,
+				 window);
+	for (i = 0; i < NUMBER_OF_SAMPLE_GROUPS; i++) {
+		if (due & BIT(i)) {
+			RecordLateness(i, now);
+			schedule->anchor[i] = schedule->deadline[i];
+			schedule->deadline[i] = 0;
+		}
+	}
+
+	if (due & BIT(SAMPLE_POWER)) {
+		ReadPower();
+	}
+	if (due & BIT(SAMPLE_TEMPERATURE)) {
+		ReadTemperatures();
+	}
+	if (due & BIT(SAMPLE_ANALOG)) {
+		ReadAnalogInputs();
+	}
+	LogAttrCalls();
+
+	ArmSampleTimer();
 
 	return DISPATCH_OK;
 }
@@ -732,6 +1049,8 @@ static DispatchResult_t EnterShelfModeMsgHandler(FwkMsgReceiver_t *pMsgRxer,
 	 * advertising altogether.
 	 */
 	Flags_Set(FLAG_ACTIVE_MODE, 0);
+	FRAMEWORK_MSG_CREATE_AND_SEND(FWK_ID_SENSOR_TASK, FWK_ID_BLE_TASK,
+				      FMC_ENTER_SHELF_MODE);
 	FRAMEWORK_MSG_CREATE_AND_SEND(FWK_ID_SENSOR_TASK, FWK_ID_CONTROL_TASK,
 				      FMC_SOFTWARE_RESET);
 
@@ -751,6 +1070,7 @@ static DispatchResult_t ClearInputConfigChangedMsgHandler(FwkMsgReceiver_t *pMsg
 	 * into account.
 	 */
 	(void)attr_set_bool(ATTR_ID_input_config_changed, false);
+	RebuildSensorConfig();
 
 	return DISPATCH_OK;
 }
@@ -761,6 +1081,173 @@ static void LoadSensorConfiguration(void)
 	FRAMEWORK_MSG_SEND_TO_SELF(FWK_ID_SENSOR_TASK, FMC_DIGITAL_IN_CONFIG);
 }
 
+/* Read every attribute used by the measurement paths into a new snapshot and
+ * publish it.
+ */
+static void RebuildSensorConfig(void)
+{
+	sensor_config_t snapshot;
+	sensor_config_t *next = &snapshot;
+	k_spinlock_key_t key;
+	size_t i;
+
+	next->active_mode = ConfigBool(ATTR_ID_active_mode);
+	next->input_config_changed =
+		ConfigBool(ATTR_ID_input_config_changed);
+	next->thermistor_config =
+		ConfigUint32(ATTR_ID_thermistor_config, 0) & ALL_THERMISTORS;
+	for (i = 0; i < TOTAL_ANALOG_CH; i++) {
+		next->analog_input_type[i] = ConfigUint32(
+			ATTR_ID_analog_input_1_type + i, ANALOG_INPUT_1_TYPE_UNUSED);
+	}
+	next->power_sense_interval =
+		ConfigUint32(ATTR_ID_power_sense_interval, 0);
+	next->temperature_sense_interval =
+		ConfigUint32(ATTR_ID_temperature_sense_interval, 0);
+	next->analog_sense_interval =
+		ConfigUint32(ATTR_ID_analog_sense_interval, 0);
+	for (i = 0; i < TOTAL_THERM_CH; i++) {
+		next->temperature_deadband[i] =
+			ConfigMilli(ATTR_ID_temperature_1_deadband + i);
+		next->temperature_deadband_percent[i] = ConfigMilli(
+			ATTR_ID_temperature_1_deadband_percent + i);
+	}
+	for (i = 0; i < TOTAL_ANALOG_CH; i++) {
+		next->analog_deadband[i] =
+			ConfigMilli(ATTR_ID_analog_input_1_deadband + i);
+		next->analog_deadband_percent[i] = ConfigMilli(
+			ATTR_ID_analog_input_1_deadband_percent + i);
+	}
+	next->deadband_heartbeat =
+		ConfigUint32(ATTR_ID_deadband_heartbeat, 0);
+	next->temperature_adaptive.min =
+		ConfigUint32(ATTR_ID_temperature_sense_interval_min, 0);
+	next->temperature_adaptive.max =
+		ConfigUint32(ATTR_ID_temperature_sense_interval_max, 0);
+	next->temperature_adaptive.slope_threshold =
+		ConfigMilli(ATTR_ID_temperature_slope_threshold);
+	next->analog_adaptive.min =
+		ConfigUint32(ATTR_ID_analog_sense_interval_min, 0);
+	next->analog_adaptive.max =
+		ConfigUint32(ATTR_ID_analog_sense_interval_max, 0);
+	next->analog_adaptive.slope_threshold =
+		ConfigMilli(ATTR_ID_analog_slope_threshold);
+	next->power_adaptive.min =
+		ConfigUint32(ATTR_ID_power_sense_interval_min, 0);
+	next->power_adaptive.max =
+		ConfigUint32(ATTR_ID_power_sense_interval_max, 0);
+	next->power_adaptive.slope_threshold =
+		ConfigMilli(ATTR_ID_power_slope_threshold);
+
+	key = k_spin_lock(&sensorConfigLock);
+	sensorConfig = snapshot;
+	k_spin_unlock(&sensorConfigLock, key);
+
+	sensorTaskObject.configRebuilds += 1;
+	LOG_DBG("Config snapshot %u", sensorTaskObject.configRebuilds);
+}
+
+/* Copy the snapshot. Any thread may call this. */
+static void SensorConfigGet(sensor_config_t *cfg)
+{
+	k_spinlock_key_t key = k_spin_lock(&sensorConfigLock);
+
+	*cfg = sensorConfig;
+	k_spin_unlock(&sensorConfigLock, key);
+}
+
+/* The count includes snapshot rebuilds and attr_prepare_* reads made since
+ * the last scan.
+ */
+static void LogAttrCalls(void)
+{
+	atomic_val_t calls = atomic_set(&sensorTaskObject.attrCalls, 0);
+
+	LOG_DBG("Scan made %ld attribute calls", (long)calls);
+}
+
+static uint32_t ConfigUint32(attr_id_t id, uint32_t alt)
+{
+	return COUNT_ATTR(attr_get_uint32(id, alt));
+}
+
+static bool ConfigBool(attr_id_t id)
+{
+	return COUNT_ATTR(attr_get_bool(id));
+}
+
+/* Float settings are converted to milli-units once per snapshot */
+static int32_t ConfigMilli(attr_id_t id)
+{
+	float value = COUNT_ATTR(attr_get_float(id, 0.0));
+
+	return ToMilli(MIN(value, (float)(INT32_MAX / ADC_BT6_MILLI)));
+}
+
+static int32_t ToMilli(float value)
+{
+	value *= ADC_BT6_MILLI;
+	return (int32_t)((value >= 0) ? (value + 0.5f) : (value - 0.5f));
+}
+
+static bool InAttrRange(attr_id_t id, attr_id_t first, size_t count)
+{
+	return (id >= first) && (id < (first + count));
+}
+
+/* The attributes read by RebuildSensorConfig */
+static bool IsSensorConfigAttr(attr_id_t id)
+{
+	switch (id) {
+	case ATTR_ID_active_mode:
+	case ATTR_ID_input_config_changed:
+	case ATTR_ID_thermistor_config:
+	case ATTR_ID_power_sense_interval:
+	case ATTR_ID_temperature_sense_interval:
+	case ATTR_ID_analog_sense_interval:
+	case ATTR_ID_deadband_heartbeat:
+	case ATTR_ID_temperature_sense_interval_min:
+	case ATTR_ID_temperature_sense_interval_max:
+	case ATTR_ID_temperature_slope_threshold:
+	case ATTR_ID_analog_sense_interval_min:
+	case ATTR_ID_analog_sense_interval_max:
+	case ATTR_ID_analog_slope_threshold:
+	case ATTR_ID_power_sense_interval_min:
+	case ATTR_ID_power_sense_interval_max:
+	case ATTR_ID_power_slope_threshold:
+		return true;
+	default:
+		return InAttrRange(id, ATTR_ID_analog_input_1_type,
+				   TOTAL_ANALOG_CH) ||
+		       InAttrRange(id, ATTR_ID_temperature_1_deadband,
+				   TOTAL_THERM_CH) ||
+		       InAttrRange(id, ATTR_ID_temperature_1_deadband_percent,
+				   TOTAL_THERM_CH) ||
+		       InAttrRange(id, ATTR_ID_analog_input_1_deadband,
+				   TOTAL_ANALOG_CH) ||
+		       InAttrRange(id, ATTR_ID_analog_input_1_deadband_percent,
+				   TOTAL_ANALOG_CH);
+	}
+}
+
+/* Changes that block the LwM2M telemetry until the configuration is stable */
+static bool ChangesInputConfig(attr_id_t id)
+{
+	switch (id) {
+	case ATTR_ID_digital_input_1_config:
+	case ATTR_ID_digital_input_2_config:
+	case ATTR_ID_thermistor_config:
+	case ATTR_ID_analog_input_1_type:
+	case ATTR_ID_analog_input_2_type:
+	case ATTR_ID_analog_input_3_type:
+	case ATTR_ID_analog_input_4_type:
+	case ATTR_ID_config_type:
+		return true;
+	default:
+		return false;
+	}
+}
+
 static void ClearInputConfigChangedFlag(void)
 {
 	FRAMEWORK_MSG_SEND_TO_SELF(FWK_ID_SENSOR_TASK, FMC_CLEAR_INPUT_CONFIG_CHANGED);
@@ -885,97 +1372,69 @@ static void UpdateMagnet(void)
 
 static void InitializeIntervalTimers(void)
 {
-	/* Power Interval timer */
-	k_timer_init(&powerTimer, powerTimerCallbackIsr, NULL);
-	StartPowerInterval();
+	k_timer_init(&sampleTimer, sampleTimerCallbackIsr, NULL);
+	k_timer_init(&analogSettleTimer, analogSettleTimerCallbackIsr, NULL);
+	sensorTaskObject.schedule.hourStart = k_uptime_get();
 
-	/* Temperture Interval timer */
-	k_timer_init(&temperatureReadTimer, temperatureReadTimerCallbackIsr,
-		     NULL);
+	StartPowerInterval();
 	StartTemperatureInterval();
-
-	/* Analog Interval timer */
-	k_timer_init(&analogReadTimer, analogReadTimerCallbackIsr, NULL);
 	StartAnalogInterval();
 }
 
 static void StartAnalogInterval(void)
 {
-	uint8_t analog1ConfigEnable;
-	uint8_t analog2ConfigEnable;
-	uint8_t analog3ConfigEnable;
-	uint8_t analog4ConfigEnable;
-	uint8_t activeModeStatus = 0;
-	uint32_t analogTimer = 0;
-
-	attr_get(ATTR_ID_active_mode, &activeModeStatus,
-		 sizeof(activeModeStatus));
-
-	attr_get(ATTR_ID_analog_input_1_type, &analog1ConfigEnable,
-		 sizeof(analog1ConfigEnable));
-	attr_get(ATTR_ID_analog_input_2_type, &analog2ConfigEnable,
-		 sizeof(analog2ConfigEnable));
-	attr_get(ATTR_ID_analog_input_3_type, &analog3ConfigEnable,
-		 sizeof(analog3ConfigEnable));
-	attr_get(ATTR_ID_analog_input_4_type, &analog4ConfigEnable,
-		 sizeof(analog4ConfigEnable));
-	/* Check if the timer is already running */
-	analogTimer = k_timer_remaining_get(&analogReadTimer);
-
-	if ((activeModeStatus == true) && (analogTimer == 0) &&
-	    ((analog1ConfigEnable > 0) || (analog2ConfigEnable > 0) ||
-	     (analog3ConfigEnable > 0) || (analog4ConfigEnable > 0))) {
-		uint32_t intervalSeconds = 0;
-		attr_copy_uint32(&intervalSeconds,
-				 ATTR_ID_analog_sense_interval);
-		if (intervalSeconds != 0) {
-			k_timer_start(&analogReadTimer,
-				      K_SECONDS(intervalSeconds), K_NO_WAIT);
+	const sensor_config_t *cfg = pSensorConfig;
+	bool analogEnabled = false;
+	uint32_t interval =
+		AdaptiveInterval_Get(&sensorTaskObject.analogAdaptive,
+				     &cfg->analog_adaptive,
+				     cfg->analog_sense_interval);
+	size_t i;
+
+	for (i = 0; i < TOTAL_ANALOG_CH; i++) {
+		if (cfg->analog_input_type[i] > 0) {
+			analogEnabled = true;
+		}
+	}
+	/* Don't move a reading that is already scheduled */
+	if ((cfg->active_mode == true) && !SampleScheduled(SAMPLE_ANALOG) &&
+	    analogEnabled) {
+		if (interval != 0) {
+			ScheduleSample(SAMPLE_ANALOG, interval);
 		}
 	}
 }
 
 static void StartTemperatureInterval(void)
 {
-	uint8_t thermConfigEnable;
-	uint8_t activeModeStatus = 0;
-	uint32_t tempTimer = 0;
-
-	attr_get(ATTR_ID_active_mode, &activeModeStatus,
-		 sizeof(activeModeStatus));
-	attr_get(ATTR_ID_thermistor_config, &thermConfigEnable,
-		 sizeof(thermConfigEnable));
-
-	/* Check if the timer is already running */
-	tempTimer = k_timer_remaining_get(&temperatureReadTimer);
-	if ((activeModeStatus == true) && (thermConfigEnable > 0) &&
-	    (tempTimer == 0)) {
-		uint32_t intervalSeconds = 0;
-		attr_copy_uint32(&intervalSeconds,
-				 ATTR_ID_temperature_sense_interval);
-		if (intervalSeconds != 0) {
-			k_timer_start(&temperatureReadTimer,
-				      K_SECONDS(intervalSeconds), K_NO_WAIT);
+	const sensor_config_t *cfg = pSensorConfig;
+	uint32_t interval =
+		AdaptiveInterval_Get(&sensorTaskObject.temperatureAdaptive,
+				     &cfg->temperature_adaptive,
+				     cfg->temperature_sense_interval);
+
+	/* Don't move a reading that is already scheduled */
+	if ((cfg->active_mode == true) && (cfg->thermistor_config > 0) &&
+	    !SampleScheduled(SAMPLE_TEMPERATURE)) {
+		if (interval != 0) {
+			ScheduleSample(SAMPLE_TEMPERATURE, interval);
 		}
 	}
 }
 
 static void StartPowerInterval(void)
 {
-	uint8_t activeModeStatus = 0;
-
-	attr_get(ATTR_ID_active_mode, &activeModeStatus,
-		 sizeof(activeModeStatus));
-
-	if (activeModeStatus == true) {
-		uint32_t intervalSeconds = 0;
-		attr_copy_uint32(&intervalSeconds,
-				 ATTR_ID_power_sense_interval);
-		if (intervalSeconds != 0) {
-			k_timer_start(&powerTimer, K_SECONDS(intervalSeconds),
-				      K_NO_WAIT);
+	const sensor_config_t *cfg = pSensorConfig;
+	uint32_t interval =
+		AdaptiveInterval_Get(&sensorTaskObject.powerAdaptive,
+				     &cfg->power_adaptive,
+				     cfg->power_sense_interval);
+
+	if (cfg->active_mode == true) {
+		if (interval != 0) {
+			ScheduleSample(SAMPLE_POWER, interval);
 		} else {
-			k_timer_stop(&powerTimer);
+			CancelSample(SAMPLE_POWER);
 		}
 	}
 }
@@ -986,127 +1445,381 @@ static void DisableAnalogReadings(void)
 	attr_set_uint32(ATTR_ID_analog_input_2_type, ANALOG_INPUT_1_TYPE_UNUSED);
 	attr_set_uint32(ATTR_ID_analog_input_3_type, ANALOG_INPUT_1_TYPE_UNUSED);
 	attr_set_uint32(ATTR_ID_analog_input_4_type, ANALOG_INPUT_1_TYPE_UNUSED);
-	/* Turn off the timer */
-	k_timer_stop(&analogReadTimer);
+	CancelSample(SAMPLE_ANALOG);
 }
 
 static void DisableThermistorReadings(void)
 {
 	uint32_t thermistorsConfig = 0;
 	attr_set_uint32(ATTR_ID_thermistor_config, thermistorsConfig);
-	/* Turn off the timer */
-	k_timer_stop(&temperatureReadTimer);
+	CancelSample(SAMPLE_TEMPERATURE);
+}
+
+/* Groups that are due close together share a wakeup because the timer
+ * handler takes everything within the slack window.
+ */
+static void ScheduleSample(sample_group_t group, uint32_t interval)
+{
+	sample_schedule_t *schedule = &sensorTaskObject.schedule;
+	int64_t epochMs = (int64_t)lcz_qrtc_get_epoch() * MSEC_PER_SEC;
+	uint32_t missed;
+
+	schedule->deadline[group] = SampleSchedule_Deadline(
+		schedule->anchor[group], k_uptime_get(), epochMs,
+		(int64_t)interval * MSEC_PER_SEC, &missed);
+	if (missed > 0) {
+		schedule->overruns[group] += missed;
+		(void)COUNT_ATTR(
+			attr_set_uint32(SAMPLE_STATS_ID[group].overruns,
+					schedule->overruns[group]));
+		LOG_WRN("Sample group %d skipped %u deadlines", group,
+			missed);
+	}
+	ArmSampleTimer();
+}
+
+static void CancelSample(sample_group_t group)
+{
+	sensorTaskObject.schedule.deadline[group] = 0;
+	sensorTaskObject.schedule.anchor[group] = 0;
+	ArmSampleTimer();
+}
+
+/* Line all of the readings up with the qrtc again */
+static void RestartSampleGrid(void)
+{
+	size_t i;
+
+	for (i = 0; i < NUMBER_OF_SAMPLE_GROUPS; i++) {
+		CancelSample(i);
+	}
+	StartPowerInterval();
+	StartTemperatureInterval();
+	StartAnalogInterval();
+}
+
+static void RecordLateness(sample_group_t group, int64_t now)
+{
+	sample_schedule_t *schedule = &sensorTaskObject.schedule;
+	int32_t lateness = (int32_t)(now - schedule->deadline[group]);
+	uint32_t jitter = (uint32_t)abs(lateness);
+
+	(void)COUNT_ATTR(
+		attr_set_signed32(SAMPLE_STATS_ID[group].lateness, lateness));
+	if (jitter > schedule->jitterMax[group]) {
+		schedule->jitterMax[group] = jitter;
+		(void)COUNT_ATTR(attr_set_uint32(
+			SAMPLE_STATS_ID[group].jitterMax, jitter));
+	}
+}
+
+static bool SampleScheduled(sample_group_t group)
+{
+	return (sensorTaskObject.schedule.deadline[group] != 0);
+}
+
+/* The timer always runs to the earliest deadline */
+static void ArmSampleTimer(void)
+{
+	sample_schedule_t *schedule = &sensorTaskObject.schedule;
+	int64_t next = SampleSchedule_Earliest(schedule->deadline,
+					       NUMBER_OF_SAMPLE_GROUPS);
+
+	if (next == 0) {
+		k_timer_stop(&sampleTimer);
+	} else {
+		k_timer_start(&sampleTimer,
+			      K_MSEC(MAX(next - k_uptime_get(), 0)), K_NO_WAIT);
+	}
+}
+
+static void CountWakeup(int64_t now)
+{
+	const int64_t hour = MIN_PER_HOUR * SEC_PER_MIN * MSEC_PER_SEC;
+	sample_schedule_t *schedule = &sensorTaskObject.schedule;
+	int64_t elapsed = now - schedule->hourStart;
+	uint32_t perHour;
+
+	schedule->wakeups += 1;
+	schedule->hourWakeups += 1;
+	/* Wakeups can be further apart than an hour, so scale the count by
+	 * the window that actually elapsed
+	 */
+	if (elapsed >= hour) {
+		perHour = SampleSchedule_PerHour(schedule->hourWakeups,
+						 elapsed);
+		(void)COUNT_ATTR(attr_set_uint32(
+			ATTR_ID_sample_wakeups_per_hour, perHour));
+		schedule->hourWakeups = 0;
+		schedule->hourStart = now;
+	}
+	(void)COUNT_ATTR(
+		attr_set_uint32(ATTR_ID_sample_wakeups, schedule->wakeups));
+}
+
+static void ReadPower(void)
+{
+	AdaptiveState_t *adaptive = &sensorTaskObject.powerAdaptive;
+	const sensor_config_t *cfg = pSensorConfig;
+	float volts;
+
+	if (MeasurePower(&volts) >= 0) {
+		AdaptiveSample(adaptive, 0, ToMilli(volts),
+			       cfg->power_adaptive.slope_threshold);
+	}
+	AdaptiveInterval_Update(adaptive, &cfg->power_adaptive);
+	StartPowerInterval();
+}
+
+static void ReadTemperatures(void)
+{
+	size_t index = 0;
+	int sampled;
+	int r;
+	int32_t temperature;
+	int16_t raw[NUMBER_OF_ANALOG_INPUTS];
+	int64_t sampleTime;
+	AdcBt6ScanPlan_t plan;
+	const sensor_config_t *cfg = pSensorConfig;
+
+	/* All enabled thermistors are read with the circuit powered once */
+	plan.channel_mask = cfg->thermistor_config;
+	for (index = 0; index < TOTAL_THERM_CH; index++) {
+		plan.type[index] = ADC_TYPE_THERMISTOR;
+	}
+
+	sampled = AdcBt6_MeasureScan(&plan, raw);
+	sampleTime = k_uptime_get();
+	if (sampled < 0) {
+		LOG_ERR("Thermistor scan error: %d", sampled);
+		sampled = 0;
+	}
+
+	for (index = 0; index < TOTAL_THERM_CH; index++) {
+		if ((sampled & BIT(index)) == 0) {
+			continue;
+		}
+		temperature = ADC_CONVERT_MILLI(ConvertThermToTemperature,
+						index, raw[index], 1);
+		r = COUNT_ATTR(attr_set_float(
+			ATTR_ID_temperature_result_1 + index,
+			MILLI_TO_FLOAT(temperature)));
+		if (r == 0) {
+			SendTemperatureEvent(index, temperature, sampleTime);
+			(void)update_lwm2m_temperature(
+				index, MILLI_TO_FLOAT(temperature));
+		}
+		AdaptiveSample(&sensorTaskObject.temperatureAdaptive, index,
+			       temperature,
+			       cfg->temperature_adaptive.slope_threshold);
+	}
+	AdaptiveInterval_Update(&sensorTaskObject.temperatureAdaptive,
+				&cfg->temperature_adaptive);
+	StartTemperatureInterval();
+}
+
+static void ReadAnalogInputs(void)
+{
+	AdcBt6ScanPlan_t plan = { 0 };
+	const sensor_config_t *cfg = pSensorConfig;
+	AdcMeasurementType_t type;
+	size_t index = 0;
+	int r;
+	int32_t analogValue;
+	int64_t sampleTime;
+
+	if (sensorTaskObject.analogSettling) {
+		LOG_DBG("Analog scan already in progress");
+		return;
+	}
+
+	/* Powered sensors are grouped so that the 5V and B+ rails are
+	 * enabled once and the warm-up is paid once per scan.
+	 */
+	for (index = 0; index < TOTAL_ANALOG_CH; index++) {
+		type = AnalogAdcType(cfg->analog_input_type[index]);
+		if (type == ADC_TYPE_PRESSURE || type == ADC_TYPE_ULTRASONIC) {
+			plan.channel_mask |= BIT(index);
+			plan.type[index] = type;
+		}
+	}
+
+	if (plan.channel_mask != 0) {
+		r = AdcBt6_MeasureSettled(&plan, FWK_ID_SENSOR_TASK);
+		if (r == 0) {
+			sensorTaskObject.analogSettling = true;
+			k_timer_start(&analogSettleTimer,
+				      K_MSEC(ANALOG_SETTLE_TIMEOUT_MS),
+				      K_NO_WAIT);
+		} else {
+			/* Measuring them here would block for the settle time,
+			 * so they are skipped until the next scheduled scan.
+			 */
+			LOG_ERR("Unable to start powered analog inputs: %d", r);
+		}
+	}
+
+	/* The other inputs are measured while the sensors settle */
+	for (index = 0; index < TOTAL_ANALOG_CH; index++) {
+		if (plan.channel_mask & BIT(index)) {
+			continue;
+		}
+		r = MeasureAnalogInput(index, ADC_PWR_SEQ_SINGLE, &analogValue,
+				       &sampleTime);
+		if (r == 0) {
+			SendAnalogEvent(index, analogValue, sampleTime);
+			AdaptiveSample(&sensorTaskObject.analogAdaptive, index,
+				       analogValue,
+				       cfg->analog_adaptive.slope_threshold);
+		}
+	}
+
+	if (!sensorTaskObject.analogSettling) {
+		AdaptiveInterval_Update(&sensorTaskObject.analogAdaptive,
+					&cfg->analog_adaptive);
+		StartAnalogInterval();
+	}
+}
+
+static AdcMeasurementType_t AnalogAdcType(enum analog_input_1_type config)
+{
+	switch (config) {
+	case ANALOG_INPUT_1_TYPE_VOLTAGE_0V_TO_10V_DC:
+		return ADC_TYPE_VOLTAGE;
+	case ANALOG_INPUT_1_TYPE_CURRENT_4MA_TO_20MA:
+		return ADC_TYPE_CURRENT;
+	case ANALOG_INPUT_1_TYPE_PRESSURE:
+		return ADC_TYPE_PRESSURE;
+	case ANALOG_INPUT_1_TYPE_ULTRASONIC:
+		return ADC_TYPE_ULTRASONIC;
+	case ANALOG_INPUT_1_TYPE_AC_CURRENT_20A:
+	case ANALOG_INPUT_1_TYPE_AC_CURRENT_150A:
+	case ANALOG_INPUT_1_TYPE_AC_CURRENT_500A:
+		/* Configured for a voltage measurement */
+		return ADC_TYPE_VOLTAGE;
+	default:
+		return NUMBER_OF_ADC_TYPES;
+	}
 }
 
 static int MeasureAnalogInput(size_t channel, AdcPwrSequence_t power,
-			      float *result)
+			      int32_t *result, int64_t *sampleTime)
 {
 	int r = -EPERM;
 	int16_t raw = 0;
-	*result = 0.0;
-
-	/* Setup the AIN SEL pins on the multiplexer for the Analog pin config */
-	r = AdcBt6_ConfigAinSelects();
-	if (r == 0) {
-		attr_id_t base = ATTR_ID_analog_input_1_type;
-		enum analog_input_1_type config = attr_get_uint32(base +
-								  channel, 0);
-
-		switch (config) {
-		case ANALOG_INPUT_1_TYPE_VOLTAGE_0V_TO_10V_DC:
-			r = AdcBt6_Measure(&raw, channel, ADC_TYPE_VOLTAGE,
-					   power);
-			if (r >= 0) {
-				*result = AdcBt6_ConvertVoltage(channel, raw);
-				/* Convert to miliVolts */
-				*result = *result * 1000;
-			}
-			break;
+	*result = 0;
 
-		case ANALOG_INPUT_1_TYPE_CURRENT_4MA_TO_20MA:
-			r = AdcBt6_Measure(&raw, channel, ADC_TYPE_CURRENT,
-					   power);
-			if (r >= 0) {
-				*result = AdcBt6_ConvertCurrent(channel, raw);
-				(void)update_lwm2m_current(channel, *result);
-			}
-			break;
-
-		case ANALOG_INPUT_1_TYPE_PRESSURE:
-			r = AdcBt6_Measure(&raw, channel, ADC_TYPE_PRESSURE,
-					   power);
-			if (r >= 0) {
-				*result = AdcBt6_ConvertPressure(channel, raw);
-				(void)update_lwm2m_pressure(channel, *result);
-			}
-			break;
-
-		case ANALOG_INPUT_1_TYPE_ULTRASONIC:
-			r = AdcBt6_Measure(&raw, channel, ADC_TYPE_ULTRASONIC,
-					   power);
-			if (r >= 0) {
-				*result = AdcBt6_ConvertUltrasonic(channel, raw);
-				(void)update_lwm2m_fill_level(channel, *result);
-			}
-			break;
+	/* The AIN SEL pins are updated by the attribute changed handler when an
+	 * analog input type changes. This also runs from the attr_prepare_*
+	 * callbacks on other threads, so the type is taken from a copy of the
+	 * snapshot.
+	 */
+	sensor_config_t cfg;
+	enum analog_input_1_type config;
+	AdcMeasurementType_t type;
 
-		case ANALOG_INPUT_1_TYPE_AC_CURRENT_20A:
-			/* Configured for a voltage measurement */
-			r = AdcBt6_Measure(&raw, channel, ADC_TYPE_VOLTAGE, power);
-			if (r >= 0) {
-				*result = AdcBt6_ConvertACCurrent20(channel, raw);
-				(void)update_lwm2m_current(channel, *result);
-			}
-			break;
+	SensorConfigGet(&cfg);
+	config = cfg.analog_input_type[channel];
+	type = AnalogAdcType(config);
 
-		case ANALOG_INPUT_1_TYPE_AC_CURRENT_150A:
-			/* Configured for a voltage measurement */
-			r = AdcBt6_Measure(&raw, channel, ADC_TYPE_VOLTAGE,
-					   power);
-			if (r >= 0) {
-				*result = AdcBt6_ConvertACCurrent150(channel, raw);
-				(void)update_lwm2m_current(channel, *result);
-			}
-			break;
+	switch (config) {
+	case ANALOG_INPUT_1_TYPE_AC_CURRENT_20A:
+	case ANALOG_INPUT_1_TYPE_AC_CURRENT_150A:
+	case ANALOG_INPUT_1_TYPE_AC_CURRENT_500A:
+		r = AdcBt6_MeasureRms(&raw, channel, type, power);
+		break;
 
-		case ANALOG_INPUT_1_TYPE_AC_CURRENT_500A:
-			/* Configured for a voltage measurement */
-			r = AdcBt6_Measure(&raw, channel, ADC_TYPE_VOLTAGE, power);
-			if (r >= 0) {
-				*result = AdcBt6_ConvertACCurrent500(channel, raw);
-				(void)update_lwm2m_current(channel, *result);
-			}
-			break;
-		default:
-			LOG_DBG("Analog input channel %d disabled", channel + 1);
+	default:
+		if (type < NUMBER_OF_ADC_TYPES) {
+			r = AdcBt6_Measure(&raw, channel, type, power);
+		} else {
+			LOG_DBG("Analog input channel %d disabled",
+				channel + 1);
 			r = -ENODEV;
-			break;
 		}
+		break;
+	}
 
-		if (r >= 0) {
-			r = attr_set_float(ATTR_ID_analog_input_1 + channel, *result);
-		}
-	} else {
-		/* Shouldn't get into this failure state */
-		LOG_ERR("AIN SEL Pin Failure");
+	if (sampleTime != NULL) {
+		*sampleTime = k_uptime_get();
+	}
+
+	if (r >= 0) {
+		r = ConvertAnalogInput(channel, config, raw, result);
 	}
 	return r;
 }
 
+/* Convert, publish to LwM2M and save the result of an analog measurement.
+ * The result is in milli-units of the attribute.
+ */
+static int ConvertAnalogInput(size_t channel,
+			      enum analog_input_1_type config, int16_t raw,
+			      int32_t *result)
+{
+	switch (config) {
+	case ANALOG_INPUT_1_TYPE_VOLTAGE_0V_TO_10V_DC:
+		/* The attribute is in miliVolts */
+		*result = ADC_CONVERT_MILLI(ConvertVoltage, channel, raw,
+					    ADC_BT6_MILLI);
+		break;
+
+	case ANALOG_INPUT_1_TYPE_CURRENT_4MA_TO_20MA:
+		*result = ADC_CONVERT_MILLI(ConvertCurrent, channel, raw, 1);
+		(void)update_lwm2m_current(channel, MILLI_TO_FLOAT(*result));
+		break;
+
+	case ANALOG_INPUT_1_TYPE_PRESSURE:
+		*result = ADC_CONVERT_MILLI(ConvertPressure, channel, raw, 1);
+		(void)update_lwm2m_pressure(channel, MILLI_TO_FLOAT(*result));
+		break;
+
+	case ANALOG_INPUT_1_TYPE_ULTRASONIC:
+		*result = ADC_CONVERT_MILLI(ConvertUltrasonic, channel, raw, 1);
+		(void)update_lwm2m_fill_level(channel, MILLI_TO_FLOAT(*result));
+		break;
+
+	case ANALOG_INPUT_1_TYPE_AC_CURRENT_20A:
+		*result = ADC_CONVERT_MILLI(ConvertACCurrent20, channel,
+					    raw, 1);
+		(void)update_lwm2m_current(channel, MILLI_TO_FLOAT(*result));
+		break;
+
+	case ANALOG_INPUT_1_TYPE_AC_CURRENT_150A:
+		*result = ADC_CONVERT_MILLI(ConvertACCurrent150, channel,
+					    raw, 1);
+		(void)update_lwm2m_current(channel, MILLI_TO_FLOAT(*result));
+		break;
+
+	case ANALOG_INPUT_1_TYPE_AC_CURRENT_500A:
+		*result = ADC_CONVERT_MILLI(ConvertACCurrent500, channel,
+					    raw, 1);
+		(void)update_lwm2m_current(channel, MILLI_TO_FLOAT(*result));
+		break;
+
+	default:
+		return -ENODEV;
+	}
+
+	return COUNT_ATTR(attr_set_float(ATTR_ID_analog_input_1 + channel,
+					 MILLI_TO_FLOAT(*result)));
+}
+
 static int MeasureThermistor(size_t channel, AdcPwrSequence_t power,
-			     float *result)
+			     int32_t *result)
 {
 	int r = -EPERM;
 	int16_t raw = 0;
-	*result = 0.0;
-
-	uint32_t config = attr_get_uint32(ATTR_ID_thermistor_config, 0);
+	sensor_config_t cfg;
+	*result = 0;
 
-	if (config & BIT(channel)) {
+	/* This also runs from the attr_prepare_* callbacks */
+	SensorConfigGet(&cfg);
+	if (cfg.thermistor_config & BIT(channel)) {
 		r = AdcBt6_Measure(&raw, channel, ADC_TYPE_THERMISTOR, power);
 		if (r >= 0) {
-			*result =
-				AdcBt6_ConvertThermToTemperature(channel, raw);
+			*result = ADC_CONVERT_MILLI(ConvertThermToTemperature,
+						    channel, raw, 1);
 		}
 	} else {
 		LOG_DBG("Thermistor channel %d not enabled", channel + 1);
@@ -1114,34 +1827,102 @@ static int MeasureThermistor(size_t channel, AdcPwrSequence_t power,
 	}
 
 	if (r >= 0) {
-		r = attr_set_float(ATTR_ID_temperature_result_1 + channel,
-				   *result);
+		r = COUNT_ATTR(attr_set_float(
+			ATTR_ID_temperature_result_1 + channel,
+			MILLI_TO_FLOAT(*result)));
 	}
 
 	return r;
 }
 
-static void SendEvent(SensorEventType_t type, SensorEventData_t data)
+/* A reading is reported when it has moved further than the larger of the
+ * absolute band and the percentage of the last reported value. With both
+ * set to 0 every reading is reported. The heartbeat forces a report after a
+ * period of silence. The value and band are in milli-units and the
+ * percentage in thousandths of a percent.
+ */
+static bool OutsideDeadband(report_state_t *state, int32_t value,
+			    int32_t band, int32_t percent)
 {
-	EventLogMsg_t *pMsgSend =
-		(EventLogMsg_t *)BufferPool_Take(sizeof(EventLogMsg_t));
+	uint32_t heartbeat = pSensorConfig->deadband_heartbeat;
+	int64_t now = k_uptime_get();
+	bool report = true;
+	int64_t delta;
+	int64_t last;
+	int64_t limit;
+
+	if (state->valid && (band > 0 || percent > 0)) {
+		delta = (int64_t)value - state->value;
+		delta = (delta < 0) ? -delta : delta;
+		last = (state->value < 0) ? -(int64_t)state->value :
+					    state->value;
+		limit = MAX((int64_t)band,
+			    (last * percent) / (100 * ADC_BT6_MILLI));
+
+		report = (delta > limit) ||
+			 ((heartbeat != 0) &&
+			  ((now - state->timestamp) >=
+			   ((int64_t)heartbeat * MSEC_PER_SEC)));
+	}
 
-	if (pMsgSend != NULL) {
-		pMsgSend->header.msgCode = FMC_EVENT_TRIGGER;
-		pMsgSend->header.txId = FWK_ID_SENSOR_TASK;
-		pMsgSend->header.rxId = FWK_ID_EVENT_TASK;
-		pMsgSend->eventType = type;
-		pMsgSend->eventData = data;
-		FRAMEWORK_MSG_SEND(pMsgSend);
+	if (report) {
+		state->valid = true;
+		state->value = value;
+		state->timestamp = now;
 	}
+	return report;
+}
+
+static void SendTemperatureEvent(size_t channel, int32_t temperature,
+				 int64_t sampleTime)
+{
+	const sensor_config_t *cfg = pSensorConfig;
+
+	if (OutsideDeadband(&sensorTaskObject.temperatureReport[channel],
+			    temperature, cfg->temperature_deadband[channel],
+			    cfg->temperature_deadband_percent[channel])) {
+		SendEvent((SensorEventType_t)(SENSOR_EVENT_TEMPERATURE_1 +
+					      channel),
+			  (SensorEventData_t)MILLI_TO_FLOAT(temperature),
+			  sampleTime);
+	}
+}
+
+static void SendAnalogEvent(size_t channel, int32_t value,
+			    int64_t sampleTime)
+{
+	const sensor_config_t *cfg = pSensorConfig;
+
+	if (OutsideDeadband(&sensorTaskObject.analogReport[channel], value,
+			    cfg->analog_deadband[channel],
+			    cfg->analog_deadband_percent[channel])) {
+		SendEvent(AnalogConfigType(channel),
+			  (SensorEventData_t)MILLI_TO_FLOAT(value), sampleTime);
+	}
+}
+
+/* Readings are compared with the previous scan by the time they're taken */
+static void AdaptiveSample(AdaptiveState_t *state, size_t channel,
+			   int32_t value, int32_t threshold)
+{
+	AdaptiveInterval_Sample(state, channel, value, threshold,
+				k_uptime_get());
+}
+
+/* sampleTime is the uptime when the data was acquired. It is converted to
+ * qrtc time so that queueing doesn't affect the timestamp.
+ */
+static void SendEvent(SensorEventType_t type, SensorEventData_t data,
+		      int64_t sampleTime)
+{
+	(void)EventTask_Post(type, data, sampleTime);
 }
 
 static SensorEventType_t AnalogConfigType(size_t channel)
 {
-	enum analog_input_1_type configType;
+	enum analog_input_1_type configType =
+		pSensorConfig->analog_input_type[channel];
 	SensorEventType_t eventTypeReturn;
-	attr_get((ATTR_ID_analog_input_1_type + channel), &configType,
-		  sizeof(uint8_t));
 
 	switch (configType) {
 	case ANALOG_INPUT_1_TYPE_VOLTAGE_0V_TO_10V_DC:
@@ -1173,8 +1954,10 @@ static int update_lwm2m_temperature(int index, float temperature)
 
 	#ifdef CONFIG_LWM2M_IPSO_TEMP_SENSOR
 	bool input_config_changed;
+	sensor_config_t cfg;
 
-	input_config_changed = attr_get_bool(ATTR_ID_input_config_changed);
+	SensorConfigGet(&cfg);
+	input_config_changed = cfg.input_config_changed;
 
 	/* Block update of telemetry objects until configuration is stable */
 	if (input_config_changed == false) {
@@ -1194,8 +1977,10 @@ static int update_lwm2m_pressure(int index, float pressure)
 
 	#ifdef CONFIG_LWM2M_IPSO_PRESSURE_SENSOR
 	bool input_config_changed;
+	sensor_config_t cfg;
 
-	input_config_changed = attr_get_bool(ATTR_ID_input_config_changed);
+	SensorConfigGet(&cfg);
+	input_config_changed = cfg.input_config_changed;
 
 	/* Block update of telemetry objects until input configuration is stable */
 	if (input_config_changed == false) {
@@ -1216,8 +2001,10 @@ static int update_lwm2m_fill_level(int index, float fill_level)
 
 	#ifdef CONFIG_LWM2M_IPSO_FILLING_SENSOR
 	bool input_config_changed;
+	sensor_config_t cfg;
 
-	input_config_changed = attr_get_bool(ATTR_ID_input_config_changed);
+	SensorConfigGet(&cfg);
+	input_config_changed = cfg.input_config_changed;
 
 	/* Block telemetry updates if the input config has changed */
 	if (input_config_changed == false) {
@@ -1237,8 +2024,10 @@ static int update_lwm2m_current(int index, float current)
 
 	#ifdef CONFIG_LWM2M_IPSO_CURRENT_SENSOR
 	bool input_config_changed;
+	sensor_config_t cfg;
 
-	input_config_changed = attr_get_bool(ATTR_ID_input_config_changed);
+	SensorConfigGet(&cfg);
+	input_config_changed = cfg.input_config_changed;
 
 	/* Don't update telemetry objects if the input configuration has changed */
 	if (input_config_changed == false) {
@@ -1293,23 +2082,16 @@ static int update_lwm2m_battery(lcz_lwm2m_client_device_battery_status_t status,
 /******************************************************************************/
 /* Interrupt Service Routines                                                 */
 /******************************************************************************/
-static void powerTimerCallbackIsr(struct k_timer *timer_id)
-{
-	UNUSED_PARAMETER(timer_id);
-	FRAMEWORK_MSG_CREATE_AND_SEND(FWK_ID_SENSOR_TASK, FWK_ID_SENSOR_TASK,
-				      FMC_READ_POWER);
-}
-
-static void temperatureReadTimerCallbackIsr(struct k_timer *timer_id)
+static void sampleTimerCallbackIsr(struct k_timer *timer_id)
 {
 	UNUSED_PARAMETER(timer_id);
 	FRAMEWORK_MSG_CREATE_AND_SEND(FWK_ID_SENSOR_TASK, FWK_ID_SENSOR_TASK,
-				      FMC_TEMPERATURE_MEASURE);
+				      FMC_SAMPLE_DUE);
 }
 
-static void analogReadTimerCallbackIsr(struct k_timer *timer_id)
+static void analogSettleTimerCallbackIsr(struct k_timer *timer_id)
 {
 	UNUSED_PARAMETER(timer_id);
 	FRAMEWORK_MSG_CREATE_AND_SEND(FWK_ID_SENSOR_TASK, FWK_ID_SENSOR_TASK,
-				      FMC_ANALOG_MEASURE);
+				      FMC_ANALOG_SETTLE_TIMEOUT);
 }
@@ -51,6 +51,8 @@ LOG_MODULE_REGISTER(TestMenu);
 /******************************************************************************/
 static int samples = 1;
 static int delay = 1;
+/* The menu's hold on the 5V and B+ rails */
+static bool railsHeld;
 
 /******************************************************************************/
 /* Local Function Definitions                                                 */
@@ -260,6 +262,23 @@ static int configure(const struct shell *shell, size_t argc, char **argv)
 	return result;
 }
 
+/* The 5V and B+ rails are shared with the sensor measurements, so the menu
+ * holds them through the reference count and they are switched together.
+ */
+static int rails_set(bool on)
+{
+	int rc = 0;
+
+	if (on && !railsHeld) {
+		rc = AdcBt6_RailsAcquire();
+		railsHeld = true;
+	} else if (!on && railsHeld) {
+		rc = AdcBt6_RailsRelease();
+		railsHeld = false;
+	}
+	return rc;
+}
+
 static int five_set(const struct shell *shell, size_t argc, char **argv)
 {
 	int result = -EPERM;
@@ -269,9 +288,8 @@ static int five_set(const struct shell *shell, size_t argc, char **argv)
 		result = -EINVAL;
 	} else {
 		int value = atoi(argv[1]);
-		int rc = (value == 0) ? AdcBt6_FiveVoltDisable() :
-					      AdcBt6_FiveVoltEnable();
-		shell_print(shell, "Set 5V: %d status: %d", value, rc);
+		int rc = rails_set(value != 0);
+		shell_print(shell, "Set 5V and B+: %d status: %d", value, rc);
 		result = 0;
 	}
 
@@ -287,10 +305,8 @@ static int battery_set(const struct shell *shell, size_t argc, char **argv)
 		result = -EINVAL;
 	} else {
 		int value = atoi(argv[1]);
-		int rc = (value == 0) ? AdcBt6_BplusDisable() :
-					      AdcBt6_BplusEnable();
-		shell_print(shell, "Set Battery Enable: %d status: %d",
-			    value, rc);
+		int rc = rails_set(value != 0);
+		shell_print(shell, "Set 5V and B+: %d status: %d", value, rc);
 		result = 0;
 	}
 
@@ -430,8 +446,8 @@ SHELL_STATIC_SUBCMD_SET_CREATE(
 	SHELL_CMD(therm, NULL, "Read thermistor <channel 1-4>", therm),
 	SHELL_CMD(temp, NULL, "Get temperature (therm) <channel 1-4>", temp),
 	SHELL_CMD(vref, NULL, "Read vref", vref),
-	SHELL_CMD(five, NULL, "Set 5V", five_set),
-	SHELL_CMD(b_plus, NULL, "Set Battery Out", battery_set),
+	SHELL_CMD(five, NULL, "Set 5V and B+", five_set),
+	SHELL_CMD(b_plus, NULL, "Set Battery Out and 5V", battery_set),
 	SHELL_CMD(toggledo, NULL, "Toggle DO1 and DO2", digital_output_toggle),
 	SHELL_CMD(dinenable, NULL, "Set DIN1_EN and DIN2_EN value",
 		  digital_enable),
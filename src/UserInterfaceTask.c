@@ -22,6 +22,7 @@ LOG_MODULE_REGISTER(ui, CONFIG_UI_TASK_LOG_LEVEL);
 #include "BspSupport.h"
 #include "Advertisement.h"
 #include "UserInterfaceTask.h"
+#include "EventTask.h"
 #include "LEDs.h"
 #include "attr_custom_validator.h"
 #include "Flags.h"
@@ -99,7 +100,8 @@ static void UserIfTaskThread(void *, void *, void *);
 
 static int InitializeButtons(void);
 static void TamperSwitchStatus(void);
-static void SendUIEvent(SensorEventType_t type, SensorEventData_t data);
+static void SendUIEvent(SensorEventType_t type, SensorEventData_t data,
+			int64_t sampleTime);
 
 static void Button0HandlerIsr(const struct device *dev,
 			      struct gpio_callback *cb, uint32_t pins);
@@ -406,6 +408,7 @@ static int InitializeButtons(void)
 static void TamperSwitchStatus(void)
 {
 	int v = BSP_PinGet(SW2_PIN);
+	int64_t sampleTime = k_uptime_get();
 	uint8_t activeMode = 0;
 	if (v >= 0) {
 		attr_set_uint32(ATTR_ID_tamper_switch_status, (uint32_t)v);
@@ -414,7 +417,8 @@ static void TamperSwitchStatus(void)
 			SensorEventData_t eventTamper;
 			/* Send Event Message */
 			eventTamper.u16 = v;
-			SendUIEvent(SENSOR_EVENT_TAMPER, eventTamper);
+			SendUIEvent(SENSOR_EVENT_TAMPER, eventTamper,
+				    sampleTime);
 
 			/* Only turn on LED when in active mode */
 			attr_get(ATTR_ID_active_mode, &activeMode,
@@ -429,19 +433,10 @@ static void TamperSwitchStatus(void)
 	}
 }
 
-static void SendUIEvent(SensorEventType_t type, SensorEventData_t data)
+static void SendUIEvent(SensorEventType_t type, SensorEventData_t data,
+			int64_t sampleTime)
 {
-	EventLogMsg_t *pMsgSend =
-		(EventLogMsg_t *)BufferPool_Take(sizeof(EventLogMsg_t));
-
-	if (pMsgSend != NULL) {
-		pMsgSend->header.msgCode = FMC_EVENT_TRIGGER;
-		pMsgSend->header.txId = FWK_ID_USER_IF_TASK;
-		pMsgSend->header.rxId = FWK_ID_EVENT_TASK;
-		pMsgSend->eventType = type;
-		pMsgSend->eventData = data;
-		FRAMEWORK_MSG_SEND(pMsgSend);
-	}
+	(void)EventTask_Post(type, data, sampleTime);
 }
 
 static Dispatch_t AliveMsgHandler(FwkMsgRxer_t *pMsgRxer, FwkMsg_t *pMsg)
@@ -18,6 +18,7 @@ extern "C" {
 /******************************************************************************/
 #include "Framework.h"
 #include "lcz_sensor_event.h"
+#include "AdcBt6.h"
 
 /******************************************************************************/
 /* Global Constants, Macros and Type Definitions                              */
@@ -36,15 +37,18 @@ typedef struct {
 	FwkMsgHeader_t header;
 	int status;
 	uint16_t pin;
+	/* Uptime in milliseconds when the input changed */
+	int64_t timestamp;
 } DigitalInMsg_t;
 
 typedef struct {
 	FwkMsgHeader_t header;
-	SensorEventType_t eventType;
-	SensorEventData_t eventData;
-	uint32_t id;
-	uint32_t timeStamp;
-} EventLogMsg_t;
+	int status;
+	AdcBt6ScanPlan_t plan;
+	int16_t raw[NUMBER_OF_ANALOG_INPUTS];
+	/* Uptime in milliseconds when the inputs were sampled */
+	int64_t timestamp;
+} AnalogSettledMsg_t;
 
 #ifdef __cplusplus
 }
@@ -13,15 +13,17 @@
         FMC_BLE_START_ADVERTISING,
         FMC_BLE_END_ADVERTISING,
         FMC_ENTER_ACTIVE_MODE,
-        FMC_SENSOR_EVENT,
         FMC_ALIVE,
         FMC_TAMPER,
         FMC_AMR_LED_ON,
         FMC_LEDS_OFF,
         FMC_ENTER_SHELF_MODE,
-        FMC_EVENT_TRIGGER,
         FMC_SENSOR_UPDATE,
         FMC_BLE_END_CONNECTION,
+        FMC_BLE_CONNECTED,
         FMC_FACTORY_RESET,
         FMC_CLEAR_INPUT_CONFIG_CHANGED,
         FMC_DM_CONNECTED,
+        FMC_ANALOG_SETTLED,
+        FMC_SAMPLE_DUE,
+        FMC_ANALOG_SETTLE_TIMEOUT,
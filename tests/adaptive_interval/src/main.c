@@ -0,0 +1,289 @@
+/**
+ * @file main.c
+ * @brief Tests for the adaptive sample interval, with trace replay
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include <ztest.h>
+#include <math.h>
+
+#include "AdaptiveInterval.h"
+
+/******************************************************************************/
+/* Local Constant, Macro and Type Definitions                                 */
+/******************************************************************************/
+#define MIN_MS (SEC_PER_MIN * MSEC_PER_SEC)
+#define HOUR_MS (MIN_PER_HOUR * MIN_MS)
+#define PI 3.14159265358979323846
+
+/* Temperature settings: 1 to 16 minutes, fast above 0.2 C per minute */
+#define FIXED_S 60
+#define MIN_S 60
+#define MAX_S 960
+#define THRESHOLD 200
+
+/* A cooler fails and the temperature climbs 1 C per minute. The start isn't
+ * on the sample grid.
+ */
+#define AMBIENT_MILLI 20000
+#define RAMP_START_MS (6 * HOUR_MS + 7 * MIN_MS + 13000)
+#define RAMP_MILLI_PER_MIN 1000
+#define ALARM_MILLI 50000
+#define RAMP_TRACE_MS (8 * HOUR_MS)
+
+/* A day of outdoor temperature: 20 C +/- 5 C */
+#define DAY_MS (24 * HOUR_MS)
+#define DIURNAL_AMPLITUDE_MILLI 5000
+
+/* A probe is moved into a hot bath */
+#define STEP_START_MS (5 * HOUR_MS + 3 * MIN_MS + 500)
+#define STEP_MILLI 60000
+
+typedef int32_t (*Trace_t)(int64_t ms);
+
+typedef struct Replay {
+	uint32_t samples;
+	/* Time from the alarm level being reached to a sample seeing it */
+	int64_t latency;
+} Replay_t;
+
+/******************************************************************************/
+/* Local Function Definitions                                                 */
+/******************************************************************************/
+static int32_t RampTrace(int64_t ms)
+{
+	if (ms < RAMP_START_MS) {
+		return AMBIENT_MILLI;
+	}
+	return AMBIENT_MILLI +
+	       (int32_t)(((ms - RAMP_START_MS) * RAMP_MILLI_PER_MIN) / MIN_MS);
+}
+
+static int32_t DiurnalTrace(int64_t ms)
+{
+	double phase = (2 * PI * ms) / DAY_MS;
+
+	return AMBIENT_MILLI +
+	       (int32_t)lround(DIURNAL_AMPLITUDE_MILLI * sin(phase));
+}
+
+static int32_t StepTrace(int64_t ms)
+{
+	return (ms < STEP_START_MS) ? AMBIENT_MILLI : STEP_MILLI;
+}
+
+/* Sample the trace the way the sensor task does: a scan, the update and
+ * then a timer for the next interval. The alarm time is where the trace
+ * first reaches the alarm level, to 100 ms.
+ */
+static void Replay(Trace_t trace, const AdaptiveConfig_t *cfg,
+		   int64_t duration, int32_t alarm, Replay_t *result)
+{
+	AdaptiveState_t state = { 0 };
+	int64_t alarmAt = -1;
+	int64_t detected = -1;
+	int64_t now = 0;
+	int64_t ms;
+	int32_t value;
+
+	for (ms = 0; ms < duration && alarmAt < 0; ms += 100) {
+		if (trace(ms) >= alarm) {
+			alarmAt = ms;
+		}
+	}
+
+	result->samples = 0;
+	while (now < duration) {
+		value = trace(now);
+		AdaptiveInterval_Sample(&state, 0, value, cfg->slope_threshold,
+					now);
+		AdaptiveInterval_Update(&state, cfg);
+		result->samples += 1;
+		if (detected < 0 && value >= alarm) {
+			detected = now;
+		}
+		now += AdaptiveInterval_Get(&state, cfg, FIXED_S) *
+		       MSEC_PER_SEC;
+	}
+
+	result->latency = -1;
+	if (alarmAt >= 0 && detected >= 0) {
+		result->latency = detected - alarmAt;
+	}
+}
+
+/* A latency of -1 means there was no alarm */
+static int LatencySeconds(const Replay_t *result)
+{
+	return (result->latency < 0) ? -1 :
+				       (int)(result->latency / MSEC_PER_SEC);
+}
+
+static void Report(const char *name, const Replay_t *adaptive,
+		   const Replay_t *fixed)
+{
+	TC_PRINT("%s: adaptive %u samples %d s latency, "
+		 "fixed %u samples %d s latency\n",
+		 name, adaptive->samples, LatencySeconds(adaptive),
+		 fixed->samples, LatencySeconds(fixed));
+}
+
+/******************************************************************************/
+/* Tests                                                                      */
+/******************************************************************************/
+static void test_flat_signal_backs_off(void)
+{
+	const AdaptiveConfig_t cfg = { MIN_S, MAX_S, THRESHOLD };
+	AdaptiveState_t state = { 0 };
+	uint32_t expected = MIN_S;
+	int64_t now = 0;
+
+	/* The fixed interval is used until a scan completes */
+	zassert_equal(AdaptiveInterval_Get(&state, &cfg, FIXED_S), FIXED_S,
+		      "no scan yet");
+
+	while (expected <= MAX_S) {
+		AdaptiveInterval_Sample(&state, 0, AMBIENT_MILLI, THRESHOLD,
+					now);
+		AdaptiveInterval_Update(&state, &cfg);
+		zassert_equal(AdaptiveInterval_Get(&state, &cfg, FIXED_S),
+			      expected, "interval didn't double");
+		now += expected * MSEC_PER_SEC;
+		expected *= 2;
+	}
+
+	/* The longest interval is kept */
+	AdaptiveInterval_Sample(&state, 0, AMBIENT_MILLI, THRESHOLD, now);
+	AdaptiveInterval_Update(&state, &cfg);
+	zassert_equal(AdaptiveInterval_Get(&state, &cfg, FIXED_S), MAX_S,
+		      "interval passed the maximum");
+}
+
+static void test_changing_signal_drops_to_min(void)
+{
+	const AdaptiveConfig_t cfg = { MIN_S, MAX_S, THRESHOLD };
+	AdaptiveState_t state = { .interval = MAX_S };
+	int64_t now = 0;
+
+	/* 0.1 C per minute on one channel is flat */
+	AdaptiveInterval_Sample(&state, 1, AMBIENT_MILLI, THRESHOLD, now);
+	AdaptiveInterval_Sample(&state, 2, AMBIENT_MILLI, THRESHOLD, now);
+	now += 10 * MIN_MS;
+	AdaptiveInterval_Sample(&state, 1, AMBIENT_MILLI + 1000, THRESHOLD,
+				now);
+	zassert_false(state.fast, "slow change is fast");
+
+	/* 0.3 C per minute falling on another is fast for the group */
+	AdaptiveInterval_Sample(&state, 2, AMBIENT_MILLI - 3000, THRESHOLD,
+				now);
+	AdaptiveInterval_Update(&state, &cfg);
+	zassert_equal(AdaptiveInterval_Get(&state, &cfg, FIXED_S), MIN_S,
+		      "fast change didn't drop to the minimum");
+	zassert_false(state.fast, "update didn't end the scan");
+
+	/* A channel outside the group is ignored */
+	AdaptiveInterval_Sample(&state, ADAPTIVE_INTERVAL_CHANNELS, 0,
+				THRESHOLD, now);
+	zassert_equal(state.valid, BIT(1) | BIT(2), "channel out of range");
+}
+
+static void test_disabled_keeps_fixed_interval(void)
+{
+	const AdaptiveConfig_t off = { 0, MAX_S, THRESHOLD };
+	const AdaptiveConfig_t inverted = { MAX_S, MIN_S, THRESHOLD };
+	const AdaptiveConfig_t cfg = { MIN_S, MAX_S, THRESHOLD };
+	AdaptiveState_t state = { 0 };
+
+	AdaptiveInterval_Update(&state, &off);
+	zassert_equal(AdaptiveInterval_Get(&state, &off, FIXED_S), FIXED_S,
+		      "min of 0 isn't fixed");
+	AdaptiveInterval_Update(&state, &inverted);
+	zassert_equal(AdaptiveInterval_Get(&state, &inverted, FIXED_S),
+		      FIXED_S, "max below min isn't fixed");
+
+	/* A fixed interval of 0 still disables the group */
+	AdaptiveInterval_Update(&state, &cfg);
+	zassert_equal(AdaptiveInterval_Get(&state, &cfg, 0), 0,
+		      "disabled group sampled");
+}
+
+static void test_replay_ramp(void)
+{
+	const AdaptiveConfig_t cfg = { MIN_S, MAX_S, THRESHOLD };
+	const AdaptiveConfig_t fixedCfg = { 0 };
+	Replay_t adaptive;
+	Replay_t fixed;
+
+	Replay(RampTrace, &cfg, RAMP_TRACE_MS, ALARM_MILLI, &adaptive);
+	Replay(RampTrace, &fixedCfg, RAMP_TRACE_MS, ALARM_MILLI, &fixed);
+	Report("ramp", &adaptive, &fixed);
+
+	/* The ramp is found before it reaches the alarm */
+	zassert_true(adaptive.latency >= 0 &&
+			     adaptive.latency < MIN_S * MSEC_PER_SEC,
+		     "latency %d ms", (int)adaptive.latency);
+	zassert_true(fixed.latency < FIXED_S * MSEC_PER_SEC,
+		     "fixed latency %d ms", (int)fixed.latency);
+	zassert_true(adaptive.samples * 3 < fixed.samples,
+		     "%u samples, fixed %u", adaptive.samples, fixed.samples);
+}
+
+static void test_replay_diurnal(void)
+{
+	const AdaptiveConfig_t cfg = { MIN_S, MAX_S, THRESHOLD };
+	const AdaptiveConfig_t fixedCfg = { 0 };
+	Replay_t adaptive;
+	Replay_t fixed;
+
+	/* Never reaches an alarm, only the sample count matters */
+	Replay(DiurnalTrace, &cfg, DAY_MS, ALARM_MILLI, &adaptive);
+	Replay(DiurnalTrace, &fixedCfg, DAY_MS, ALARM_MILLI, &fixed);
+	Report("diurnal", &adaptive, &fixed);
+
+	zassert_equal(fixed.samples, DAY_MS / (FIXED_S * MSEC_PER_SEC),
+		      "fixed sample count");
+	/* At most a few doublings more than sampling at the maximum */
+	zassert_true(adaptive.samples <= (DAY_MS / (MAX_S * MSEC_PER_SEC)) + 5,
+		     "%u samples", adaptive.samples);
+}
+
+static void test_replay_step(void)
+{
+	const AdaptiveConfig_t cfg = { MIN_S, MAX_S, THRESHOLD };
+	const AdaptiveConfig_t fixedCfg = { 0 };
+	Replay_t adaptive;
+	Replay_t fixed;
+
+	Replay(StepTrace, &cfg, RAMP_TRACE_MS, ALARM_MILLI, &adaptive);
+	Replay(StepTrace, &fixedCfg, RAMP_TRACE_MS, ALARM_MILLI, &fixed);
+	Report("step", &adaptive, &fixed);
+
+	/* A step can't be anticipated: it waits for up to the longest
+	 * interval, and sampling speeds up afterwards.
+	 */
+	zassert_true(adaptive.latency >= 0 &&
+			     adaptive.latency < MAX_S * MSEC_PER_SEC,
+		     "latency %d ms", (int)adaptive.latency);
+	zassert_true(fixed.latency < FIXED_S * MSEC_PER_SEC,
+		     "fixed latency %d ms", (int)fixed.latency);
+	zassert_true(adaptive.samples * 3 < fixed.samples,
+		     "%u samples, fixed %u", adaptive.samples, fixed.samples);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(adaptive_interval,
+			 ztest_unit_test(test_flat_signal_backs_off),
+			 ztest_unit_test(test_changing_signal_drops_to_min),
+			 ztest_unit_test(test_disabled_keeps_fixed_interval),
+			 ztest_unit_test(test_replay_ramp),
+			 ztest_unit_test(test_replay_diurnal),
+			 ztest_unit_test(test_replay_step));
+	ztest_run_test_suite(adaptive_interval);
+}
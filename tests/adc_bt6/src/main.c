@@ -0,0 +1,498 @@
+/**
+ * @file main.c
+ * @brief Tests for the BT6xx ADC module on the emulated ADC and expander
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include <ztest.h>
+#include <math.h>
+#include <drivers/adc.h>
+#include <drivers/adc/adc_emul.h>
+
+#include "attr.h"
+#include "BspSupport.h"
+#include "AdcBt6.h"
+#include "harness.h"
+#include "tca9538_emul.h"
+
+/******************************************************************************/
+/* Local Constant, Macro and Type Definitions                                 */
+/******************************************************************************/
+/* The analog inputs use the internal reference at a gain of 1/6 */
+#define FULL_SCALE_MV 3600
+#define COUNTS 4096
+#define MV_TO_COUNTS(mv) (((mv) * COUNTS) / FULL_SCALE_MV)
+#define COUNT_TOLERANCE 2
+
+#define EXPANDER_MUX_SHIFT 4
+#define EXPANDER_MUX_MASK 0x3
+#define EXPANDER_AIN_SEL_MASK 0xf
+
+/* An ultrasonic sensor settles for 400 ms */
+#define ULTRASONIC_SETTLE_MS 400
+#define SETTLE_CHECK_MS 100
+/* A battery reading is a single conversion */
+#define BATTERY_READ_MAX_MS 20
+
+/* 50 Hz sampled every 1 ms gives 5 whole cycles in the default burst */
+#define SINE_SAMPLES_PER_CYCLE 20
+#define SINE_OFFSET_MV 1650
+#define SINE_AMPLITUDE_MV 1000
+#define PI 3.14159265358979323846
+
+/* Busy waits for the thermistor circuit and for a mux change */
+#define POWER_ENABLE_US 200
+#define MUX_SWITCH_US 100
+#define SCAN_INPUTS 4
+#define SCAN_ALL (BIT(SCAN_INPUTS) - 1)
+/* Each mux input reads a different voltage */
+#define MUX_BASE_MV 500
+#define MUX_STEP_MV 400
+
+/* Default Steinhart-Hart coefficients and the rated range of the sensor */
+#define SH_A 1.132e-3
+#define SH_B 2.338e-4
+#define SH_C 8.780e-8
+#define SH_OFFSET 273.15
+#define THERM_MIN_C -40.0
+#define THERM_MAX_C 125.0
+/* Interpolation plus rounding to hundredths with the default table step */
+#define THERM_MAX_ERROR_C 0.1
+#define THERM_CHANNELS 4
+#define THERM_BENCH_PASSES 8
+
+typedef struct Sine {
+	uint32_t offsetMv;
+	uint32_t amplitudeMv;
+	uint32_t sample;
+} Sine_t;
+
+/******************************************************************************/
+/* Local Data Definitions                                                     */
+/******************************************************************************/
+static const struct device *const adc = DEVICE_DT_GET(DT_NODELABEL(adc));
+static const struct emul *const expander = EMUL_DT_GET(DT_NODELABEL(expander));
+
+static struct k_work_delayable settleWork;
+static int16_t settleRaw;
+static int settleStatus;
+static int64_t settleDoneMs;
+static Sine_t sine;
+
+/******************************************************************************/
+/* Local Function Definitions                                                 */
+/******************************************************************************/
+static void SettleWorkHandler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	settleStatus = AdcBt6_Measure(&settleRaw, MUX_AIN2_THERM2,
+				      ADC_TYPE_ULTRASONIC, ADC_PWR_SEQ_SINGLE);
+	settleDoneMs = k_uptime_get();
+}
+
+/* Each conversion takes the next point of the sine */
+static int SineValue(const struct device *dev, unsigned int chan, void *data,
+		     uint32_t *result)
+{
+	Sine_t *p = data;
+	double phase = (2 * PI * p->sample) / SINE_SAMPLES_PER_CYCLE;
+
+	ARG_UNUSED(dev);
+	ARG_UNUSED(chan);
+
+	*result = (uint32_t)lround(p->offsetMv + p->amplitudeMv * sin(phase));
+	p->sample += 1;
+	return 0;
+}
+
+/* The thermistor input reads a voltage set by the selected mux input */
+static int MuxValue(const struct device *dev, unsigned int chan, void *data,
+		    uint32_t *result)
+{
+	uint8_t output = tca9538_emul_reg(expander, TCA9538_EMUL_REG_OUTPUT);
+	uint8_t mux = (output >> EXPANDER_MUX_SHIFT) & EXPANDER_MUX_MASK;
+
+	ARG_UNUSED(dev);
+	ARG_UNUSED(chan);
+	ARG_UNUSED(data);
+
+	*result = MUX_BASE_MV + (mux * MUX_STEP_MV);
+	return 0;
+}
+
+/* The equation the tables are built from, in double precision */
+static double SteinhartHart(int32_t raw, double a)
+{
+	double r = (10000.0 * raw) / (COUNTS - raw);
+	double x = log(r);
+
+	return (1.0 / (a + SH_B * x + SH_C * x * x * x)) - SH_OFFSET;
+}
+
+/* The conversion the tables replace, as it was done for every reading */
+static float SteinhartHartDirect(int32_t raw)
+{
+	float r = (10000.0f * raw) / (COUNTS - raw);
+	float x = log(r);
+
+	return (1.0f / (SH_A + SH_B * x + SH_C * x * x * x)) - SH_OFFSET;
+}
+
+/******************************************************************************/
+/* Tests                                                                      */
+/******************************************************************************/
+static void test_voltage_through_emulator(void)
+{
+	int16_t raw = 0;
+	uint8_t output;
+
+	zassert_equal(adc_emul_const_value_set(adc, ANALOG_SENSOR_1_CH, 1800),
+		      0, "unable to set the input");
+
+	zassert_equal(AdcBt6_Measure(&raw, MUX_AIN3_THERM3, ADC_TYPE_VOLTAGE,
+				     ADC_PWR_SEQ_SINGLE),
+		      0, "measurement failed");
+	zassert_within(raw, MV_TO_COUNTS(1800), COUNT_TOLERANCE,
+		       "unexpected raw value %d", raw);
+
+	output = tca9538_emul_reg(expander, TCA9538_EMUL_REG_OUTPUT);
+	zassert_equal((output >> EXPANDER_MUX_SHIFT) & EXPANDER_MUX_MASK,
+		      MUX_AIN3_THERM3, "mux not selected");
+	zassert_equal(harness_pin_get(ANALOG_ENABLE_PIN), 0,
+		      "analog circuit left powered");
+}
+
+static void test_battery_read_during_settle(void)
+{
+	int16_t raw = 0;
+	float volts = 0;
+	int64_t start;
+	uint8_t output;
+
+	adc_emul_const_value_set(adc, ANALOG_SENSOR_1_CH, 1000);
+	adc_emul_const_value_set(adc, POWER_ADC_CH, 3000);
+	settleDoneMs = 0;
+
+	start = k_uptime_get();
+	k_work_schedule(&settleWork, K_NO_WAIT);
+	k_msleep(SETTLE_CHECK_MS);
+
+	/* Power, mux, then rails are up while the sensor settles */
+	zassert_equal(harness_pin_get(ANALOG_ENABLE_PIN), 1,
+		      "analog circuit not powered");
+	output = tca9538_emul_reg(expander, TCA9538_EMUL_REG_OUTPUT);
+	zassert_equal((output >> EXPANDER_MUX_SHIFT) & EXPANDER_MUX_MASK,
+		      MUX_AIN2_THERM2, "mux not selected before settling");
+	zassert_equal(harness_pin_get(FIVE_VOLT_ENABLE_PIN), 1, "5V is off");
+	zassert_equal(harness_pin_get(BATT_OUT_ENABLE_PIN), 1, "B+ is off");
+
+	/* The ADC lock isn't held while the sensor settles */
+	zassert_equal(AdcBt6_read_power_volts(&raw, &volts), 0,
+		      "battery read failed");
+	zassert_true(k_uptime_get() - start <
+			     SETTLE_CHECK_MS + BATTERY_READ_MAX_MS,
+		     "battery read waited for the settle");
+	zassert_equal(settleDoneMs, 0, "settle finished early");
+
+	k_msleep(ULTRASONIC_SETTLE_MS);
+	zassert_true(settleDoneMs - start >= ULTRASONIC_SETTLE_MS,
+		     "sensor didn't settle");
+	zassert_equal(settleStatus, 0, "ultrasonic measurement failed");
+	zassert_within(settleRaw, MV_TO_COUNTS(1000), COUNT_TOLERANCE,
+		       "unexpected raw value %d", settleRaw);
+	zassert_equal(harness_pin_get(FIVE_VOLT_ENABLE_PIN), 0, "5V left on");
+	zassert_equal(harness_pin_get(BATT_OUT_ENABLE_PIN), 0, "B+ left on");
+	zassert_equal(harness_pin_get(ANALOG_ENABLE_PIN), 0,
+		      "analog circuit left powered");
+}
+
+static void test_rails_are_reference_counted(void)
+{
+	zassert_equal(AdcBt6_RailsAcquire(), 0, "acquire failed");
+	zassert_equal(AdcBt6_RailsAcquire(), 0, "second acquire failed");
+	zassert_equal(AdcBt6_RailsRelease(), 0, "release failed");
+	zassert_equal(harness_pin_get(FIVE_VOLT_ENABLE_PIN), 1,
+		      "5V dropped with a user left");
+	zassert_equal(harness_pin_get(BATT_OUT_ENABLE_PIN), 1,
+		      "B+ dropped with a user left");
+	zassert_equal(AdcBt6_RailsRelease(), 0, "last release failed");
+	zassert_equal(harness_pin_get(FIVE_VOLT_ENABLE_PIN), 0, "5V left on");
+	zassert_equal(harness_pin_get(BATT_OUT_ENABLE_PIN), 0, "B+ left on");
+}
+
+static void test_thermistor_scan_powers_once(void)
+{
+	AdcBt6ScanPlan_t plan = { .channel_mask = SCAN_ALL };
+	int16_t results[SCAN_INPUTS] = { 0 };
+	int16_t raw = 0;
+	AdcBt6Stats_t before;
+	AdcBt6Stats_t after;
+	size_t i;
+
+	adc_emul_value_func_set(adc, THERMISTOR_SENSOR_2_CH, MuxValue, NULL);
+	for (i = 0; i < SCAN_INPUTS; i++) {
+		plan.type[i] = ADC_TYPE_THERMISTOR;
+	}
+
+	/* Leave the mux on the last input so that the scan moves it 4 times */
+	zassert_equal(AdcBt6_Measure(&raw, MUX_AIN4_THERM4,
+				     ADC_TYPE_THERMISTOR, ADC_PWR_SEQ_SINGLE),
+		      0, "measurement failed");
+
+	AdcBt6_GetStats(&before);
+	zassert_equal(AdcBt6_MeasureScan(&plan, results), SCAN_ALL,
+		      "not every input was sampled");
+	AdcBt6_GetStats(&after);
+
+	zassert_equal(after.transitions - before.transitions, 2,
+		      "circuit powered more than once");
+	zassert_equal(after.busy_wait_us - before.busy_wait_us,
+		      POWER_ENABLE_US + SCAN_INPUTS * MUX_SWITCH_US,
+		      "unexpected busy wait");
+	zassert_equal(harness_pin_get(THERM_ENABLE_PIN), 1,
+		      "thermistor circuit left powered");
+	/* Each result was converted with its own input selected */
+	for (i = 1; i < SCAN_INPUTS; i++) {
+		zassert_true(results[i] > results[i - 1],
+			     "input %zu read %d after %d", i, results[i],
+			     results[i - 1]);
+	}
+
+	/* Measuring the inputs one at a time powers the circuit for each */
+	AdcBt6_GetStats(&before);
+	for (i = 0; i < SCAN_INPUTS; i++) {
+		zassert_equal(AdcBt6_Measure(&raw, i, ADC_TYPE_THERMISTOR,
+					     ADC_PWR_SEQ_SINGLE),
+			      0, "measurement failed");
+		zassert_equal(raw, results[i], "input %zu differs from scan", i);
+	}
+	AdcBt6_GetStats(&after);
+	zassert_equal(after.transitions - before.transitions, 2 * SCAN_INPUTS,
+		      "unexpected power transitions");
+	zassert_equal(after.busy_wait_us - before.busy_wait_us,
+		      SCAN_INPUTS * (POWER_ENABLE_US + MUX_SWITCH_US),
+		      "unexpected busy wait");
+}
+
+static void test_expander_writes_per_scan(void)
+{
+	AdcBt6ScanPlan_t plan = { .channel_mask = SCAN_ALL };
+	int16_t results[SCAN_INPUTS] = { 0 };
+	int16_t raw = 0;
+	uint8_t output;
+	size_t i;
+
+	for (i = 0; i < SCAN_INPUTS; i++) {
+		plan.type[i] = ADC_TYPE_VOLTAGE;
+	}
+
+	/* Only the mux changes during a scan: one write per input at most */
+	tca9538_emul_reset_count(expander);
+	zassert_equal(AdcBt6_MeasureScan(&plan, results), SCAN_ALL,
+		      "not every input was sampled");
+	zassert_true(tca9538_emul_transactions(expander) <= SCAN_INPUTS,
+		     "%u transactions in a scan",
+		     tca9538_emul_transactions(expander));
+
+	/* Nothing is written when the outputs don't change */
+	tca9538_emul_reset_count(expander);
+	zassert_equal(AdcBt6_Measure(&raw, MUX_AIN4_THERM4, ADC_TYPE_VOLTAGE,
+				     ADC_PWR_SEQ_SINGLE),
+		      0, "measurement failed");
+	zassert_equal(AdcBt6_ConfigAinSelects(), 0, "select failed");
+	zassert_equal(tca9538_emul_transactions(expander), 0,
+		      "unchanged outputs were written");
+
+	/* A select change is one write that keeps the mux */
+	attr_set_uint32(ATTR_ID_analog_input_2_type,
+			ANALOG_INPUT_1_TYPE_CURRENT_4MA_TO_20MA);
+	zassert_equal(AdcBt6_ConfigAinSelects(), 0, "select failed");
+	zassert_equal(tca9538_emul_transactions(expander), 1,
+		      "select change not written once");
+	output = tca9538_emul_reg(expander, TCA9538_EMUL_REG_OUTPUT);
+	zassert_equal(output & EXPANDER_AIN_SEL_MASK, BIT(MUX_AIN2_THERM2),
+		      "select not set");
+	zassert_equal((output >> EXPANDER_MUX_SHIFT) & EXPANDER_MUX_MASK,
+		      MUX_AIN4_THERM4, "mux moved");
+
+	/* A failed write is retried by the next change of either field */
+	attr_set_uint32(ATTR_ID_analog_input_2_type,
+			ANALOG_INPUT_1_TYPE_VOLTAGE_0V_TO_10V_DC);
+	tca9538_emul_set_fail(expander, true);
+	zassert_not_equal(AdcBt6_ConfigAinSelects(), 0, "write didn't fail");
+	tca9538_emul_set_fail(expander, false);
+	tca9538_emul_reset_count(expander);
+	zassert_equal(AdcBt6_Measure(&raw, MUX_AIN4_THERM4, ADC_TYPE_VOLTAGE,
+				     ADC_PWR_SEQ_SINGLE),
+		      0, "measurement failed");
+	zassert_equal(tca9538_emul_transactions(expander), 1,
+		      "failed write not retried");
+	output = tca9538_emul_reg(expander, TCA9538_EMUL_REG_OUTPUT);
+	zassert_equal(output & EXPANDER_AIN_SEL_MASK, 0, "select not cleared");
+}
+
+static void test_rms_of_sine(void)
+{
+	int16_t rms = 0;
+	int expected = MV_TO_COUNTS(SINE_AMPLITUDE_MV / sqrt(2));
+
+	sine.offsetMv = SINE_OFFSET_MV;
+	sine.amplitudeMv = SINE_AMPLITUDE_MV;
+	sine.sample = 0;
+	adc_emul_value_func_set(adc, ANALOG_SENSOR_1_CH, SineValue, &sine);
+
+	zassert_equal(AdcBt6_MeasureRms(&rms, MUX_AIN1_THERM1,
+					ADC_TYPE_VOLTAGE, ADC_PWR_SEQ_SINGLE),
+		      0, "burst failed");
+	zassert_equal(sine.sample, CONFIG_ADC_BT6_AC_BURST_SAMPLES,
+		      "wrong number of samples");
+	/* The DC offset is removed */
+	zassert_within(rms, expected, COUNT_TOLERANCE, "rms %d expected %d",
+		       rms, expected);
+
+	/* The same sine reaching down to 0 V */
+	sine.offsetMv = SINE_AMPLITUDE_MV;
+	sine.sample = 0;
+	zassert_equal(AdcBt6_MeasureRms(&rms, MUX_AIN1_THERM1,
+					ADC_TYPE_VOLTAGE, ADC_PWR_SEQ_SINGLE),
+		      0, "burst failed");
+	zassert_within(rms, expected, COUNT_TOLERANCE, "rms %d expected %d",
+		       rms, expected);
+
+	/* A DC input has no AC part */
+	adc_emul_const_value_set(adc, ANALOG_SENSOR_1_CH, SINE_OFFSET_MV);
+	zassert_equal(AdcBt6_MeasureRms(&rms, MUX_AIN1_THERM1,
+					ADC_TYPE_VOLTAGE, ADC_PWR_SEQ_SINGLE),
+		      0, "burst failed");
+	zassert_equal(rms, 0, "DC input has an rms of %d", rms);
+}
+
+static void test_thermistor_table_matches_steinhart_hart(void)
+{
+	double worst = 0.0;
+	int32_t worstRaw = 0;
+	double expected;
+	double error;
+	float t;
+	size_t channel;
+	int32_t raw;
+
+	for (channel = 0; channel < THERM_CHANNELS; channel++) {
+		for (raw = 0; raw < COUNTS; raw++) {
+			t = AdcBt6_ConvertThermToTemperature(channel, raw);
+			zassert_true(t >= THERM_MIN_C && t <= THERM_MAX_C,
+				     "raw %d gives %f", raw, (double)t);
+
+			expected = SteinhartHart(raw, SH_A);
+			if (raw == 0 || expected < THERM_MIN_C ||
+			    expected > THERM_MAX_C) {
+				continue;
+			}
+			error = fabs(t - expected);
+			if (error > worst) {
+				worst = error;
+				worstRaw = raw;
+			}
+		}
+	}
+	TC_PRINT("worst error %.3f C at raw %d\n", worst, worstRaw);
+	zassert_true(worst < THERM_MAX_ERROR_C, "error %f at raw %d", worst,
+		     worstRaw);
+
+	/* A short reads hot and an open circuit reads cold */
+	zassert_equal(AdcBt6_ConvertThermToTemperatureMilli(0, 0),
+		      (int32_t)(THERM_MAX_C * 1000), "short not clamped");
+	zassert_equal(AdcBt6_ConvertThermToTemperatureMilli(0, COUNTS - 1),
+		      (int32_t)(THERM_MIN_C * 1000), "open not clamped");
+}
+
+static void test_thermistor_lookup_is_faster(void)
+{
+	volatile float sink;
+	uint32_t start;
+	uint32_t lookup;
+	uint32_t direct;
+	int i;
+	int32_t raw;
+
+	start = k_cycle_get_32();
+	for (i = 0; i < THERM_BENCH_PASSES; i++) {
+		for (raw = 1; raw < COUNTS; raw++) {
+			sink = AdcBt6_ConvertThermToTemperature(0, raw);
+		}
+	}
+	lookup = k_cycle_get_32() - start;
+
+	start = k_cycle_get_32();
+	for (i = 0; i < THERM_BENCH_PASSES; i++) {
+		for (raw = 1; raw < COUNTS; raw++) {
+			sink = SteinhartHartDirect(raw);
+		}
+	}
+	direct = k_cycle_get_32() - start;
+	ARG_UNUSED(sink);
+
+	TC_PRINT("%d conversions: lookup %u cycles, log() %u cycles\n",
+		 THERM_BENCH_PASSES * (COUNTS - 1), lookup, direct);
+	/* Simulated time doesn't advance while native_posix computes */
+	if (direct == 0) {
+		TC_PRINT("cycle counter doesn't measure CPU time here\n");
+		return;
+	}
+	zassert_true(lookup < direct, "lookup %u direct %u", lookup, direct);
+}
+
+static void test_thermistor_rebuild(void)
+{
+	int32_t raw = COUNTS / 2;
+	double a = SH_A * 1.01;
+	float before = AdcBt6_ConvertThermToTemperature(1, raw);
+	float after;
+
+	/* Conversions keep using the old table until the rebuild */
+	attr_set_float(ATTR_ID_therm_2_coefficient_a, a);
+	zassert_equal(AdcBt6_ConvertThermToTemperature(1, raw), before,
+		      "table changed before the rebuild");
+
+	AdcBt6_RebuildThermistorTables();
+	after = AdcBt6_ConvertThermToTemperature(1, raw);
+	zassert_within(after, SteinhartHart(raw, a), THERM_MAX_ERROR_C,
+		       "rebuilt table gives %f", (double)after);
+	zassert_within(AdcBt6_ConvertThermToTemperature(0, raw), before,
+		       THERM_MAX_ERROR_C, "other channel changed");
+
+	attr_set_float(ATTR_ID_therm_2_coefficient_a, SH_A);
+	AdcBt6_RebuildThermistorTables();
+	zassert_equal(AdcBt6_ConvertThermToTemperature(1, raw), before,
+		      "table not restored");
+}
+
+void test_main(void)
+{
+	harness_reset();
+	attr_set_float(ATTR_ID_ge, 1.0f);
+	attr_set_float(ATTR_ID_oe, 0.0f);
+	BSP_Init();
+	zassert_equal(AdcBt6_Init(), 0, "init failed");
+	k_work_init_delayable(&settleWork, SettleWorkHandler);
+
+	ztest_test_suite(adc_bt6,
+			 ztest_unit_test(test_voltage_through_emulator),
+			 ztest_unit_test(test_battery_read_during_settle),
+			 ztest_unit_test(test_rails_are_reference_counted),
+			 ztest_unit_test(test_thermistor_scan_powers_once),
+			 ztest_unit_test(test_expander_writes_per_scan),
+			 ztest_unit_test(test_rms_of_sine),
+			 ztest_unit_test(
+				 test_thermistor_table_matches_steinhart_hart),
+			 ztest_unit_test(test_thermistor_lookup_is_faster),
+			 ztest_unit_test(test_thermistor_rebuild));
+	ztest_run_test_suite(adc_bt6);
+}
@@ -0,0 +1,250 @@
+/**
+ * @file main.c
+ * @brief Tests for the adaptive advertising interval, with an energy
+ * simulation against the fixed interval
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include <ztest.h>
+#include <math.h>
+
+#include "AdvertInterval.h"
+
+/******************************************************************************/
+/* Local Constant, Macro and Type Definitions                                 */
+/******************************************************************************/
+/* Attribute defaults */
+#define FAST_MS 250
+#define IDLE_MS 5000
+#define GROWTH 200
+#define FIXED_MS 1000
+#define DURATION_MS 15000
+#define ALARM_HOLD_MS (60 * MSEC_PER_SEC)
+/* The duration is at least this many intervals */
+#define DURATION_SCALE 4
+
+#define MIN_MS (SEC_PER_MIN * MSEC_PER_SEC)
+#define HOUR_MS (MIN_PER_HOUR * MIN_MS)
+#define DAY_MS (24 * HOUR_MS)
+
+/* A reading is reported every 10 minutes and there are three alarms in the
+ * day, each followed by four more readings in 30 seconds.
+ */
+#define REPORT_PERIOD_MS (10 * MIN_MS)
+#define ALARMS 3
+#define ALARM_BURST 5
+#define ALARM_BURST_SPACING_MS 7500
+#define MAX_EVENTS ((DAY_MS / REPORT_PERIOD_MS) + (ALARMS * ALARM_BURST))
+
+/* Chance that a gateway hears one advertising event. A legacy
+ * advertisement carries one event for one advertising duration.
+ */
+#define HEARD 0.1
+
+typedef struct Event {
+	int64_t time;
+	bool alarm;
+} Event_t;
+
+typedef struct Result {
+	/* Advertising events sent, the radio energy in units of one event */
+	uint32_t adverts;
+	uint32_t offered;
+	double delivered;
+} Result_t;
+
+/******************************************************************************/
+/* Local Data Definitions                                                     */
+/******************************************************************************/
+static const AdvertIntervalConfig_t cfg = { FAST_MS, IDLE_MS, GROWTH };
+static const int64_t alarmTime[ALARMS] = { 3 * HOUR_MS + 1234,
+					   11 * HOUR_MS + 40 * MIN_MS + 77,
+					   19 * HOUR_MS + 5 * MIN_MS + 9000 };
+
+static Event_t events[MAX_EVENTS];
+static size_t eventCount;
+
+/******************************************************************************/
+/* Local Function Definitions                                                 */
+/******************************************************************************/
+static void AddEvent(int64_t time, bool alarm)
+{
+	size_t i = eventCount;
+
+	/* Keep the events in time order */
+	while (i > 0 && events[i - 1].time > time) {
+		events[i] = events[i - 1];
+		i -= 1;
+	}
+	events[i].time = time;
+	events[i].alarm = alarm;
+	eventCount += 1;
+}
+
+static void BuildDay(void)
+{
+	int64_t t;
+	size_t i;
+	size_t j;
+
+	eventCount = 0;
+	for (t = REPORT_PERIOD_MS; t < DAY_MS; t += REPORT_PERIOD_MS) {
+		AddEvent(t, false);
+	}
+	for (i = 0; i < ALARMS; i++) {
+		for (j = 0; j < ALARM_BURST; j++) {
+			AddEvent(alarmTime[i] + (j * ALARM_BURST_SPACING_MS),
+				 (j == 0));
+		}
+	}
+}
+
+/* Step the advertiser once per advertising duration the way BleTask does:
+ * take one pending event, pick the interval and advertise it until the
+ * duration ends. An alarm speeds up the duration that is running.
+ */
+static void Simulate(bool adaptive, Result_t *result)
+{
+	int64_t lastAlarm = -ALARM_HOLD_MS;
+	uint32_t interval = adaptive ? IDLE_MS : FIXED_MS;
+	uint32_t pending = 0;
+	uint32_t adverts;
+	size_t next = 0;
+	size_t arrival;
+	int64_t t = 0;
+	int64_t start;
+	int64_t end;
+	bool busy;
+	bool taken;
+
+	memset(result, 0, sizeof(*result));
+	while (t < DAY_MS) {
+		while (next < eventCount && events[next].time <= t) {
+			pending += 1;
+			next += 1;
+		}
+		taken = (pending > 0);
+		pending -= taken ? 1 : 0;
+
+		if (adaptive) {
+			busy = taken || (t - lastAlarm < ALARM_HOLD_MS);
+			interval = AdvertInterval_Next(interval, busy, &cfg);
+		}
+		end = t + MAX(DURATION_MS, DURATION_SCALE * interval);
+
+		adverts = 0;
+		start = t;
+		for (arrival = next;
+		     arrival < eventCount && events[arrival].time < end;
+		     arrival++) {
+			if (!events[arrival].alarm) {
+				continue;
+			}
+			lastAlarm = events[arrival].time;
+			if (adaptive && interval != FAST_MS) {
+				adverts += (lastAlarm - start) / interval;
+				start = lastAlarm;
+				interval = AdvertInterval_Next(interval, true,
+							       &cfg);
+			}
+		}
+		adverts += (end - start) / interval;
+
+		result->adverts += adverts;
+		if (taken) {
+			result->offered += 1;
+			result->delivered += 1.0 - pow(1.0 - HEARD, adverts);
+		}
+		t = end;
+	}
+}
+
+static uint32_t AdvertsPerDelivered(const Result_t *result)
+{
+	return (uint32_t)lround(result->adverts / result->delivered);
+}
+
+/******************************************************************************/
+/* Tests                                                                      */
+/******************************************************************************/
+static void test_busy_is_fast(void)
+{
+	zassert_equal(AdvertInterval_Next(IDLE_MS, true, &cfg), FAST_MS,
+		      "busy isn't fast");
+	zassert_equal(AdvertInterval_Next(FAST_MS, true, &cfg), FAST_MS,
+		      "busy isn't fast");
+}
+
+static void test_idle_grows_to_idle(void)
+{
+	const uint32_t expected[] = { 500, 1000, 2000, 4000, IDLE_MS, IDLE_MS };
+	uint32_t interval = FAST_MS;
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE(expected); i++) {
+		interval = AdvertInterval_Next(interval, false, &cfg);
+		zassert_equal(interval, expected[i], "step %zu", i);
+	}
+}
+
+static void test_growth_and_bounds(void)
+{
+	const AdvertIntervalConfig_t slow = { FAST_MS, IDLE_MS, 150 };
+	const AdvertIntervalConfig_t steep = { FAST_MS, 10000, 1000 };
+
+	zassert_equal(AdvertInterval_Next(1000, false, &slow), 1500,
+		      "150 percent growth");
+	/* No interval yet, and an idle interval that was lowered */
+	zassert_equal(AdvertInterval_Next(0, false, &cfg), FAST_MS,
+		      "below the fast interval");
+	zassert_equal(AdvertInterval_Next(8000, false, &cfg), IDLE_MS,
+		      "above the idle interval");
+	zassert_equal(AdvertInterval_Next(UINT32_MAX, false, &steep), 10000,
+		      "growth overflowed");
+}
+
+static void test_energy_per_delivered_event(void)
+{
+	Result_t adaptive;
+	Result_t fixed;
+
+	BuildDay();
+	Simulate(true, &adaptive);
+	Simulate(false, &fixed);
+
+	TC_PRINT("adaptive: %u adverts, %u of %u events delivered, "
+		 "%u adverts per delivered event\n",
+		 adaptive.adverts, (uint32_t)lround(adaptive.delivered),
+		 adaptive.offered, AdvertsPerDelivered(&adaptive));
+	TC_PRINT("fixed %u ms: %u adverts, %u of %u events delivered, "
+		 "%u adverts per delivered event\n",
+		 FIXED_MS, fixed.adverts, (uint32_t)lround(fixed.delivered),
+		 fixed.offered, AdvertsPerDelivered(&fixed));
+
+	zassert_equal(adaptive.offered, eventCount, "events left pending");
+	zassert_equal(fixed.offered, eventCount, "events left pending");
+	/* At least as many events get through for much less radio time */
+	zassert_true(adaptive.delivered >= fixed.delivered,
+		     "fewer events delivered");
+	zassert_true(AdvertsPerDelivered(&adaptive) * 2 <
+			     AdvertsPerDelivered(&fixed),
+		     "adaptive %u fixed %u adverts per delivered event",
+		     AdvertsPerDelivered(&adaptive),
+		     AdvertsPerDelivered(&fixed));
+}
+
+void test_main(void)
+{
+	ztest_test_suite(advert_interval,
+			 ztest_unit_test(test_busy_is_fast),
+			 ztest_unit_test(test_idle_grows_to_idle),
+			 ztest_unit_test(test_growth_and_bounds),
+			 ztest_unit_test(test_energy_per_delivered_event));
+	ztest_run_test_suite(advert_interval);
+}
@@ -0,0 +1,38 @@
+# Copyright (c) 2022 Laird Connectivity
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Runs the sensor path on native_posix. The ADC, the TCA9538 expander and the
+# GPIO ports are emulated and the laird_connect framework, attributes, locks,
+# BSP and BLE task are replaced by the stubs in src.
+#
+# Include this before find_package(Zephyr) and call bt6xx_harness() after it.
+
+set(BT6XX_HARNESS_DIR ${CMAKE_CURRENT_LIST_DIR})
+set(BT6XX_DIR ${BT6XX_HARNESS_DIR}/../..)
+
+list(APPEND DTS_ROOT ${BT6XX_HARNESS_DIR})
+set(DTC_OVERLAY_FILE ${BT6XX_HARNESS_DIR}/boards/native_posix.overlay)
+
+function(bt6xx_harness)
+    # The attribute table asserts that its enums are a single byte
+    zephyr_compile_options(-fshort-enums)
+
+    target_include_directories(app PRIVATE
+        ${BT6XX_DIR}/include
+        ${BT6XX_DIR}/src/framework_config
+        ${BT6XX_DIR}/components/attributes/bt610/include
+        ${BT6XX_HARNESS_DIR}/include
+    )
+
+    target_sources(app PRIVATE
+        ${BT6XX_HARNESS_DIR}/src/harness.c
+        ${BT6XX_HARNESS_DIR}/src/framework_stub.c
+        ${BT6XX_HARNESS_DIR}/src/locking_stub.c
+        ${BT6XX_HARNESS_DIR}/src/attr_stub.c
+        ${BT6XX_HARNESS_DIR}/src/storage_stub.c
+        ${BT6XX_HARNESS_DIR}/src/bsp_emul.c
+        ${BT6XX_HARNESS_DIR}/src/ble_stub.c
+        ${BT6XX_HARNESS_DIR}/src/tca9538_emul.c
+    )
+endfunction()
@@ -0,0 +1,33 @@
+/**
+ * @file BufferPool.h
+ * @brief Host test stand-in for the laird_connect buffer pool
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __BUFFER_POOL_H__
+#define __BUFFER_POOL_H__
+
+#include <zephyr/types.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Allocate a zeroed message buffer from the system heap.
+ *
+ * @retval NULL when the harness is failing allocations or the heap is
+ * exhausted
+ */
+void *BufferPool_Take(size_t size);
+
+void BufferPool_Free(void *pBuffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BUFFER_POOL_H__ */
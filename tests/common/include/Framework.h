@@ -0,0 +1,63 @@
+/**
+ * @file Framework.h
+ * @brief Host test stand-in for the laird_connect message framework
+ *
+ * Only the types used by the modules under test are defined. Messages are
+ * captured by the harness instead of being dispatched to tasks.
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __FRAMEWORK_H__
+#define __FRAMEWORK_H__
+
+#include <zephyr/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint8_t FwkId_t;
+typedef uint8_t FwkMsgCode_t;
+
+typedef struct FwkMsgHeader {
+	FwkMsgCode_t msgCode;
+	FwkId_t rxId;
+	FwkId_t txId;
+	uint8_t options;
+} FwkMsgHeader_t;
+
+typedef struct FwkMsg {
+	FwkMsgHeader_t header;
+} FwkMsg_t;
+
+typedef enum DispatchResult {
+	DISPATCH_OK = 0,
+	DISPATCH_ERROR,
+	DISPATCH_DO_NOT_FREE
+} DispatchResult_t;
+
+typedef struct FwkMsgReceiver FwkMsgReceiver_t;
+
+typedef DispatchResult_t FwkMsgHandler_t(FwkMsgReceiver_t *pMsgRxer,
+					 FwkMsg_t *pMsg);
+
+struct FwkMsgReceiver {
+	FwkId_t id;
+	FwkMsgHandler_t *(*pMsgDispatcher)(FwkMsgCode_t MsgCode);
+};
+
+/**
+ * @brief Hand a message to the harness. The harness owns the buffer
+ * afterwards.
+ *
+ * @retval 0 on success
+ */
+int Framework_Send(FwkId_t RxId, FwkMsg_t *pMsg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FRAMEWORK_H__ */
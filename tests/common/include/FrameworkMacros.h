@@ -0,0 +1,14 @@
+/**
+ * @file FrameworkMacros.h
+ * @brief Host test stand-in for the laird_connect framework macros
+ *
+ * None of the macros are used by the modules under test.
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __FRAMEWORK_MACROS_H__
+#define __FRAMEWORK_MACROS_H__
+
+#endif /* __FRAMEWORK_MACROS_H__ */
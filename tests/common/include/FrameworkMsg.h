@@ -0,0 +1,30 @@
+/**
+ * @file FrameworkMsg.h
+ * @brief Host test stand-in for the laird_connect message macros
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __FRAMEWORK_MSG_H__
+#define __FRAMEWORK_MSG_H__
+
+#include "Framework.h"
+#include "BufferPool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FRAMEWORK_MSG_SEND(p)                                                  \
+	do {                                                                   \
+		if (Framework_Send((p)->header.rxId, (FwkMsg_t *)(p)) != 0) { \
+			BufferPool_Free(p);                                    \
+		}                                                              \
+	} while (0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FRAMEWORK_MSG_H__ */
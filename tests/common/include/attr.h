@@ -0,0 +1,43 @@
+/**
+ * @file attr.h
+ * @brief Host test stand-in for the laird_connect attribute API
+ *
+ * Attributes are held in memory with the size they were last set with.
+ * Reading an attribute that was never set returns -EINVAL, or the
+ * alternate value for the typed getters.
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __ATTR_H__
+#define __ATTR_H__
+
+#include <zephyr/types.h>
+#include <stddef.h>
+
+#include "attr_defs.h"
+#include "attr_table.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int attr_get(attr_id_t id, void *pv, size_t vlen);
+float attr_get_float(attr_id_t id, float alt);
+uint32_t attr_get_uint32(attr_id_t id, uint32_t alt);
+int attr_copy_float(float *pv, attr_id_t id);
+int attr_set_float(attr_id_t id, float value);
+int attr_set_uint32(attr_id_t id, uint32_t value);
+int attr_set_signed32(attr_id_t id, int32_t value);
+
+/**
+ * @brief Forget all of the attribute values.
+ */
+void attr_stub_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ATTR_H__ */
@@ -0,0 +1,37 @@
+/**
+ * @file attr_defs.h
+ * @brief Host test stand-in for the laird_connect attribute definitions
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __ATTR_DEFS_H__
+#define __ATTR_DEFS_H__
+
+#include <zephyr/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint16_t attr_id_t;
+typedef uint16_t attr_index_t;
+typedef struct attr_table_entry ate_t;
+
+#define ATTR_SIZE_BOOL 1
+#define ATTR_SIZE_U8 1
+#define ATTR_SIZE_S8 1
+#define ATTR_SIZE_U16 2
+#define ATTR_SIZE_S16 2
+#define ATTR_SIZE_U32 4
+#define ATTR_SIZE_S32 4
+#define ATTR_SIZE_FLOAT 4
+#define ATTR_SIZE_U64 8
+#define ATTR_SIZE_S64 8
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ATTR_DEFS_H__ */
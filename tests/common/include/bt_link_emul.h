@@ -0,0 +1,92 @@
+/**
+ * @file bt_link_emul.h
+ * @brief Emulated Bluetooth link for the GATT notification tests
+ *
+ * The emulator replaces the Bluetooth host calls used by a GATT server that
+ * notifies a single client. Notifications take a TX buffer and are sent in
+ * order at each connection event, a limited number per event. The sent
+ * callback of a notification runs once it has been sent, as on a real link.
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __BT_LINK_EMUL_H__
+#define __BT_LINK_EMUL_H__
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include <zephyr/types.h>
+#include <bluetooth/gatt.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/* Global Constants, Macros and Type Definitions                              */
+/******************************************************************************/
+#define BT_LINK_EMUL_MAX_BUFFERS 16
+#define BT_LINK_EMUL_MAX_PAYLOAD 256
+
+typedef struct bt_link_emul_config {
+	uint16_t mtu;
+	uint32_t interval_ms;
+	/* Notifications sent per connection event */
+	uint8_t per_event;
+	/* TX buffers, at most BT_LINK_EMUL_MAX_BUFFERS */
+	uint8_t buffers;
+} bt_link_emul_config_t;
+
+/* Called with the payload of each notification as it is sent */
+typedef void (*bt_link_emul_rx_t)(const uint8_t *data, uint16_t len);
+
+/******************************************************************************/
+/* Global Function Prototypes                                                 */
+/******************************************************************************/
+/**
+ * @brief Connect a client. The registered connected callbacks are called.
+ *
+ * @param cfg of the link
+ * @param rx called for each notification the client receives
+ */
+void bt_link_emul_connect(const bt_link_emul_config_t *cfg,
+			  bt_link_emul_rx_t rx);
+
+/**
+ * @brief Disconnect the client. Notifications that haven't been sent are
+ * discarded without calling their sent callbacks.
+ */
+void bt_link_emul_disconnect(void);
+
+/**
+ * @brief Write the client configuration descriptor as the client would
+ *
+ * @param ccc attribute of the characteristic
+ * @param value BT_GATT_CCC_NOTIFY or 0
+ */
+void bt_link_emul_subscribe(const struct bt_gatt_attr *ccc, uint16_t value);
+
+/**
+ * @brief Change the number of TX buffers while connected. With 0 every
+ * notification fails with -ENOMEM.
+ */
+void bt_link_emul_set_buffers(uint8_t buffers);
+
+/**
+ * @brief Get the number of notifications sent since the client connected
+ */
+uint32_t bt_link_emul_notifications(void);
+
+/**
+ * @brief Get the number of references held on the link, including the one
+ * held by the emulator while connected.
+ */
+int bt_link_emul_refs(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BT_LINK_EMUL_H__ */
@@ -0,0 +1,31 @@
+/**
+ * @file file_system_utilities.h
+ * @brief Host test stand-in for the laird_connect file system utilities
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __FILE_SYSTEM_UTILITIES_H__
+#define __FILE_SYSTEM_UTILITIES_H__
+
+#include <zephyr/types.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CONFIG_FSU_MOUNT_POINT
+#define CONFIG_FSU_MOUNT_POINT "/lfs"
+#endif
+
+ssize_t fsu_append(const char *path, const char *name, void *data,
+		   size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FILE_SYSTEM_UTILITIES_H__ */
@@ -0,0 +1,28 @@
+/**
+ * @file framework_ids.h
+ * @brief Host test stand-in for the generated framework ids
+ *
+ * The project list is included the same way the framework does.
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __FRAMEWORK_IDS_H__
+#define __FRAMEWORK_IDS_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum FwkIdEnum {
+	FWK_ID_RESERVED = 0,
+#include "framework_ids_list.h"
+	FRAMEWORK_NUMBER_OF_IDS
+};
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FRAMEWORK_IDS_H__ */
@@ -0,0 +1,29 @@
+/**
+ * @file framework_msgcodes.h
+ * @brief Host test stand-in for the generated framework message codes
+ *
+ * The project list is included the same way the framework does.
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __FRAMEWORK_MSGCODES_H__
+#define __FRAMEWORK_MSGCODES_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum FwkMsgCodeEnum {
+	FMC_INVALID = 0,
+	FMC_ATTR_CHANGED,
+#include "framework_msg_codes_list.h"
+	FRAMEWORK_NUMBER_OF_MSG_CODES
+};
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FRAMEWORK_MSGCODES_H__ */
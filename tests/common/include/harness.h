@@ -0,0 +1,88 @@
+/**
+ * @file harness.h
+ * @brief Test access to the native_posix harness
+ *
+ * The harness replaces the laird_connect framework, attributes and locks,
+ * the BSP and the BLE tasks so that the sensor path can run against the
+ * emulated ADC, I/O expander and GPIO ports described by
+ * boards/native_posix.overlay.
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __HARNESS_H__
+#define __HARNESS_H__
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include <zephyr.h>
+#include <zephyr/types.h>
+#include <stddef.h>
+
+#include "Framework.h"
+#include "lcz_sensor_event.h"
+#include "Advertisement.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/* Global Constants, Macros and Type Definitions                              */
+/******************************************************************************/
+#define HARNESS_BLE_EVENTS 32
+
+typedef struct HarnessBle {
+	SensorMsg_t event[HARNESS_BLE_EVENTS];
+	size_t events;
+	/* Every call to Advertisement_IntervalSet */
+	uint32_t intervalMs;
+	uint32_t intervalChanges;
+} HarnessBle_t;
+
+/******************************************************************************/
+/* Global Function Prototypes                                                 */
+/******************************************************************************/
+/**
+ * @brief Clear the attributes, the captured messages and BLE calls, and
+ * stop failing buffer allocations.
+ */
+void harness_reset(void);
+
+/**
+ * @brief Wait for the next message sent through the framework.
+ *
+ * @param timeout how long to wait
+ *
+ * @retval the message, which the caller frees with BufferPool_Free, or NULL
+ */
+FwkMsg_t *harness_msg_get(k_timeout_t timeout);
+
+/**
+ * @brief Make the following BufferPool_Take calls fail.
+ *
+ * @param count number of allocations to fail
+ */
+void harness_buffer_fail(uint32_t count);
+
+/**
+ * @brief Get the state of an output driven through BSP_PinSet.
+ *
+ * @param pin is a BspSupport.h pin number
+ *
+ * @retval 0 or 1, or a negative error code if the pin isn't an output
+ */
+int harness_pin_get(uint8_t pin);
+
+/**
+ * @brief Get the events and advertising intervals passed to the BLE task.
+ */
+const HarnessBle_t *harness_ble(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HARNESS_H__ */
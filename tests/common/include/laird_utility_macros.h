@@ -0,0 +1,25 @@
+/**
+ * @file laird_utility_macros.h
+ * @brief Host test stand-in for the laird_connect utility macros
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __LAIRD_UTILITY_MACROS_H__
+#define __LAIRD_UTILITY_MACROS_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SWITCH_CASE_RETURN_STRING(val)                                         \
+	case val: {                                                            \
+		return #val;                                                   \
+	}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LAIRD_UTILITY_MACROS_H__ */
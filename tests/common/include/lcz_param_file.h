@@ -0,0 +1,29 @@
+/**
+ * @file lcz_param_file.h
+ * @brief Host test stand-in for the laird_connect parameter files
+ *
+ * Nothing is stored. Reads fail as they do before a file has been written.
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __LCZ_PARAM_FILE_H__
+#define __LCZ_PARAM_FILE_H__
+
+#include <zephyr/types.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+ssize_t lcz_param_file_read(const char *name, void *data, size_t size);
+ssize_t lcz_param_file_write(const char *name, void *data, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LCZ_PARAM_FILE_H__ */
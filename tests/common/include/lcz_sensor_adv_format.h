@@ -0,0 +1,14 @@
+/**
+ * @file lcz_sensor_adv_format.h
+ * @brief Host test stand-in for the laird_connect advertisement format
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __LCZ_SENSOR_ADV_FORMAT_H__
+#define __LCZ_SENSOR_ADV_FORMAT_H__
+
+#define LAIRD_CONNECTIVITY_MANUFACTURER_SPECIFIC_COMPANY_ID1 0x0077
+
+#endif /* __LCZ_SENSOR_ADV_FORMAT_H__ */
@@ -0,0 +1,50 @@
+/**
+ * @file lcz_sensor_event.h
+ * @brief Host test stand-in for the laird_connect sensor event types
+ *
+ * Only the types used by the modules under test are defined. The event
+ * type values are arbitrary, the tests don't depend on them.
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __LCZ_SENSOR_EVENT_H__
+#define __LCZ_SENSOR_EVENT_H__
+
+#include <zephyr/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+	SENSOR_EVENT_RESERVED = 0,
+	SENSOR_EVENT_TEMPERATURE_1,
+	SENSOR_EVENT_TEMPERATURE_2,
+	SENSOR_EVENT_MAGNET,
+	SENSOR_EVENT_TAMPER,
+	SENSOR_EVENT_BATTERY_BAD,
+} SensorEventType_t;
+
+typedef union {
+	uint32_t u32;
+	int32_t s32;
+	float f;
+	uint16_t u16;
+	int16_t s16;
+	uint8_t u8;
+	int8_t s8;
+} SensorEventData_t;
+
+typedef struct {
+	SensorEventType_t type;
+	SensorEventData_t data;
+	uint32_t timestamp;
+} SensorEvent_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LCZ_SENSOR_EVENT_H__ */
@@ -0,0 +1,28 @@
+/**
+ * @file locking.h
+ * @brief Host test stand-in for the laird_connect locks
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __LOCKING_H__
+#define __LOCKING_H__
+
+#include <zephyr.h>
+
+#include "locking_defs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int locking_take(enum locking_id id, k_timeout_t timeout);
+
+int locking_give(enum locking_id id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LOCKING_H__ */
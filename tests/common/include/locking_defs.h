@@ -0,0 +1,25 @@
+/**
+ * @file locking_defs.h
+ * @brief Host test stand-in for the laird_connect lock ids
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __LOCKING_DEFS_H__
+#define __LOCKING_DEFS_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum locking_id {
+	LOCKING_ID_adc = 0,
+	LOCKING_ID_COUNT
+};
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LOCKING_DEFS_H__ */
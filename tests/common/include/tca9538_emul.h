@@ -0,0 +1,69 @@
+/**
+ * @file tca9538_emul.h
+ * @brief Emulated TCA9538 I/O expander for the host tests
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __TCA9538_EMUL_H__
+#define __TCA9538_EMUL_H__
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include <zephyr/types.h>
+#include <drivers/emul.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/* Global Constants, Macros and Type Definitions                              */
+/******************************************************************************/
+#define TCA9538_EMUL_REG_INPUT 0x00
+#define TCA9538_EMUL_REG_OUTPUT 0x01
+#define TCA9538_EMUL_REG_POL_INV 0x02
+#define TCA9538_EMUL_REG_CONFIG 0x03
+#define TCA9538_EMUL_NUMBER_OF_REGS 4
+
+/******************************************************************************/
+/* Global Function Prototypes                                                 */
+/******************************************************************************/
+/**
+ * @brief Get the value of an expander register.
+ *
+ * @param target is the emulator
+ * @param reg is one of TCA9538_EMUL_REG_*
+ *
+ * @retval the register value
+ */
+uint8_t tca9538_emul_reg(const struct emul *target, uint8_t reg);
+
+/**
+ * @brief Get the number of bus transactions addressed to the expander since
+ * the last reset.
+ *
+ * @note A transaction is one call to i2c_transfer, however many messages it
+ * holds.
+ */
+uint32_t tca9538_emul_transactions(const struct emul *target);
+
+/**
+ * @brief Start counting transactions from 0.
+ */
+void tca9538_emul_reset_count(const struct emul *target);
+
+/**
+ * @brief Make the following transactions fail with -EIO.
+ *
+ * @param fail true to fail, false to respond normally
+ */
+void tca9538_emul_set_fail(const struct emul *target, bool fail);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TCA9538_EMUL_H__ */
@@ -0,0 +1,116 @@
+/**
+ * @file attr_stub.c
+ * @brief In-memory attributes for the host tests
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include <zephyr.h>
+#include <string.h>
+#include <errno.h>
+
+#include "attr.h"
+
+/******************************************************************************/
+/* Local Constant, Macro and Type Definitions                                 */
+/******************************************************************************/
+typedef struct AttrValue {
+	uint8_t size;
+	uint8_t value[ATTR_MAX_INT_SIZE];
+} AttrValue_t;
+
+/******************************************************************************/
+/* Local Data Definitions                                                     */
+/******************************************************************************/
+static AttrValue_t attrs[ATTR_TABLE_SIZE];
+static K_MUTEX_DEFINE(attrMutex);
+
+/******************************************************************************/
+/* Local Function Prototypes                                                  */
+/******************************************************************************/
+static int Set(attr_id_t id, const void *pv, size_t vlen);
+
+/******************************************************************************/
+/* Global Function Definitions                                                */
+/******************************************************************************/
+int attr_get(attr_id_t id, void *pv, size_t vlen)
+{
+	int r = -EINVAL;
+
+	if (id >= ATTR_TABLE_SIZE) {
+		return r;
+	}
+
+	k_mutex_lock(&attrMutex, K_FOREVER);
+	if (attrs[id].size != 0 && vlen >= attrs[id].size) {
+		memcpy(pv, attrs[id].value, attrs[id].size);
+		r = attrs[id].size;
+	}
+	k_mutex_unlock(&attrMutex);
+	return r;
+}
+
+float attr_get_float(attr_id_t id, float alt)
+{
+	float v;
+
+	return (attr_get(id, &v, sizeof(v)) == sizeof(v)) ? v : alt;
+}
+
+uint32_t attr_get_uint32(attr_id_t id, uint32_t alt)
+{
+	uint32_t v = 0;
+	int r = attr_get(id, &v, sizeof(v));
+
+	/* Smaller values are zero extended like the real getter */
+	return (r > 0) ? v : alt;
+}
+
+int attr_copy_float(float *pv, attr_id_t id)
+{
+	return attr_get(id, pv, sizeof(*pv));
+}
+
+int attr_set_float(attr_id_t id, float value)
+{
+	return Set(id, &value, sizeof(value));
+}
+
+int attr_set_uint32(attr_id_t id, uint32_t value)
+{
+	return Set(id, &value, sizeof(value));
+}
+
+int attr_set_signed32(attr_id_t id, int32_t value)
+{
+	return Set(id, &value, sizeof(value));
+}
+
+void attr_stub_reset(void)
+{
+	k_mutex_lock(&attrMutex, K_FOREVER);
+	memset(attrs, 0, sizeof(attrs));
+	k_mutex_unlock(&attrMutex);
+}
+
+/******************************************************************************/
+/* Local Function Definitions                                                 */
+/******************************************************************************/
+static int Set(attr_id_t id, const void *pv, size_t vlen)
+{
+	if (id >= ATTR_TABLE_SIZE || vlen > ATTR_MAX_INT_SIZE) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&attrMutex, K_FOREVER);
+	memset(attrs[id].value, 0, sizeof(attrs[id].value));
+	memcpy(attrs[id].value, pv, vlen);
+	attrs[id].size = vlen;
+	k_mutex_unlock(&attrMutex);
+	return 0;
+}
@@ -0,0 +1,67 @@
+/**
+ * @file ble_stub.c
+ * @brief Records what the sensor path hands to the BLE task
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include <zephyr.h>
+#include <string.h>
+
+#include "BleTask.h"
+#include "Advertisement.h"
+#include "harness.h"
+#include "harness_internal.h"
+
+/******************************************************************************/
+/* Local Data Definitions                                                     */
+/******************************************************************************/
+static HarnessBle_t ble;
+static K_MUTEX_DEFINE(bleMutex);
+
+/******************************************************************************/
+/* Global Function Definitions                                                */
+/******************************************************************************/
+bool ble_is_connected(void)
+{
+	return false;
+}
+
+int BleTask_PostEvent(const SensorMsg_t *sensor_event)
+{
+	int r = -ENOMEM;
+
+	k_mutex_lock(&bleMutex, K_FOREVER);
+	if (ble.events < ARRAY_SIZE(ble.event)) {
+		ble.event[ble.events++] = *sensor_event;
+		r = 0;
+	}
+	k_mutex_unlock(&bleMutex);
+	return r;
+}
+
+int Advertisement_IntervalSet(uint32_t milliseconds)
+{
+	k_mutex_lock(&bleMutex, K_FOREVER);
+	ble.intervalMs = milliseconds;
+	ble.intervalChanges += 1;
+	k_mutex_unlock(&bleMutex);
+	return 0;
+}
+
+const HarnessBle_t *harness_ble(void)
+{
+	return &ble;
+}
+
+void harness_ble_reset(void)
+{
+	k_mutex_lock(&bleMutex, K_FOREVER);
+	memset(&ble, 0, sizeof(ble));
+	k_mutex_unlock(&bleMutex);
+}
@@ -0,0 +1,105 @@
+/**
+ * @file bsp_emul.c
+ * @brief BSP outputs on the emulated GPIO ports
+ *
+ * The pins are assigned to ports the same way as BspSupport.c. Only the
+ * outputs are supported.
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include <zephyr.h>
+#include <device.h>
+#include <drivers/gpio.h>
+#include <drivers/gpio/gpio_emul.h>
+
+#include "BspSupport.h"
+#include "harness.h"
+
+/******************************************************************************/
+/* Local Data Definitions                                                     */
+/******************************************************************************/
+static const struct device *const port0 = DEVICE_DT_GET(DT_NODELABEL(gpio0));
+static const struct device *const port1 = DEVICE_DT_GET(DT_NODELABEL(gpio1));
+
+/******************************************************************************/
+/* Local Function Prototypes                                                  */
+/******************************************************************************/
+static const struct device *GetPort(uint8_t pin);
+
+/******************************************************************************/
+/* Global Function Definitions                                                */
+/******************************************************************************/
+void BSP_Init(void)
+{
+	static const uint8_t OUTPUTS[] = { THERM_ENABLE_PIN,
+					   DO2_PIN,
+					   DO1_PIN,
+					   BATT_OUT_ENABLE_PIN,
+					   DIN1_ENABLE_PIN,
+					   FIVE_VOLT_ENABLE_PIN,
+					   DIN2_ENABLE_PIN,
+					   ANALOG_ENABLE_PIN };
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE(OUTPUTS); i++) {
+		gpio_pin_configure(GetPort(OUTPUTS[i]),
+				   GPIO_PIN_MAP(OUTPUTS[i]),
+				   GPIO_OUTPUT_INACTIVE);
+	}
+}
+
+int BSP_PinSet(uint8_t pin, int value)
+{
+	const struct device *port = GetPort(pin);
+
+	return (port == NULL) ? -ENODEV :
+				gpio_pin_set(port, GPIO_PIN_MAP(pin), value);
+}
+
+int BSP_PinToggle(uint8_t pin)
+{
+	const struct device *port = GetPort(pin);
+
+	return (port == NULL) ? -ENODEV :
+				gpio_pin_toggle(port, GPIO_PIN_MAP(pin));
+}
+
+int BSP_PinGet(uint8_t pin)
+{
+	return harness_pin_get(pin);
+}
+
+int harness_pin_get(uint8_t pin)
+{
+	const struct device *port = GetPort(pin);
+
+	return (port == NULL) ? -ENODEV :
+				gpio_emul_output_get(port, GPIO_PIN_MAP(pin));
+}
+
+/******************************************************************************/
+/* Local Function Definitions                                                 */
+/******************************************************************************/
+static const struct device *GetPort(uint8_t pin)
+{
+	switch (pin) {
+	case THERM_ENABLE_PIN:
+	case DO2_PIN:
+	case DO1_PIN:
+	case BATT_OUT_ENABLE_PIN:
+		return port0;
+	case DIN1_ENABLE_PIN:
+	case FIVE_VOLT_ENABLE_PIN:
+	case DIN2_ENABLE_PIN:
+	case ANALOG_ENABLE_PIN:
+		return port1;
+	default:
+		return NULL;
+	}
+}
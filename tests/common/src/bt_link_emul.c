@@ -0,0 +1,256 @@
+/**
+ * @file bt_link_emul.c
+ * @brief Emulated Bluetooth link for the GATT notification tests
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include <zephyr.h>
+#include <string.h>
+#include <bluetooth/bluetooth.h>
+#include <bluetooth/conn.h>
+#include <bluetooth/gatt.h>
+
+#include "bt_link_emul.h"
+
+/******************************************************************************/
+/* Local Constant, Macro and Type Definitions                                 */
+/******************************************************************************/
+#define MAX_CALLBACKS 4
+
+struct bt_conn {
+	atomic_t refs;
+};
+
+typedef struct Notification {
+	bt_gatt_complete_func_t func;
+	void *user_data;
+	uint8_t data[BT_LINK_EMUL_MAX_PAYLOAD];
+	uint16_t len;
+} Notification_t;
+
+typedef struct Link {
+	bool connected;
+	bt_link_emul_config_t cfg;
+	bt_link_emul_rx_t rx;
+	/* Notifications waiting for a connection event, oldest first */
+	Notification_t queue[BT_LINK_EMUL_MAX_BUFFERS];
+	size_t head;
+	size_t count;
+	uint32_t notifications;
+} Link_t;
+
+/******************************************************************************/
+/* Local Function Prototypes                                                  */
+/******************************************************************************/
+static void ConnectionEvent(struct k_work *work);
+
+/******************************************************************************/
+/* Local Data Definitions                                                     */
+/******************************************************************************/
+static struct bt_conn conn;
+static Link_t emulLink;
+static struct bt_conn_cb *callbacks[MAX_CALLBACKS];
+static size_t callbackCount;
+static K_MUTEX_DEFINE(linkMutex);
+static K_WORK_DELAYABLE_DEFINE(eventWork, ConnectionEvent);
+
+/******************************************************************************/
+/* Global Function Definitions                                                */
+/******************************************************************************/
+void bt_conn_cb_register(struct bt_conn_cb *cb)
+{
+	if (callbackCount < MAX_CALLBACKS) {
+		callbacks[callbackCount++] = cb;
+	}
+}
+
+struct bt_conn *bt_conn_ref(struct bt_conn *c)
+{
+	atomic_inc(&c->refs);
+	return c;
+}
+
+void bt_conn_unref(struct bt_conn *c)
+{
+	__ASSERT(atomic_get(&c->refs) > 0, "Link reference underflow");
+	atomic_dec(&c->refs);
+}
+
+uint16_t bt_gatt_get_mtu(struct bt_conn *c)
+{
+	ARG_UNUSED(c);
+
+	return emulLink.cfg.mtu;
+}
+
+int bt_gatt_notify_cb(struct bt_conn *c, struct bt_gatt_notify_params *params)
+{
+	Notification_t *n;
+	size_t i;
+	int r = 0;
+
+	ARG_UNUSED(c);
+
+	k_mutex_lock(&linkMutex, K_FOREVER);
+	if (!emulLink.connected) {
+		r = -ENOTCONN;
+	} else if (params->len > (emulLink.cfg.mtu - 3) ||
+		   params->len > BT_LINK_EMUL_MAX_PAYLOAD) {
+		r = -EINVAL;
+	} else if (emulLink.count >= emulLink.cfg.buffers) {
+		r = -ENOMEM;
+	} else {
+		i = (emulLink.head + emulLink.count) % BT_LINK_EMUL_MAX_BUFFERS;
+		n = &emulLink.queue[i];
+		n->func = params->func;
+		n->user_data = params->user_data;
+		memcpy(n->data, params->data, params->len);
+		n->len = params->len;
+		emulLink.count += 1;
+	}
+	k_mutex_unlock(&linkMutex);
+	return r;
+}
+
+/* The GATT service macros refer to these */
+ssize_t bt_gatt_attr_read_service(struct bt_conn *c,
+				  const struct bt_gatt_attr *attr, void *buf,
+				  uint16_t len, uint16_t offset)
+{
+	return -ENOTSUP;
+}
+
+ssize_t bt_gatt_attr_read_chrc(struct bt_conn *c,
+			       const struct bt_gatt_attr *attr, void *buf,
+			       uint16_t len, uint16_t offset)
+{
+	return -ENOTSUP;
+}
+
+ssize_t bt_gatt_attr_read_ccc(struct bt_conn *c,
+			      const struct bt_gatt_attr *attr, void *buf,
+			      uint16_t len, uint16_t offset)
+{
+	return -ENOTSUP;
+}
+
+ssize_t bt_gatt_attr_write_ccc(struct bt_conn *c,
+			       const struct bt_gatt_attr *attr,
+			       const void *buf, uint16_t len, uint16_t offset,
+			       uint8_t flags)
+{
+	return -ENOTSUP;
+}
+
+void bt_link_emul_connect(const bt_link_emul_config_t *cfg,
+			  bt_link_emul_rx_t rx)
+{
+	size_t i;
+
+	k_mutex_lock(&linkMutex, K_FOREVER);
+	memset(&emulLink, 0, sizeof(emulLink));
+	emulLink.cfg = *cfg;
+	emulLink.cfg.buffers = MIN(cfg->buffers, BT_LINK_EMUL_MAX_BUFFERS);
+	emulLink.rx = rx;
+	emulLink.connected = true;
+	k_mutex_unlock(&linkMutex);
+
+	atomic_set(&conn.refs, 1);
+	for (i = 0; i < callbackCount; i++) {
+		if (callbacks[i]->connected != NULL) {
+			callbacks[i]->connected(&conn, 0);
+		}
+	}
+	k_work_schedule(&eventWork, K_MSEC(cfg->interval_ms));
+}
+
+void bt_link_emul_disconnect(void)
+{
+	size_t i;
+
+	k_mutex_lock(&linkMutex, K_FOREVER);
+	emulLink.connected = false;
+	emulLink.count = 0;
+	k_mutex_unlock(&linkMutex);
+	k_work_cancel_delayable(&eventWork);
+
+	for (i = 0; i < callbackCount; i++) {
+		if (callbacks[i]->disconnected != NULL) {
+			callbacks[i]->disconnected(
+				&conn, BT_HCI_ERR_REMOTE_USER_TERM_CONN);
+		}
+	}
+	bt_conn_unref(&conn);
+}
+
+void bt_link_emul_subscribe(const struct bt_gatt_attr *ccc, uint16_t value)
+{
+	struct _bt_gatt_ccc *cfg = ccc->user_data;
+
+	if (cfg->cfg_changed != NULL) {
+		cfg->cfg_changed(ccc, value);
+	}
+}
+
+void bt_link_emul_set_buffers(uint8_t buffers)
+{
+	k_mutex_lock(&linkMutex, K_FOREVER);
+	emulLink.cfg.buffers = MIN(buffers, BT_LINK_EMUL_MAX_BUFFERS);
+	k_mutex_unlock(&linkMutex);
+}
+
+uint32_t bt_link_emul_notifications(void)
+{
+	return emulLink.notifications;
+}
+
+int bt_link_emul_refs(void)
+{
+	return (int)atomic_get(&conn.refs);
+}
+
+/******************************************************************************/
+/* Local Function Definitions                                                 */
+/******************************************************************************/
+/* Send up to per_event notifications. The buffer is free before the sent
+ * callback runs, so the callback can queue the next notification.
+ */
+static void ConnectionEvent(struct k_work *work)
+{
+	Notification_t n;
+	uint8_t sent;
+
+	ARG_UNUSED(work);
+
+	for (sent = 0; sent < emulLink.cfg.per_event; sent++) {
+		k_mutex_lock(&linkMutex, K_FOREVER);
+		if (!emulLink.connected || emulLink.count == 0) {
+			k_mutex_unlock(&linkMutex);
+			break;
+		}
+		n = emulLink.queue[emulLink.head];
+		emulLink.head += 1;
+		emulLink.head %= BT_LINK_EMUL_MAX_BUFFERS;
+		emulLink.count -= 1;
+		emulLink.notifications += 1;
+		k_mutex_unlock(&linkMutex);
+
+		if (emulLink.rx != NULL) {
+			emulLink.rx(n.data, n.len);
+		}
+		if (n.func != NULL) {
+			n.func(&conn, n.user_data);
+		}
+	}
+
+	if (emulLink.connected) {
+		k_work_schedule(&eventWork,
+				K_MSEC(emulLink.cfg.interval_ms));
+	}
+}
@@ -0,0 +1,88 @@
+/**
+ * @file framework_stub.c
+ * @brief Captures framework messages for the host tests
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include <zephyr.h>
+#include <string.h>
+
+#include "Framework.h"
+#include "BufferPool.h"
+#include "harness.h"
+#include "harness_internal.h"
+
+/******************************************************************************/
+/* Local Constant, Macro and Type Definitions                                 */
+/******************************************************************************/
+#define HARNESS_MSG_QUEUE_DEPTH 16
+
+/******************************************************************************/
+/* Local Data Definitions                                                     */
+/******************************************************************************/
+K_MSGQ_DEFINE(harnessMsgQueue, sizeof(FwkMsg_t *), HARNESS_MSG_QUEUE_DEPTH,
+	      sizeof(FwkMsg_t *));
+
+static atomic_t bufferFailures;
+
+/******************************************************************************/
+/* Global Function Definitions                                                */
+/******************************************************************************/
+int Framework_Send(FwkId_t RxId, FwkMsg_t *pMsg)
+{
+	ARG_UNUSED(RxId);
+
+	return k_msgq_put(&harnessMsgQueue, &pMsg, K_NO_WAIT);
+}
+
+void *BufferPool_Take(size_t size)
+{
+	void *p;
+
+	if (atomic_get(&bufferFailures) > 0) {
+		atomic_dec(&bufferFailures);
+		return NULL;
+	}
+
+	p = k_malloc(size);
+	if (p != NULL) {
+		memset(p, 0, size);
+	}
+	return p;
+}
+
+void BufferPool_Free(void *pBuffer)
+{
+	k_free(pBuffer);
+}
+
+FwkMsg_t *harness_msg_get(k_timeout_t timeout)
+{
+	FwkMsg_t *pMsg = NULL;
+
+	if (k_msgq_get(&harnessMsgQueue, &pMsg, timeout) != 0) {
+		return NULL;
+	}
+	return pMsg;
+}
+
+void harness_buffer_fail(uint32_t count)
+{
+	atomic_set(&bufferFailures, count);
+}
+
+void harness_framework_reset(void)
+{
+	FwkMsg_t *pMsg;
+
+	atomic_clear(&bufferFailures);
+	while (k_msgq_get(&harnessMsgQueue, &pMsg, K_NO_WAIT) == 0) {
+		BufferPool_Free(pMsg);
+	}
+}
@@ -0,0 +1,27 @@
+/**
+ * @file harness.c
+ * @brief native_posix harness for the sensor path
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include <zephyr.h>
+
+#include "attr.h"
+#include "harness.h"
+#include "harness_internal.h"
+
+/******************************************************************************/
+/* Global Function Definitions                                                */
+/******************************************************************************/
+void harness_reset(void)
+{
+	attr_stub_reset();
+	harness_framework_reset();
+	harness_ble_reset();
+}
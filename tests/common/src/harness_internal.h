@@ -0,0 +1,23 @@
+/**
+ * @file harness_internal.h
+ * @brief Reset hooks shared by the harness stubs
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __HARNESS_INTERNAL_H__
+#define __HARNESS_INTERNAL_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void harness_framework_reset(void);
+void harness_ble_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HARNESS_INTERNAL_H__ */
@@ -0,0 +1,56 @@
+/**
+ * @file locking_stub.c
+ * @brief Locks for the host tests
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include <zephyr.h>
+
+#include "locking.h"
+
+/******************************************************************************/
+/* Local Data Definitions                                                     */
+/******************************************************************************/
+static struct k_mutex locks[LOCKING_ID_COUNT];
+
+/******************************************************************************/
+/* Global Function Definitions                                                */
+/******************************************************************************/
+int locking_take(enum locking_id id, k_timeout_t timeout)
+{
+	if (id >= LOCKING_ID_COUNT) {
+		return -EINVAL;
+	}
+	return k_mutex_lock(&locks[id], timeout);
+}
+
+int locking_give(enum locking_id id)
+{
+	if (id >= LOCKING_ID_COUNT) {
+		return -EINVAL;
+	}
+	return k_mutex_unlock(&locks[id]);
+}
+
+/******************************************************************************/
+/* Local Function Definitions                                                 */
+/******************************************************************************/
+static int locking_stub_init(const struct device *dev)
+{
+	size_t i;
+
+	ARG_UNUSED(dev);
+
+	for (i = 0; i < LOCKING_ID_COUNT; i++) {
+		k_mutex_init(&locks[i]);
+	}
+	return 0;
+}
+
+SYS_INIT(locking_stub_init, PRE_KERNEL_1, CONFIG_KERNEL_INIT_PRIORITY_OBJECTS);
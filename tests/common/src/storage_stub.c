@@ -0,0 +1,47 @@
+/**
+ * @file storage_stub.c
+ * @brief Parameter files and file system utilities for the host tests
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include <zephyr.h>
+#include <errno.h>
+
+#include "lcz_param_file.h"
+#include "file_system_utilities.h"
+
+/******************************************************************************/
+/* Global Function Definitions                                                */
+/******************************************************************************/
+ssize_t lcz_param_file_read(const char *name, void *data, size_t size)
+{
+	ARG_UNUSED(name);
+	ARG_UNUSED(data);
+	ARG_UNUSED(size);
+
+	return -ENOENT;
+}
+
+ssize_t lcz_param_file_write(const char *name, void *data, size_t size)
+{
+	ARG_UNUSED(name);
+	ARG_UNUSED(data);
+
+	return size;
+}
+
+ssize_t fsu_append(const char *path, const char *name, void *data,
+		   size_t size)
+{
+	ARG_UNUSED(path);
+	ARG_UNUSED(name);
+	ARG_UNUSED(data);
+
+	return size;
+}
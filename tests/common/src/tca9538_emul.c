@@ -0,0 +1,146 @@
+/**
+ * @file tca9538_emul.c
+ * @brief Emulated TCA9538 I/O expander for the host tests
+ *
+ * The first byte of a write selects the register, any following bytes are
+ * written to it. A read returns the selected register. The register pointer
+ * doesn't auto-increment, as on the real part.
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define DT_DRV_COMPAT bt6xx_tca9538_emul
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include <zephyr.h>
+#include <device.h>
+#include <drivers/i2c.h>
+#include <drivers/i2c_emul.h>
+#include <drivers/emul.h>
+
+#include "tca9538_emul.h"
+
+/******************************************************************************/
+/* Local Constant, Macro and Type Definitions                                 */
+/******************************************************************************/
+/* The state after a power on reset */
+#define POR_OUTPUT 0xFF
+#define POR_CONFIG 0xFF
+
+struct tca9538_emul_data {
+	uint8_t reg[TCA9538_EMUL_NUMBER_OF_REGS];
+	uint8_t pointer;
+	uint32_t transactions;
+	bool fail;
+};
+
+/******************************************************************************/
+/* Global Function Definitions                                                */
+/******************************************************************************/
+uint8_t tca9538_emul_reg(const struct emul *target, uint8_t reg)
+{
+	struct tca9538_emul_data *data = target->data;
+
+	return (reg < TCA9538_EMUL_NUMBER_OF_REGS) ? data->reg[reg] : 0;
+}
+
+uint32_t tca9538_emul_transactions(const struct emul *target)
+{
+	struct tca9538_emul_data *data = target->data;
+
+	return data->transactions;
+}
+
+void tca9538_emul_reset_count(const struct emul *target)
+{
+	struct tca9538_emul_data *data = target->data;
+
+	data->transactions = 0;
+}
+
+void tca9538_emul_set_fail(const struct emul *target, bool fail)
+{
+	struct tca9538_emul_data *data = target->data;
+
+	data->fail = fail;
+}
+
+/******************************************************************************/
+/* Local Function Definitions                                                 */
+/******************************************************************************/
+static int tca9538_emul_transfer(const struct emul *target,
+				 struct i2c_msg *msgs, int num_msgs, int addr)
+{
+	struct tca9538_emul_data *data = target->data;
+	uint32_t i;
+	int m;
+
+	ARG_UNUSED(addr);
+
+	data->transactions += 1;
+	if (data->fail) {
+		return -EIO;
+	}
+
+	for (m = 0; m < num_msgs; m++) {
+		if ((msgs[m].flags & I2C_MSG_READ) == I2C_MSG_READ) {
+			for (i = 0; i < msgs[m].len; i++) {
+				msgs[m].buf[i] = data->reg[data->pointer];
+			}
+			continue;
+		}
+		if (msgs[m].len == 0) {
+			continue;
+		}
+		if (msgs[m].buf[0] >= TCA9538_EMUL_NUMBER_OF_REGS) {
+			return -EIO;
+		}
+		data->pointer = msgs[m].buf[0];
+		for (i = 1; i < msgs[m].len; i++) {
+			/* The input register is read only */
+			if (data->pointer != TCA9538_EMUL_REG_INPUT) {
+				data->reg[data->pointer] = msgs[m].buf[i];
+			}
+		}
+	}
+	return 0;
+}
+
+static const struct i2c_emul_api tca9538_emul_api = {
+	.transfer = tca9538_emul_transfer,
+};
+
+static int tca9538_emul_init(const struct emul *target,
+			     const struct device *parent)
+{
+	struct tca9538_emul_data *data = target->data;
+
+	ARG_UNUSED(parent);
+
+	memset(data, 0, sizeof(*data));
+	data->reg[TCA9538_EMUL_REG_OUTPUT] = POR_OUTPUT;
+	data->reg[TCA9538_EMUL_REG_CONFIG] = POR_CONFIG;
+	return 0;
+}
+
+/* The emulator is reached through the bus, the device only exists so that
+ * the node has one.
+ */
+static int tca9538_emul_dev_init(const struct device *dev)
+{
+	ARG_UNUSED(dev);
+	return 0;
+}
+
+#define TCA9538_EMUL(n)                                                        \
+	static struct tca9538_emul_data tca9538_emul_data_##n;                 \
+	EMUL_DT_INST_DEFINE(n, tca9538_emul_init, &tca9538_emul_data_##n,      \
+			    NULL, &tca9538_emul_api);                          \
+	DEVICE_DT_INST_DEFINE(n, tca9538_emul_dev_init, NULL, NULL, NULL,      \
+			      POST_KERNEL, CONFIG_I2C_INIT_PRIORITY, NULL);
+
+DT_INST_FOREACH_STATUS_OKAY(TCA9538_EMUL)
@@ -0,0 +1,351 @@
+/**
+ * @file main.c
+ * @brief Tests for the packed event advertising record, with randomised round
+ * trips through a decoder written from the record layout
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include <ztest.h>
+#include <sys/byteorder.h>
+
+#include "lcz_sensor_adv_format.h"
+#include "EventPack.h"
+
+/******************************************************************************/
+/* Local Constant, Macro and Type Definitions                                 */
+/******************************************************************************/
+#define EVENT(n) (EVENT_PACK_HEADER_SIZE + ((n) * EVENT_PACK_EVENT_SIZE))
+
+#define ROUND_TRIPS 2000
+#define RANDOM_SEED 0x2545f491
+/* Past the largest record, to catch writes beyond the given size */
+#define CANARY 0xa5
+#define CANARY_SIZE 16
+
+/* An event as a gateway reads it back */
+typedef struct Decoded {
+	uint8_t type;
+	uint32_t epoch;
+	uint16_t delta;
+	uint16_t id;
+	uint32_t data;
+} Decoded_t;
+
+/******************************************************************************/
+/* Local Data Definitions                                                     */
+/******************************************************************************/
+static uint8_t buf[EVENT_PACK_SIZE(4)];
+
+static uint32_t randomState = RANDOM_SEED;
+static SensorMsg_t events[UINT8_MAX + 1];
+static Decoded_t decoded[UINT8_MAX];
+static uint8_t record[EVENT_PACK_SIZE(UINT8_MAX + 1) + CANARY_SIZE];
+
+/******************************************************************************/
+/* Local Function Definitions                                                 */
+/******************************************************************************/
+/* xorshift32, so that a failing round trip can be repeated */
+static uint32_t Random(void)
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return randomState;
+}
+
+static uint32_t RandomBelow(uint32_t n)
+{
+	return Random() % n;
+}
+
+/* Events are a few seconds apart, or far enough apart to saturate the delta,
+ * and may share a timestamp. They aren't in time order.
+ */
+static void RandomEvents(size_t count)
+{
+	uint32_t base = Random();
+	uint32_t spread;
+	size_t i;
+
+	switch (RandomBelow(3)) {
+	case 0:
+		spread = 1;
+		break;
+	case 1:
+		spread = UINT16_MAX;
+		break;
+	default:
+		spread = 4 * UINT16_MAX;
+		break;
+	}
+
+	for (i = 0; i < count; i++) {
+		events[i].event.type =
+			(SensorEventType_t)RandomBelow(UINT8_MAX + 1);
+		events[i].event.timestamp = base + RandomBelow(spread);
+		events[i].event.data.u32 = Random();
+		events[i].id = Random();
+	}
+}
+
+/* Decode a record the way a gateway does
+ *
+ * @retval number of events, or -EBADMSG if the header or length is wrong
+ */
+static int Decode(const uint8_t *p, size_t len, uint32_t *epoch,
+		  Decoded_t *out)
+{
+	size_t count;
+	size_t i;
+
+	if (len < EVENT_PACK_HEADER_SIZE ||
+	    sys_get_le16(&p[0]) !=
+		    LAIRD_CONNECTIVITY_MANUFACTURER_SPECIFIC_COMPANY_ID1 ||
+	    sys_get_le16(&p[2]) != EVENT_PACK_PROTOCOL_ID ||
+	    p[4] != EVENT_PACK_VERSION) {
+		return -EBADMSG;
+	}
+	count = p[5];
+	if (len != EVENT_PACK_SIZE(count)) {
+		return -EBADMSG;
+	}
+	*epoch = sys_get_le32(&p[6]);
+
+	for (i = 0; i < count; i++) {
+		out[i].type = p[EVENT(i)];
+		out[i].delta = sys_get_le16(&p[EVENT(i) + 1]);
+		out[i].epoch = *epoch - out[i].delta;
+		out[i].id = sys_get_le16(&p[EVENT(i) + 3]);
+		out[i].data = sys_get_le32(&p[EVENT(i) + 5]);
+	}
+	return (int)count;
+}
+
+static void CheckRoundTrip(size_t count, int len)
+{
+	uint32_t newest = 0;
+	uint32_t epoch;
+	uint32_t age;
+	size_t i;
+	size_t j;
+
+	zassert_equal(len, EVENT_PACK_SIZE(count), "wrong length");
+	zassert_equal(Decode(record, len, &epoch, decoded), count,
+		      "record doesn't decode");
+
+	for (i = 0; i < count; i++) {
+		newest = MAX(newest, events[i].event.timestamp);
+	}
+	zassert_equal(epoch, newest, "epoch isn't the newest event");
+
+	for (i = 0; i < count; i++) {
+		age = newest - events[i].event.timestamp;
+		zassert_equal(decoded[i].type, events[i].event.type,
+			      "event %zu type", i);
+		zassert_equal(decoded[i].id, (uint16_t)events[i].id,
+			      "event %zu id", i);
+		zassert_equal(decoded[i].data, events[i].event.data.u32,
+			      "event %zu data", i);
+		/* Exact until the delta saturates, then at least that old */
+		if (age < UINT16_MAX) {
+			zassert_equal(decoded[i].epoch,
+				      events[i].event.timestamp,
+				      "event %zu epoch", i);
+		} else {
+			zassert_equal(decoded[i].delta, UINT16_MAX,
+				      "event %zu delta didn't saturate", i);
+		}
+	}
+
+	/* An older event never has a smaller delta */
+	for (i = 0; i < count; i++) {
+		for (j = 0; j < count; j++) {
+			if (events[i].event.timestamp <
+			    events[j].event.timestamp) {
+				zassert_true(decoded[i].delta >=
+						     decoded[j].delta,
+					     "events %zu and %zu out of order",
+					     i, j);
+			}
+		}
+	}
+}
+
+static bool CanaryIntact(size_t from)
+{
+	size_t i;
+
+	for (i = from; i < sizeof(record); i++) {
+		if (record[i] != CANARY) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/******************************************************************************/
+/* Tests                                                                      */
+/******************************************************************************/
+static void test_header_only(void)
+{
+	zassert_equal(EventPack_Encode(buf, sizeof(buf), NULL, 0),
+		      EVENT_PACK_HEADER_SIZE, "wrong length");
+	zassert_equal(sys_get_le16(&buf[0]),
+		      LAIRD_CONNECTIVITY_MANUFACTURER_SPECIFIC_COMPANY_ID1,
+		      "wrong company id");
+	zassert_equal(sys_get_le16(&buf[2]), EVENT_PACK_PROTOCOL_ID,
+		      "wrong protocol id");
+	zassert_equal(buf[4], EVENT_PACK_VERSION, "wrong version");
+	zassert_equal(buf[5], 0, "wrong count");
+	zassert_equal(sys_get_le32(&buf[6]), 0, "wrong epoch");
+}
+
+static void test_events(void)
+{
+	const SensorMsg_t events[3] = {
+		{ .event = { .type = SENSOR_EVENT_TEMPERATURE_1,
+			     .data = { .u32 = 0x11223344 },
+			     .timestamp = 1000 },
+		  .id = 0x10001 },
+		{ .event = { .type = SENSOR_EVENT_MAGNET,
+			     .data = { .u32 = 1 },
+			     .timestamp = 1030 },
+		  .id = 0x10002 },
+		{ .event = { .type = SENSOR_EVENT_TAMPER,
+			     .data = { .u32 = 0 },
+			     .timestamp = 1010 },
+		  .id = 0x10003 },
+	};
+
+	zassert_equal(EventPack_Encode(buf, sizeof(buf), events, 3),
+		      EVENT_PACK_SIZE(3), "wrong length");
+	zassert_equal(buf[5], 3, "wrong count");
+	zassert_equal(sys_get_le32(&buf[6]), 1030,
+		      "epoch isn't the newest event");
+
+	zassert_equal(buf[EVENT(0)], SENSOR_EVENT_TEMPERATURE_1,
+		      "wrong type");
+	zassert_equal(sys_get_le16(&buf[EVENT(0) + 1]), 30, "wrong delta");
+	zassert_equal(sys_get_le16(&buf[EVENT(0) + 3]), 0x0001,
+		      "id not truncated");
+	zassert_equal(sys_get_le32(&buf[EVENT(0) + 5]), 0x11223344,
+		      "wrong data");
+
+	zassert_equal(buf[EVENT(1)], SENSOR_EVENT_MAGNET, "wrong type");
+	zassert_equal(sys_get_le16(&buf[EVENT(1) + 1]), 0, "wrong delta");
+	zassert_equal(buf[EVENT(2)], SENSOR_EVENT_TAMPER, "wrong type");
+	zassert_equal(sys_get_le16(&buf[EVENT(2) + 1]), 20, "wrong delta");
+}
+
+static void test_delta_saturates(void)
+{
+	const SensorMsg_t events[2] = {
+		{ .event = { .timestamp = 0 } },
+		{ .event = { .timestamp = 100000 } },
+	};
+
+	zassert_equal(EventPack_Encode(buf, sizeof(buf), events, 2),
+		      EVENT_PACK_SIZE(2), "wrong length");
+	zassert_equal(sys_get_le16(&buf[EVENT(0) + 1]), UINT16_MAX,
+		      "delta didn't saturate");
+}
+
+static void test_too_small(void)
+{
+	const SensorMsg_t events[2] = { 0 };
+
+	zassert_equal(EventPack_Encode(buf, EVENT_PACK_SIZE(2) - 1, events, 2),
+		      -ENOMEM, "overflowed the buffer");
+	zassert_equal(EventPack_Encode(buf, sizeof(buf), events,
+				       UINT8_MAX + 1),
+		      -EINVAL, "count doesn't fit the header");
+}
+
+static void test_random_round_trips(void)
+{
+	uint32_t rejected = 0;
+	uint32_t saturated = 0;
+	size_t count;
+	size_t size;
+	size_t i;
+	size_t j;
+	int len;
+
+	for (i = 0; i < ROUND_TRIPS; i++) {
+		/* Mostly small records, sometimes the full count and one
+		 * past it.
+		 */
+		count = (RandomBelow(8) == 0) ? UINT8_MAX + RandomBelow(2) :
+						RandomBelow(32);
+		RandomEvents(count);
+
+		/* Sometimes a buffer a little too small */
+		size = EVENT_PACK_SIZE(MIN(count, UINT8_MAX));
+		if (RandomBelow(4) == 0) {
+			size -= RandomBelow(EVENT_PACK_EVENT_SIZE) + 1;
+		}
+		memset(record, CANARY, sizeof(record));
+
+		len = EventPack_Encode(record, size, events, count);
+		if (count > UINT8_MAX) {
+			zassert_equal(len, -EINVAL, "count %zu accepted",
+				      count);
+			zassert_true(CanaryIntact(0),
+				     "rejected record written");
+			rejected += 1;
+			continue;
+		}
+		if (size < EVENT_PACK_SIZE(count)) {
+			zassert_equal(len, -ENOMEM, "%zu bytes accepted", size);
+			zassert_true(CanaryIntact(0),
+				     "rejected record written");
+			rejected += 1;
+			continue;
+		}
+		zassert_true(CanaryIntact(size), "wrote past the record");
+		CheckRoundTrip(count, len);
+		for (j = 0; j < count; j++) {
+			saturated += (decoded[j].delta == UINT16_MAX) ? 1 : 0;
+		}
+	}
+
+	TC_PRINT("%u round trips, %u rejected, %u saturated deltas\n",
+		 ROUND_TRIPS, rejected, saturated);
+	/* The generator has to reach the limits it is meant to test */
+	zassert_true(rejected > 0, "no size or count limit reached");
+	zassert_true(saturated > 0, "no delta saturated");
+}
+
+static void test_decoder_rejects_bad_records(void)
+{
+	uint32_t epoch;
+	int len;
+
+	RandomEvents(3);
+	len = EventPack_Encode(record, sizeof(record), events, 3);
+	zassert_equal(Decode(record, len, &epoch, decoded), 3,
+		      "record doesn't decode");
+	zassert_equal(Decode(record, len - 1, &epoch, decoded), -EBADMSG,
+		      "short record decoded");
+	record[4] += 1;
+	zassert_equal(Decode(record, len, &epoch, decoded), -EBADMSG,
+		      "unknown version decoded");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(event_pack,
+			 ztest_unit_test(test_header_only),
+			 ztest_unit_test(test_events),
+			 ztest_unit_test(test_delta_saturates),
+			 ztest_unit_test(test_too_small),
+			 ztest_unit_test(test_random_round_trips),
+			 ztest_unit_test(test_decoder_rejects_bad_records));
+	ztest_run_test_suite(event_pack);
+}
@@ -0,0 +1,314 @@
+/**
+ * @file main.c
+ * @brief Throughput and latency of the event stream on an emulated link
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include <ztest.h>
+#include <bluetooth/gatt.h>
+#include <sys/byteorder.h>
+
+#include "attr.h"
+#include "EventStream.h"
+#include "bt_link_emul.h"
+
+/******************************************************************************/
+/* Local Constant, Macro and Type Definitions                                 */
+/******************************************************************************/
+/* The CCC descriptor follows the service, the declaration and the value */
+#define EVENT_STREAM_CCC_ATTR 3
+
+/* Data length extension with a 7.5 ms interval rounded up, and a phone that
+ * takes four packets per connection event.
+ */
+#define LINK_MTU 247
+#define LINK_INTERVAL_MS 10
+#define LINK_PER_EVENT 4
+#define LINK_BUFFERS 8
+#define SMALL_MTU 23
+#define RECORDS_PER_PACKET ((LINK_MTU - 3) / EVENT_STREAM_RECORD_SIZE)
+
+#define BURST_EVENTS 1000
+#define POST_RETRY_MS 1
+#define WAIT_MS 5000
+/* Allowance for the host scheduler on top of the link timing */
+#define SLACK_MS 20
+
+typedef struct Rx {
+	atomic_t records;
+	atomic_t packets;
+	atomic_t outOfOrder;
+	uint32_t nextId;
+	uint32_t maxRecords;
+	uint32_t lastLatency;
+	uint32_t maxLatency;
+	uint64_t totalLatency;
+} Rx_t;
+
+/******************************************************************************/
+/* Local Data Definitions                                                     */
+/******************************************************************************/
+extern const struct bt_gatt_service_static event_stream_svc;
+
+static const bt_link_emul_config_t fastLink = { LINK_MTU, LINK_INTERVAL_MS,
+						LINK_PER_EVENT, LINK_BUFFERS };
+
+static Rx_t rx;
+static uint32_t postedMs[BURST_EVENTS];
+static uint32_t nextId;
+/* Posts refused because the queue was full, which count as dropped */
+static uint32_t queueFull;
+
+/******************************************************************************/
+/* Local Function Definitions                                                 */
+/******************************************************************************/
+/* Decode the records of a notification as the client would */
+static void Received(const uint8_t *data, uint16_t len)
+{
+	uint32_t now = k_uptime_get_32();
+	uint32_t records = len / EVENT_STREAM_RECORD_SIZE;
+	uint32_t latency;
+	uint32_t id;
+	size_t i;
+
+	if ((len % EVENT_STREAM_RECORD_SIZE) != 0 || records == 0) {
+		atomic_inc(&rx.outOfOrder);
+		return;
+	}
+
+	for (i = 0; i < len; i += EVENT_STREAM_RECORD_SIZE) {
+		id = sys_get_le32(&data[i + 1]);
+		if (id != rx.nextId || id >= BURST_EVENTS ||
+		    sys_get_le32(&data[i + 9]) != id * 3) {
+			atomic_inc(&rx.outOfOrder);
+			continue;
+		}
+		rx.nextId += 1;
+		latency = now - postedMs[id];
+		rx.lastLatency = latency;
+		rx.maxLatency = MAX(rx.maxLatency, latency);
+		rx.totalLatency += latency;
+	}
+	rx.maxRecords = MAX(rx.maxRecords, records);
+	atomic_add(&rx.records, records);
+	atomic_inc(&rx.packets);
+}
+
+static void Connect(const bt_link_emul_config_t *cfg)
+{
+	memset(&rx, 0, sizeof(rx));
+	nextId = 0;
+	queueFull = 0;
+
+	bt_link_emul_connect(cfg, Received);
+	bt_link_emul_subscribe(&event_stream_svc.attrs[EVENT_STREAM_CCC_ATTR],
+			       BT_GATT_CCC_NOTIFY);
+}
+
+/* Post the next event, trying again while the queue is full */
+static int Post(void)
+{
+	SensorMsg_t msg = { 0 };
+	int r;
+
+	msg.id = nextId;
+	msg.event.type = SENSOR_EVENT_TEMPERATURE_1;
+	msg.event.timestamp = nextId;
+	msg.event.data.u32 = nextId * 3;
+
+	postedMs[nextId] = k_uptime_get_32();
+	while ((r = EventStream_Post(&msg)) == -ENOMEM) {
+		queueFull += 1;
+		k_msleep(POST_RETRY_MS);
+		postedMs[nextId] = k_uptime_get_32();
+	}
+	if (r == 0) {
+		nextId += 1;
+	}
+	return r;
+}
+
+static void WaitForRecords(uint32_t count)
+{
+	int64_t end = k_uptime_get() + WAIT_MS;
+
+	while ((uint32_t)atomic_get(&rx.records) < count &&
+	       k_uptime_get() < end) {
+		k_msleep(1);
+	}
+}
+
+/* Wait for the sent callback and the statistics update that follows it */
+static void WaitForStats(void)
+{
+	k_msleep(LINK_INTERVAL_MS);
+}
+
+/* Let the send work see the disconnect and give up its references */
+static void Disconnect(void)
+{
+	bt_link_emul_disconnect();
+	k_msleep(CONFIG_EVENT_STREAM_BATCH_MS);
+}
+
+/******************************************************************************/
+/* Tests                                                                      */
+/******************************************************************************/
+static void test_not_subscribed(void)
+{
+	bt_link_emul_connect(&fastLink, Received);
+	zassert_equal(Post(), -EPERM, "posted without a subscriber");
+	Disconnect();
+}
+
+static void test_burst_throughput(void)
+{
+	uint32_t dropped = attr_get_uint32(ATTR_ID_event_stream_dropped, 0);
+	uint32_t notifications;
+	uint32_t recordsPerSecond;
+	uint32_t elapsed;
+	uint32_t average;
+	int64_t start;
+	uint32_t i;
+
+	Connect(&fastLink);
+	start = k_uptime_get();
+	for (i = 0; i < BURST_EVENTS; i++) {
+		zassert_equal(Post(), 0, "post %u failed", i);
+	}
+	WaitForRecords(BURST_EVENTS);
+	WaitForStats();
+	elapsed = (uint32_t)MAX(k_uptime_get() - start, 1);
+	notifications = bt_link_emul_notifications();
+	recordsPerSecond = (BURST_EVENTS * MSEC_PER_SEC) / elapsed;
+	average = (uint32_t)(rx.totalLatency / BURST_EVENTS);
+
+	TC_PRINT("%u events in %u ms over %u notifications: %u events/s, "
+		 "%u notifications/s, %u events per notification\n",
+		 BURST_EVENTS, elapsed, notifications, recordsPerSecond,
+		 (notifications * MSEC_PER_SEC) / elapsed,
+		 BURST_EVENTS / MAX(notifications, 1));
+	TC_PRINT("latency: average %u ms, max %u ms, queue full %u times\n",
+		 average, rx.maxLatency, queueFull);
+
+	zassert_equal(atomic_get(&rx.records), BURST_EVENTS, "events lost");
+	zassert_equal(atomic_get(&rx.outOfOrder), 0, "events out of order");
+	/* Only the posts refused by a full queue are dropped */
+	zassert_equal(attr_get_uint32(ATTR_ID_event_stream_dropped, 0),
+		      dropped + queueFull, "events dropped");
+	zassert_equal(rx.maxRecords, RECORDS_PER_PACKET,
+		      "packets don't fill the MTU");
+	/* The queue stays full, so nearly every packet is full */
+	zassert_true(notifications <= (BURST_EVENTS / RECORDS_PER_PACKET) + 4,
+		     "%u notifications", notifications);
+	/* The link limit is two packets in flight per connection event */
+	zassert_true(recordsPerSecond * 2 >=
+			     (CONFIG_EVENT_STREAM_MAX_IN_FLIGHT *
+			      RECORDS_PER_PACKET * MSEC_PER_SEC) /
+				     LINK_INTERVAL_MS,
+		     "%u events/s", recordsPerSecond);
+	Disconnect();
+}
+
+static void test_single_event_latency(void)
+{
+	uint32_t sent = attr_get_uint32(ATTR_ID_event_stream_notifications, 0);
+	uint32_t latency;
+
+	Connect(&fastLink);
+	zassert_equal(Post(), 0, "post failed");
+	WaitForRecords(1);
+	WaitForStats();
+	latency = attr_get_uint32(ATTR_ID_event_stream_latency, 0);
+
+	TC_PRINT("single event latency %u ms\n", rx.lastLatency);
+	zassert_equal(atomic_get(&rx.records), 1, "event lost");
+	zassert_equal(rx.maxRecords, 1, "packet not sent alone");
+	/* A partial packet waits for the batch time, then the next event */
+	zassert_true(rx.lastLatency + 1 >= CONFIG_EVENT_STREAM_BATCH_MS,
+		     "latency %u ms", rx.lastLatency);
+	zassert_true(rx.lastLatency <= CONFIG_EVENT_STREAM_BATCH_MS +
+					       LINK_INTERVAL_MS + SLACK_MS,
+		     "latency %u ms", rx.lastLatency);
+	/* The reported latency ends when the sent callback runs */
+	zassert_true(latency >= rx.lastLatency &&
+			     latency <= rx.lastLatency + LINK_INTERVAL_MS,
+		     "reported latency %u ms", latency);
+	zassert_equal(attr_get_uint32(ATTR_ID_event_stream_notifications, 0),
+		      sent + 1, "notification not counted");
+	Disconnect();
+}
+
+static void test_small_mtu(void)
+{
+	const bt_link_emul_config_t small = { SMALL_MTU, LINK_INTERVAL_MS,
+					      LINK_PER_EVENT, LINK_BUFFERS };
+	uint32_t i;
+
+	Connect(&small);
+	for (i = 0; i < 10; i++) {
+		zassert_equal(Post(), 0, "post %u failed", i);
+	}
+	WaitForRecords(10);
+
+	zassert_equal(atomic_get(&rx.records), 10, "events lost");
+	zassert_equal(atomic_get(&rx.outOfOrder), 0, "events out of order");
+	zassert_equal(rx.maxRecords, 1, "packet larger than the MTU");
+	zassert_equal(atomic_get(&rx.packets), 10, "one event per packet");
+	Disconnect();
+}
+
+static void test_no_buffers_retries(void)
+{
+	uint32_t dropped = attr_get_uint32(ATTR_ID_event_stream_dropped, 0);
+
+	Connect(&fastLink);
+	bt_link_emul_set_buffers(0);
+	zassert_equal(Post(), 0, "post failed");
+	zassert_equal(Post(), 0, "post failed");
+	k_msleep(3 * CONFIG_EVENT_STREAM_BATCH_MS);
+	zassert_equal(atomic_get(&rx.records), 0, "sent without a buffer");
+
+	/* The packet is kept and sent once a buffer is free */
+	bt_link_emul_set_buffers(LINK_BUFFERS);
+	WaitForRecords(2);
+	zassert_equal(atomic_get(&rx.records), 2, "events lost");
+	zassert_equal(atomic_get(&rx.outOfOrder), 0, "events out of order");
+	WaitForStats();
+	zassert_equal(attr_get_uint32(ATTR_ID_event_stream_dropped, 0),
+		      dropped, "events dropped");
+	Disconnect();
+}
+
+static void test_disconnect_releases_link(void)
+{
+	uint32_t i;
+
+	Connect(&fastLink);
+	zassert_equal(bt_link_emul_refs(), 2, "stream didn't take a reference");
+	for (i = 0; i < 2 * RECORDS_PER_PACKET; i++) {
+		zassert_equal(Post(), 0, "post %u failed", i);
+	}
+	Disconnect();
+
+	zassert_equal(bt_link_emul_refs(), 0, "reference leaked");
+	zassert_equal(Post(), -EPERM, "posted after the disconnect");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(event_stream,
+			 ztest_unit_test(test_not_subscribed),
+			 ztest_unit_test(test_burst_throughput),
+			 ztest_unit_test(test_single_event_latency),
+			 ztest_unit_test(test_small_mtu),
+			 ztest_unit_test(test_no_buffers_retries),
+			 ztest_unit_test(test_disconnect_releases_link));
+	ztest_run_test_suite(event_stream);
+}
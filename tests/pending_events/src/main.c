@@ -0,0 +1,122 @@
+/**
+ * @file main.c
+ * @brief Tests for the pending advertisement event store
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include <ztest.h>
+
+#include "PendingEvents.h"
+
+/******************************************************************************/
+/* Local Constant, Macro and Type Definitions                                 */
+/******************************************************************************/
+#define ALARMS (BIT(4) | BIT(5))
+
+/******************************************************************************/
+/* Local Data Definitions                                                     */
+/******************************************************************************/
+static PendingEvents_t store;
+
+/******************************************************************************/
+/* Local Function Definitions                                                 */
+/******************************************************************************/
+static void Put(uint32_t slot, uint32_t id)
+{
+	SensorMsg_t msg = { .event = { .type = SENSOR_EVENT_TEMPERATURE_1 },
+			    .id = id };
+
+	(void)PendingEvents_Put(&store, &msg, BIT(slot));
+}
+
+static uint32_t Take(void)
+{
+	SensorMsg_t msg;
+
+	zassert_equal(PendingEvents_Take(&store, ALARMS, &msg), 0,
+		      "store is empty");
+	return msg.id;
+}
+
+static void Setup(void)
+{
+	memset(&store, 0, sizeof(store));
+}
+
+/******************************************************************************/
+/* Tests                                                                      */
+/******************************************************************************/
+static void test_replace(void)
+{
+	SensorMsg_t msg = { .id = 1 };
+
+	zassert_false(PendingEvents_Put(&store, &msg, BIT(3)),
+		      "slot was empty");
+	msg.id = 2;
+	zassert_true(PendingEvents_Put(&store, &msg, BIT(3)),
+		     "slot should be replaced");
+	zassert_equal(Take(), 2, "newest event not kept");
+	zassert_equal(PendingEvents_Take(&store, ALARMS, &msg), -ENOENT,
+		      "only one event per type");
+}
+
+static void test_alarms_first(void)
+{
+	Put(0, 100);
+	Put(1, 101);
+	Put(5, 105);
+	Put(4, 104);
+
+	zassert_equal(Take(), 104, "alarm not taken first");
+	zassert_equal(Take(), 105, "alarm not taken first");
+	zassert_equal(Take(), 100, "telemetry out of order");
+	zassert_equal(Take(), 101, "telemetry out of order");
+}
+
+static void test_round_robin(void)
+{
+	Put(0, 100);
+	Put(1, 101);
+	zassert_equal(Take(), 100, "wrong first slot");
+
+	/* A fast changing reading in slot 0 can't starve slot 1 */
+	Put(0, 200);
+	zassert_equal(Take(), 101, "slot 1 was starved");
+	zassert_equal(Take(), 200, "cursor didn't wrap");
+
+	Put(31, 131);
+	Put(2, 102);
+	zassert_equal(Take(), 102, "cursor should be after slot 0");
+	zassert_equal(Take(), 131, "last slot not taken");
+}
+
+static void test_purge(void)
+{
+	SensorMsg_t msg;
+
+	Put(0, 100);
+	Put(4, 104);
+	PendingEvents_Purge(&store);
+	zassert_equal(PendingEvents_Take(&store, ALARMS, &msg), -ENOENT,
+		      "events not purged");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(pending_events,
+			 ztest_unit_test_setup_teardown(test_replace,
+							Setup, unit_test_noop),
+			 ztest_unit_test_setup_teardown(test_alarms_first,
+							Setup, unit_test_noop),
+			 ztest_unit_test_setup_teardown(test_round_robin,
+							Setup, unit_test_noop),
+			 ztest_unit_test_setup_teardown(test_purge,
+							Setup, unit_test_noop));
+	ztest_run_test_suite(pending_events);
+}
@@ -0,0 +1,366 @@
+/**
+ * @file main.c
+ * @brief Tests for the periodic advertising frame, with randomised round
+ * trips through a decoder written from the frame layout
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include <ztest.h>
+#include <sys/byteorder.h>
+
+#include "lcz_sensor_adv_format.h"
+#include "PeriodicFrame.h"
+
+/******************************************************************************/
+/* Local Constant, Macro and Type Definitions                                 */
+/******************************************************************************/
+#define SAMPLE(n)                                                              \
+	(PERIODIC_FRAME_HEADER_SIZE + ((n) * PERIODIC_FRAME_SAMPLE_SIZE))
+
+/* The longest age a frame can carry, in milliseconds */
+#define MAX_AGE_MS ((int64_t)UINT16_MAX * PERIODIC_FRAME_AGE_UNIT_MS)
+
+#define ROUND_TRIPS 2000
+#define RANDOM_SEED 0x6b8b4567
+/* Past the largest frame, to catch writes beyond the given size */
+#define CANARY 0xa5
+#define CANARY_SIZE 16
+
+/* A sample as a scanner reads it back */
+typedef struct Decoded {
+	uint8_t type;
+	uint16_t age;
+	/* Milliseconds since the epoch */
+	int64_t time;
+	uint32_t data;
+} Decoded_t;
+
+typedef struct Header {
+	uint8_t sequence;
+	uint32_t epoch;
+	uint16_t ms;
+} Header_t;
+
+/******************************************************************************/
+/* Local Data Definitions                                                     */
+/******************************************************************************/
+static uint8_t buf[PERIODIC_FRAME_SIZE(4)];
+
+static uint32_t randomState = RANDOM_SEED;
+static PeriodicSample_t samples[UINT8_MAX + 1];
+static Decoded_t decoded[UINT8_MAX];
+static uint8_t frame[PERIODIC_FRAME_SIZE(UINT8_MAX + 1) + CANARY_SIZE];
+
+/******************************************************************************/
+/* Local Function Definitions                                                 */
+/******************************************************************************/
+/* xorshift32, so that a failing round trip can be repeated */
+static uint32_t Random(void)
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return randomState;
+}
+
+static uint32_t RandomBelow(uint32_t n)
+{
+	return Random() % n;
+}
+
+static int64_t SampleMs(const PeriodicSample_t *sample)
+{
+	return ((int64_t)sample->epoch * MSEC_PER_SEC) + sample->ms;
+}
+
+static void SetSample(PeriodicSample_t *sample, int64_t ms)
+{
+	sample->epoch = (uint32_t)(ms / MSEC_PER_SEC);
+	sample->ms = (uint16_t)(ms % MSEC_PER_SEC);
+}
+
+/* Samples oldest first, some in the same millisecond, with gaps of up to a
+ * tenth of a second, a minute or long enough to saturate the age.
+ */
+static void RandomSamples(size_t count)
+{
+	int64_t ms = (int64_t)RandomBelow(INT32_MAX) * MSEC_PER_SEC;
+	uint32_t gap;
+	size_t i;
+
+	switch (RandomBelow(3)) {
+	case 0:
+		gap = PERIODIC_FRAME_AGE_UNIT_MS;
+		break;
+	case 1:
+		gap = MSEC_PER_SEC * SEC_PER_MIN;
+		break;
+	default:
+		gap = MAX_AGE_MS / 8;
+		break;
+	}
+
+	for (i = 0; i < count; i++) {
+		ms += RandomBelow(gap);
+		samples[i].type = (SensorEventType_t)RandomBelow(UINT8_MAX + 1);
+		samples[i].data.u32 = Random();
+		SetSample(&samples[i], ms);
+	}
+}
+
+/* Decode a frame the way a scanner does
+ *
+ * @retval number of samples, or -EBADMSG if the header or length is wrong
+ */
+static int Decode(const uint8_t *p, size_t len, Header_t *header,
+		  Decoded_t *out)
+{
+	int64_t newest;
+	size_t count;
+	size_t i;
+
+	if (len < PERIODIC_FRAME_HEADER_SIZE ||
+	    sys_get_le16(&p[0]) !=
+		    LAIRD_CONNECTIVITY_MANUFACTURER_SPECIFIC_COMPANY_ID1 ||
+	    sys_get_le16(&p[2]) != PERIODIC_FRAME_PROTOCOL_ID ||
+	    p[4] != PERIODIC_FRAME_VERSION) {
+		return -EBADMSG;
+	}
+	count = p[6];
+	if (count == 0 || len != PERIODIC_FRAME_SIZE(count)) {
+		return -EBADMSG;
+	}
+	header->sequence = p[5];
+	header->epoch = sys_get_le32(&p[7]);
+	header->ms = sys_get_le16(&p[11]);
+	newest = ((int64_t)header->epoch * MSEC_PER_SEC) + header->ms;
+
+	for (i = 0; i < count; i++) {
+		out[i].type = p[SAMPLE(i)];
+		out[i].age = sys_get_le16(&p[SAMPLE(i) + 1]);
+		out[i].time = newest -
+			      (out[i].age * PERIODIC_FRAME_AGE_UNIT_MS);
+		out[i].data = sys_get_le32(&p[SAMPLE(i) + 3]);
+	}
+	return (int)count;
+}
+
+static void CheckRoundTrip(size_t count, uint8_t sequence, int len)
+{
+	const PeriodicSample_t *newest = &samples[count - 1];
+	Header_t header;
+	int64_t age;
+	int64_t ms;
+	size_t i;
+
+	zassert_equal(len, PERIODIC_FRAME_SIZE(count), "wrong length");
+	zassert_equal(Decode(frame, len, &header, decoded), count,
+		      "frame doesn't decode");
+	zassert_equal(header.sequence, sequence, "wrong sequence");
+	zassert_equal(header.epoch, newest->epoch, "wrong epoch");
+	zassert_equal(header.ms, newest->ms, "wrong ms");
+
+	for (i = 0; i < count; i++) {
+		ms = SampleMs(&samples[i]);
+		age = SampleMs(newest) - ms;
+		zassert_equal(decoded[i].type, samples[i].type,
+			      "sample %zu type", i);
+		zassert_equal(decoded[i].data, samples[i].data.u32,
+			      "sample %zu data", i);
+		/* Ages are truncated to a tenth of a second until they
+		 * saturate.
+		 */
+		if (age < MAX_AGE_MS) {
+			zassert_true(decoded[i].time >= ms &&
+					     decoded[i].time - ms <
+						     PERIODIC_FRAME_AGE_UNIT_MS,
+				     "sample %zu time", i);
+		} else {
+			zassert_equal(decoded[i].age, UINT16_MAX,
+				      "sample %zu age didn't saturate", i);
+		}
+		/* Oldest first, so the age never grows */
+		if (i > 0) {
+			zassert_true(decoded[i].age <= decoded[i - 1].age,
+				     "samples %zu and %zu out of order", i - 1,
+				     i);
+		}
+	}
+	zassert_equal(decoded[count - 1].age, 0, "newest sample has an age");
+}
+
+static bool CanaryIntact(size_t from)
+{
+	size_t i;
+
+	for (i = from; i < sizeof(frame); i++) {
+		if (frame[i] != CANARY) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/******************************************************************************/
+/* Tests                                                                      */
+/******************************************************************************/
+static void test_header(void)
+{
+	const PeriodicSample_t window[2] = {
+		{ .type = SENSOR_EVENT_TEMPERATURE_1,
+		  .data = { .u32 = 0x11223344 },
+		  .epoch = 1000,
+		  .ms = 900 },
+		{ .type = SENSOR_EVENT_MAGNET,
+		  .data = { .u32 = 1 },
+		  .epoch = 1001,
+		  .ms = 250 },
+	};
+
+	zassert_equal(PeriodicFrame_Encode(buf, sizeof(buf), window, 2, 7),
+		      PERIODIC_FRAME_SIZE(2), "wrong length");
+	zassert_equal(sys_get_le16(&buf[0]),
+		      LAIRD_CONNECTIVITY_MANUFACTURER_SPECIFIC_COMPANY_ID1,
+		      "wrong company id");
+	zassert_equal(sys_get_le16(&buf[2]), PERIODIC_FRAME_PROTOCOL_ID,
+		      "wrong protocol id");
+	zassert_equal(buf[4], PERIODIC_FRAME_VERSION, "wrong version");
+	zassert_equal(buf[5], 7, "wrong sequence");
+	zassert_equal(buf[6], 2, "wrong count");
+	zassert_equal(sys_get_le32(&buf[7]), 1001,
+		      "epoch isn't the newest sample");
+	zassert_equal(sys_get_le16(&buf[11]), 250, "wrong ms");
+
+	/* 350 ms across the second boundary is 3 tenths */
+	zassert_equal(buf[SAMPLE(0)], SENSOR_EVENT_TEMPERATURE_1,
+		      "wrong type");
+	zassert_equal(sys_get_le16(&buf[SAMPLE(0) + 1]), 3, "wrong age");
+	zassert_equal(sys_get_le32(&buf[SAMPLE(0) + 3]), 0x11223344,
+		      "wrong data");
+	zassert_equal(buf[SAMPLE(1)], SENSOR_EVENT_MAGNET, "wrong type");
+	zassert_equal(sys_get_le16(&buf[SAMPLE(1) + 1]), 0, "wrong age");
+}
+
+static void test_age_limits(void)
+{
+	PeriodicSample_t window[3] = { 0 };
+
+	/* Older than the age can hold, and a sample stamped after the newest
+	 * one, as after a clock change.
+	 */
+	window[0].epoch = 0;
+	window[1].epoch = 100000;
+	window[2].epoch = 99999;
+
+	zassert_equal(PeriodicFrame_Encode(buf, sizeof(buf), window, 3, 0),
+		      PERIODIC_FRAME_SIZE(3), "wrong length");
+	zassert_equal(sys_get_le16(&buf[SAMPLE(0) + 1]), UINT16_MAX,
+		      "age didn't saturate");
+	zassert_equal(sys_get_le16(&buf[SAMPLE(1) + 1]), 0,
+		      "negative age not clamped");
+}
+
+static void test_size_limits(void)
+{
+	const PeriodicSample_t window[2] = { 0 };
+
+	zassert_equal(PeriodicFrame_Encode(buf, sizeof(buf), window, 0, 0),
+		      -EINVAL, "empty frame encoded");
+	zassert_equal(PeriodicFrame_Encode(buf, PERIODIC_FRAME_SIZE(2) - 1,
+					   window, 2, 0),
+		      -ENOMEM, "overflowed the buffer");
+	zassert_equal(PeriodicFrame_Encode(buf, sizeof(buf), window,
+					   UINT8_MAX + 1, 0),
+		      -EINVAL, "count doesn't fit the header");
+}
+
+static void test_random_round_trips(void)
+{
+	uint32_t rejected = 0;
+	uint32_t saturated = 0;
+	uint8_t sequence;
+	size_t count;
+	size_t size;
+	size_t i;
+	size_t j;
+	int len;
+
+	for (i = 0; i < ROUND_TRIPS; i++) {
+		/* Mostly a window's worth, sometimes the full count and one
+		 * past it.
+		 */
+		count = (RandomBelow(8) == 0) ? UINT8_MAX + RandomBelow(2) :
+						RandomBelow(32) + 1;
+		RandomSamples(count);
+		sequence = (uint8_t)Random();
+
+		/* Sometimes a buffer a little too small */
+		size = PERIODIC_FRAME_SIZE(MIN(count, UINT8_MAX));
+		if (RandomBelow(4) == 0) {
+			size -= RandomBelow(PERIODIC_FRAME_SAMPLE_SIZE) + 1;
+		}
+		memset(frame, CANARY, sizeof(frame));
+
+		len = PeriodicFrame_Encode(frame, size, samples, count,
+					   sequence);
+		if (count > UINT8_MAX) {
+			zassert_equal(len, -EINVAL, "count %zu accepted",
+				      count);
+			zassert_true(CanaryIntact(0),
+				     "rejected frame written");
+			rejected += 1;
+			continue;
+		}
+		if (size < PERIODIC_FRAME_SIZE(count)) {
+			zassert_equal(len, -ENOMEM, "%zu bytes accepted", size);
+			zassert_true(CanaryIntact(0),
+				     "rejected frame written");
+			rejected += 1;
+			continue;
+		}
+		zassert_true(CanaryIntact(size), "wrote past the frame");
+		CheckRoundTrip(count, sequence, len);
+		for (j = 0; j < count; j++) {
+			saturated += (decoded[j].age == UINT16_MAX) ? 1 : 0;
+		}
+	}
+
+	TC_PRINT("%u round trips, %u rejected, %u saturated ages\n",
+		 ROUND_TRIPS, rejected, saturated);
+	/* The generator has to reach the limits it is meant to test */
+	zassert_true(rejected > 0, "no size or count limit reached");
+	zassert_true(saturated > 0, "no age saturated");
+}
+
+static void test_decoder_rejects_bad_frames(void)
+{
+	Header_t header;
+	int len;
+
+	RandomSamples(3);
+	len = PeriodicFrame_Encode(frame, sizeof(frame), samples, 3, 0);
+	zassert_equal(Decode(frame, len, &header, decoded), 3,
+		      "frame doesn't decode");
+	zassert_equal(Decode(frame, len - 1, &header, decoded), -EBADMSG,
+		      "short frame decoded");
+	frame[4] += 1;
+	zassert_equal(Decode(frame, len, &header, decoded), -EBADMSG,
+		      "unknown version decoded");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(periodic_frame,
+			 ztest_unit_test(test_header),
+			 ztest_unit_test(test_age_limits),
+			 ztest_unit_test(test_size_limits),
+			 ztest_unit_test(test_random_round_trips),
+			 ztest_unit_test(test_decoder_rejects_bad_frames));
+	ztest_run_test_suite(periodic_frame);
+}
@@ -0,0 +1,115 @@
+/**
+ * @file main.c
+ * @brief Tests for the sample schedule deadline arithmetic
+ *
+ * Copyright (c) 2022 Laird Connectivity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include <ztest.h>
+
+#include "SampleSchedule.h"
+
+/******************************************************************************/
+/* Local Constant, Macro and Type Definitions                                 */
+/******************************************************************************/
+#define PERIOD 60000
+#define HOUR_MS (60 * 60 * 1000)
+
+/******************************************************************************/
+/* Tests                                                                      */
+/******************************************************************************/
+static void test_first_deadline_is_epoch_aligned(void)
+{
+	uint32_t missed = 1;
+
+	/* 12.5 s past a minute of real time */
+	zassert_equal(SampleSchedule_Deadline(0, 1000, 3612500, PERIOD,
+					      &missed),
+		      1000 + PERIOD - 12500, "not aligned to the period");
+	zassert_equal(missed, 0, "first deadline can't be missed");
+
+	/* Exactly on a minute gives a whole period */
+	zassert_equal(SampleSchedule_Deadline(0, 1000, 3600000, PERIOD,
+					      &missed),
+		      1000 + PERIOD, "on the grid should wait a period");
+}
+
+static void test_anchored_deadline(void)
+{
+	uint32_t missed = 1;
+
+	/* The reading took 300 ms, the next deadline doesn't drift */
+	zassert_equal(SampleSchedule_Deadline(10000, 10300, 0, PERIOD,
+					      &missed),
+		      10000 + PERIOD, "deadline drifted");
+	zassert_equal(missed, 0, "nothing was missed");
+}
+
+static void test_missed_deadlines_are_skipped(void)
+{
+	uint32_t missed = 0;
+
+	/* Three deadlines passed while the system was busy */
+	zassert_equal(SampleSchedule_Deadline(10000, 10000 + (3 * PERIOD) + 5,
+					      0, PERIOD, &missed),
+		      10000 + (4 * PERIOD), "wrong deadline after overrun");
+	zassert_equal(missed, 3, "wrong missed count");
+
+	/* A deadline equal to now has passed */
+	zassert_equal(SampleSchedule_Deadline(10000, 10000 + PERIOD, 0,
+					      PERIOD, &missed),
+		      10000 + (2 * PERIOD), "deadline must be after now");
+	zassert_equal(missed, 1, "deadline at now is missed");
+}
+
+static void test_earliest(void)
+{
+	const int64_t none[3] = { 0, 0, 0 };
+	const int64_t some[4] = { 0, 5000, 2000, 9000 };
+
+	zassert_equal(SampleSchedule_Earliest(none, ARRAY_SIZE(none)), 0,
+		      "nothing is scheduled");
+	zassert_equal(SampleSchedule_Earliest(some, ARRAY_SIZE(some)), 2000,
+		      "wrong earliest deadline");
+	zassert_equal(SampleSchedule_Earliest(some, 0), 0,
+		      "no groups");
+}
+
+static void test_due_window(void)
+{
+	const int64_t deadline[4] = { 0, 5000, 2000, 9000 };
+
+	zassert_equal(SampleSchedule_Due(deadline, ARRAY_SIZE(deadline), 1999),
+		      0, "nothing is due");
+	zassert_equal(SampleSchedule_Due(deadline, ARRAY_SIZE(deadline), 2000),
+		      BIT(2), "deadline at the window end is due");
+	zassert_equal(SampleSchedule_Due(deadline, ARRAY_SIZE(deadline), 6000),
+		      BIT(1) | BIT(2), "groups should share the wakeup");
+}
+
+static void test_per_hour(void)
+{
+	zassert_equal(SampleSchedule_PerHour(10, 2 * HOUR_MS), 5,
+		      "wrong rate over two hours");
+	zassert_equal(SampleSchedule_PerHour(10, HOUR_MS), 10,
+		      "wrong rate over an hour");
+	zassert_equal(SampleSchedule_PerHour(10, 0), 0,
+		      "no time has elapsed");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(sample_schedule,
+			 ztest_unit_test(test_first_deadline_is_epoch_aligned),
+			 ztest_unit_test(test_anchored_deadline),
+			 ztest_unit_test(test_missed_deadlines_are_skipped),
+			 ztest_unit_test(test_earliest),
+			 ztest_unit_test(test_due_window),
+			 ztest_unit_test(test_per_hour));
+	ztest_run_test_suite(sample_schedule);
+}